@@ -0,0 +1,176 @@
+/**
+ * @file bitStream.h
+ * @brief Header file for reading and writing a block of bits.
+ *
+ * This file contains a bit reader that reads a payload of bytes as a sequence of bits, the highest bit of
+ * each byte first, and a bit writer that writes bits in the same order. Both keep up to 64 bits in a buffer
+ * so that most reads and writes do not touch memory.
+ * The functions are defined in this file so that the compiler can inline them in the decoding loops.
+ *
+ * @author Spyros Sachmpazidis
+ * @bug No know bugs.
+ * @version 1.1
+ * @since 19/10/26
+ */
+
+#ifndef BIT_STREAM_H
+#define BIT_STREAM_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*The number of bits that are in the buffer after a refill, at least*/
+#define BIT_READER_MIN_BITS 57
+
+/**
+ * @struct BitReader
+ * @brief Represents the position of a reader in a payload.
+ *
+ * @since 1.0
+ */
+typedef struct
+{
+    uint64_t bits;
+    int count;
+    const unsigned char *in;
+    const unsigned char *end;
+} BitReader;
+
+/**
+ * @brief Starts reading a payload.
+ *
+ * @param reader Pointer to the reader.
+ * @param payload The first byte of the payload.
+ * @param length The number of bytes in the payload.
+ * @since 1.0
+ */
+static inline void initializeBitReader(BitReader *reader, const unsigned char *payload, size_t length)
+{
+    reader->bits = 0;
+    reader->count = 0;
+    reader->in = payload;
+    reader->end = payload + length;
+}
+
+/**
+ * @brief Fills the buffer of the reader with at least BIT_READER_MIN_BITS bits.
+ *
+ * Bytes after the end of the payload are read as 0, so a damaged payload can never be read past its end.
+ *
+ * @param reader Pointer to the reader.
+ * @since 1.0
+ */
+static inline void refillBits(BitReader *reader)
+{
+    while (reader->count <= 56)
+    {
+        reader->bits |= (uint64_t)(reader->in < reader->end ? *reader->in : 0) << (56 - reader->count);
+        reader->in++;
+        reader->count += 8;
+    }
+}
+
+/**
+ * @brief Returns the next bits of the payload without reading them.
+ *
+ * @param reader Pointer to the reader.
+ * @param nbBits The number of bits, from 0 to 63.
+ * @return The bits.
+ * @since 1.0
+ */
+static inline uint32_t peekBits(BitReader *reader, int nbBits)
+{
+    return (uint32_t)((reader->bits >> 1) >> (63 - nbBits));
+}
+
+/**
+ * @brief Skips bits of the payload.
+ *
+ * @param reader Pointer to the reader.
+ * @param nbBits The number of bits, at most the number of bits in the buffer.
+ * @since 1.0
+ */
+static inline void skipBits(BitReader *reader, int nbBits)
+{
+    reader->bits <<= nbBits;
+    reader->count -= nbBits;
+}
+
+/**
+ * @brief Reads the next bits of the payload.
+ *
+ * @param reader Pointer to the reader.
+ * @param nbBits The number of bits, at most the number of bits in the buffer.
+ * @return The bits.
+ * @since 1.0
+ */
+static inline uint32_t readBits(BitReader *reader, int nbBits)
+{
+    uint32_t value = peekBits(reader, nbBits);
+    skipBits(reader, nbBits);
+    return value;
+}
+
+/**
+ * @struct BitWriter
+ * @brief Represents the position of a writer in a payload.
+ *
+ * @since 1.1
+ */
+typedef struct
+{
+    uint64_t bits;
+    int count;
+    unsigned char *out;
+} BitWriter;
+
+/**
+ * @brief Starts writing a payload.
+ *
+ * @param writer Pointer to the writer.
+ * @param payload The first byte of the payload.
+ * @since 1.1
+ */
+static inline void initializeBitWriter(BitWriter *writer, unsigned char *payload)
+{
+    writer->bits = 0;
+    writer->count = 0;
+    writer->out = payload;
+}
+
+/**
+ * @brief Writes bits to the payload.
+ *
+ * Every full byte is written to the payload right away, so at most 7 bits stay in the buffer.
+ *
+ * @param writer Pointer to the writer.
+ * @param value The bits, the last bit written is the lowest bit of the value.
+ * @param nbBits The number of bits, from 0 to 56.
+ * @since 1.1
+ */
+static inline void putBits(BitWriter *writer, uint64_t value, int nbBits)
+{
+    writer->bits = (writer->bits << nbBits) | value;
+    writer->count += nbBits;
+    while (writer->count >= 8)
+    {
+        writer->count -= 8;
+        *writer->out++ = (unsigned char)(writer->bits >> writer->count);
+    }
+}
+
+/**
+ * @brief Writes the bits left in the buffer, filling the last byte with 0.
+ *
+ * @param writer Pointer to the writer.
+ * @return A pointer to the byte after the end of the payload.
+ * @since 1.1
+ */
+static inline unsigned char *flushBits(BitWriter *writer)
+{
+    if (writer->count > 0)
+        putBits(writer, 0, 8 - writer->count);
+    return writer->out;
+}
+
+#endif
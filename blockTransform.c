@@ -0,0 +1,408 @@
+#include "blockTransform.h"
+
+/*The state of countTransformedFile between the blocks of the pipeline*/
+typedef struct
+{
+    const TransformChain *chain;
+    TransformBuffers *buffers;
+    unsigned long long *counts;
+} TransformCounter;
+
+#ifdef DEBUG_BLOCK_TRANSFORM
+int main(int argc, char *argv[])
+{
+    if (argc != 3)
+    {
+        printf("Correct arguments not given!\n");
+        exit(EXIT_FAILURE);
+    }
+    printf("Debugging blockTransform.c:\n");
+    TransformChain chain;
+    parseTransformChain(argv[2], &chain);
+    printf("Trying to transform every block of %s and give it back...\n", argv[1]);
+    FILE *fp = NULL;
+    if ((fp = fopen(argv[1], "rb")) == NULL)
+    {
+        printf("Error: Unable to open %s\n", argv[1]);
+        exit(EXIT_FAILURE);
+    }
+    TransformBuffers *buffers = createTransformBuffers();
+    static unsigned char block[PIPELINE_BLOCK_SIZE];
+    static unsigned char back[PIPELINE_BLOCK_SIZE];
+    unsigned long long total = 0, transformedTotal = 0;
+    size_t length;
+    while ((length = fread(block, 1, PIPELINE_BLOCK_SIZE, fp)) > 0)
+    {
+        uint32_t parameters[TRANSFORM_MAX_STAGES];
+        size_t transformedLength;
+        const unsigned char *transformed = applyTransforms(buffers, &chain, block, length, parameters, &transformedLength);
+        // the decoder gives the transformed block in the first buffer
+        memmove(buffers->blocks[0], transformed, transformedLength);
+        if (!invertTransforms(buffers, &chain, parameters, buffers->blocks[0], transformedLength, back, length) ||
+            memcmp(block, back, length) != 0)
+        {
+            printf("Blocks differ!\n");
+            exit(EXIT_FAILURE);
+        }
+        total += length;
+        transformedTotal += transformedLength;
+    }
+    printf("Success!%llu characters were transformed to %llu\n", total, transformedTotal);
+    fclose(fp);
+    freeTransformBuffers(buffers);
+}
+#endif
+
+void parseTransformChain(char *names, TransformChain *chain)
+{
+    chain->count = 0;
+    if (strcmp(names, "none") == 0)
+        return;
+
+    const char *name = names;
+    while (1)
+    {
+        size_t length = strcspn(name, ",");
+        int stage = TRANSFORM_NONE;
+        if (length == 3 && strncmp(name, "rle", 3) == 0)
+            stage = TRANSFORM_RLE;
+        else if (length == 3 && strncmp(name, "mtf", 3) == 0)
+            stage = TRANSFORM_MTF;
+        else if (length == 3 && strncmp(name, "bwt", 3) == 0)
+            stage = TRANSFORM_BWT;
+        else
+        {
+            printf("Error: Unknown transform %.*s, use rle, mtf or bwt\n", (int)length, name);
+            exit(EXIT_FAILURE);
+        }
+
+        // every transform is used at most once, which also keeps the transformed blocks below TRANSFORM_MAX_LENGTH
+        int i;
+        for (i = 0; i < chain->count; i++)
+            if (chain->stages[i] == stage)
+            {
+                printf("Error: Transform %.*s is given twice\n", (int)length, name);
+                exit(EXIT_FAILURE);
+            }
+        chain->stages[chain->count++] = stage;
+
+        if (name[length] == '\0')
+            break;
+        name += length + 1;
+    }
+}
+
+int isValidTransformChain(const TransformChain *chain)
+{
+    if (chain->count < 0 || chain->count > TRANSFORM_MAX_STAGES)
+        return 0;
+
+    int i, j;
+    for (i = 0; i < chain->count; i++)
+    {
+        if (chain->stages[i] != TRANSFORM_RLE && chain->stages[i] != TRANSFORM_MTF && chain->stages[i] != TRANSFORM_BWT)
+            return 0;
+        for (j = 0; j < i; j++)
+            if (chain->stages[j] == chain->stages[i])
+                return 0;
+    }
+    return 1;
+}
+
+TransformBuffers *createTransformBuffers()
+{
+    TransformBuffers *buffers = NULL;
+    if ((buffers = (TransformBuffers *)malloc(sizeof(TransformBuffers))) == NULL)
+    {
+        printf("System out of memory!");
+        exit(EXIT_FAILURE);
+    }
+
+    return buffers;
+}
+
+/*writes the rest of every run of TRANSFORM_RLE_RUN equal characters as 1 length*/
+static size_t encodeRuns(const unsigned char *in, size_t length, unsigned char *out)
+{
+    size_t i = 0, o = 0;
+    while (i < length)
+    {
+        unsigned char c = in[i];
+        size_t run = 1;
+        while (i + run < length && in[i + run] == c && run < TRANSFORM_RLE_RUN + TRANSFORM_RLE_MAX_EXTRA)
+            run++;
+        i += run;
+
+        size_t k;
+        for (k = 0; k < run && k < TRANSFORM_RLE_RUN; k++)
+            out[o++] = c;
+        if (run >= TRANSFORM_RLE_RUN)
+            out[o++] = run - TRANSFORM_RLE_RUN;
+    }
+    return o;
+}
+
+static size_t decodeRuns(const unsigned char *in, size_t length, unsigned char *out, size_t capacity)
+{
+    size_t i = 0, o = 0;
+    int last = -1, same = 0;
+    while (i < length)
+    {
+        unsigned char c = in[i++];
+        if (o >= capacity)
+            return capacity + 1;
+        out[o++] = c;
+        same = c == last ? same + 1 : 1;
+        last = c;
+
+        // a length always follows a full run, and a new run starts after it
+        if (same == TRANSFORM_RLE_RUN)
+        {
+            if (i >= length || in[i] > TRANSFORM_RLE_MAX_EXTRA || o + in[i] > capacity)
+                return capacity + 1;
+            memset(out + o, c, in[i]);
+            o += in[i++];
+            last = -1;
+            same = 0;
+        }
+    }
+    return o;
+}
+
+static void moveToFront(const unsigned char *in, size_t length, unsigned char *out)
+{
+    unsigned char order[BYTE_SIZE];
+    int i;
+    for (i = 0; i < BYTE_SIZE; i++)
+        order[i] = i;
+
+    size_t k;
+    for (k = 0; k < length; k++)
+    {
+        unsigned char c = in[k];
+        int j = 0;
+        while (order[j] != c)
+            j++;
+        out[k] = j;
+        memmove(order + 1, order, j);
+        order[0] = c;
+    }
+}
+
+static void moveFromFront(const unsigned char *in, size_t length, unsigned char *out)
+{
+    unsigned char order[BYTE_SIZE];
+    int i;
+    for (i = 0; i < BYTE_SIZE; i++)
+        order[i] = i;
+
+    size_t k;
+    for (k = 0; k < length; k++)
+    {
+        int j = in[k];
+        unsigned char c = order[j];
+        out[k] = c;
+        memmove(order + 1, order, j);
+        order[0] = c;
+    }
+}
+
+/*sorts the rotations of the block by doubling the length of the sorted prefix, with counting sorts in O(n log n)*/
+static uint32_t sortRotations(TransformBuffers *buffers, const unsigned char *in, size_t length, unsigned char *out)
+{
+    int32_t *rotations = buffers->rotations;
+    int32_t *rank = buffers->ranks;
+    int32_t *work = buffers->work;
+    int32_t *counts = buffers->counts;
+    int32_t n = length;
+    int32_t i, k, classes;
+
+    // the rotations are first sorted by their first character
+    memset(counts, 0, BYTE_SIZE * sizeof(int32_t));
+    for (i = 0; i < n; i++)
+        counts[in[i]]++;
+    for (i = 1; i < BYTE_SIZE; i++)
+        counts[i] += counts[i - 1];
+    for (i = n - 1; i >= 0; i--)
+        rotations[--counts[in[i]]] = i;
+    rank[rotations[0]] = 0;
+    classes = 1;
+    for (i = 1; i < n; i++)
+    {
+        if (in[rotations[i]] != in[rotations[i - 1]])
+            classes++;
+        rank[rotations[i]] = classes - 1;
+    }
+
+    for (k = 1; k < n && classes < n; k <<= 1)
+    {
+        // the rotation k places before each sorted rotation is in order of its second half
+        for (i = 0; i < n; i++)
+        {
+            work[i] = rotations[i] - k;
+            if (work[i] < 0)
+                work[i] += n;
+        }
+        // a stable sort by the first half gives the order of both halves
+        memset(counts, 0, classes * sizeof(int32_t));
+        for (i = 0; i < n; i++)
+            counts[rank[work[i]]]++;
+        for (i = 1; i < classes; i++)
+            counts[i] += counts[i - 1];
+        for (i = n - 1; i >= 0; i--)
+            rotations[--counts[rank[work[i]]]] = work[i];
+
+        work[rotations[0]] = 0;
+        classes = 1;
+        for (i = 1; i < n; i++)
+        {
+            int32_t current = rotations[i], previous = rotations[i - 1];
+            if (rank[current] != rank[previous] || rank[(current + k) % n] != rank[(previous + k) % n])
+                classes++;
+            work[current] = classes - 1;
+        }
+        int32_t *temp = rank;
+        rank = work;
+        work = temp;
+    }
+
+    // the last column of the sorted rotations is the transformed block
+    uint32_t primary = 0;
+    for (i = 0; i < n; i++)
+    {
+        out[i] = in[rotations[i] == 0 ? n - 1 : rotations[i] - 1];
+        if (rotations[i] == 0)
+            primary = i;
+    }
+    return primary;
+}
+
+static int unsortRotations(TransformBuffers *buffers, const unsigned char *in, size_t length, uint32_t primary,
+                           unsigned char *out)
+{
+    if (primary >= length)
+        return 0;
+
+    // the next rotation of each one is the same character at the same rank in the first column
+    int32_t *next = buffers->rotations;
+    int32_t *counts = buffers->counts;
+    int32_t n = length;
+    int32_t i, c, sum = 0;
+    memset(counts, 0, BYTE_SIZE * sizeof(int32_t));
+    for (i = 0; i < n; i++)
+        counts[in[i]]++;
+    for (c = 0; c < BYTE_SIZE; c++)
+    {
+        int32_t count = counts[c];
+        counts[c] = sum;
+        sum += count;
+    }
+    for (i = 0; i < n; i++)
+        next[counts[in[i]]++] = i;
+
+    int32_t position = next[primary];
+    for (i = 0; i < n; i++)
+    {
+        out[i] = in[position];
+        position = next[position];
+    }
+    return 1;
+}
+
+const unsigned char *applyTransforms(TransformBuffers *buffers, const TransformChain *chain, const unsigned char *data,
+                                     size_t length, uint32_t *parameters, size_t *transformedLength)
+{
+    const unsigned char *current = data;
+    int i;
+    for (i = 0; i < chain->count; i++)
+    {
+        // every transform writes to the buffer that does not hold its input
+        unsigned char *next = current == buffers->blocks[0] ? buffers->blocks[1] : buffers->blocks[0];
+        parameters[i] = 0;
+        if (chain->stages[i] == TRANSFORM_RLE)
+            length = encodeRuns(current, length, next);
+        else if (chain->stages[i] == TRANSFORM_MTF)
+            moveToFront(current, length, next);
+        else
+            parameters[i] = sortRotations(buffers, current, length, next);
+        current = next;
+    }
+
+    *transformedLength = length;
+    return current;
+}
+
+int invertTransforms(TransformBuffers *buffers, const TransformChain *chain, const uint32_t *parameters,
+                      const unsigned char *data, size_t transformedLength, unsigned char *out, size_t length)
+{
+    const unsigned char *current = data;
+    int valid = 1;
+    int i;
+    for (i = chain->count - 1; i >= 0 && valid; i--)
+    {
+        // the first transform gives back the original block straight into the output
+        unsigned char *next = out;
+        size_t capacity = length;
+        if (i > 0)
+        {
+            next = current == buffers->blocks[0] ? buffers->blocks[1] : buffers->blocks[0];
+            capacity = TRANSFORM_MAX_LENGTH;
+        }
+
+        if (chain->stages[i] == TRANSFORM_RLE)
+        {
+            transformedLength = decodeRuns(current, transformedLength, next, capacity);
+            valid = transformedLength <= capacity;
+        }
+        else if (transformedLength > capacity)
+            valid = 0;
+        else if (chain->stages[i] == TRANSFORM_MTF)
+            moveFromFront(current, transformedLength, next);
+        else
+            valid = unsortRotations(buffers, current, transformedLength, parameters[i], next);
+        current = next;
+    }
+
+    if (!valid || transformedLength != length)
+    {
+        printf("Error: Invalid block in encoded file\n");
+        return 0;
+    }
+    return 1;
+}
+
+static void countBlock(void *state, const unsigned char *data, size_t length, Pipeline *pipe)
+{
+    TransformCounter *counter = (TransformCounter *)state;
+    uint32_t parameters[TRANSFORM_MAX_STAGES];
+    size_t transformedLength;
+    (void)pipe;
+    const unsigned char *transformed = applyTransforms(counter->buffers, counter->chain, data, length, parameters,
+                                                       &transformedLength);
+    size_t i;
+    for (i = 0; i < transformedLength; i++)
+        if (transformed[i] < ASCII_SIZE)
+            counter->counts[transformed[i]]++;
+}
+
+unsigned long long *countTransformedFile(char *inputFile, const TransformChain *chain)
+{
+    TransformCounter counter;
+    counter.chain = chain;
+    counter.buffers = createTransformBuffers();
+    if ((counter.counts = (unsigned long long *)calloc(ASCII_SIZE, sizeof(unsigned long long))) == NULL)
+    {
+        printf("System out of memory!");
+        exit(EXIT_FAILURE);
+    }
+
+    // the blocks are the same as those of the encoder, nothing is written
+    runPipeline(inputFile, NULL, countBlock, &counter);
+    freeTransformBuffers(counter.buffers);
+    return counter.counts;
+}
+
+void freeTransformBuffers(TransformBuffers *buffers)
+{
+    free(buffers);
+}
@@ -0,0 +1,164 @@
+/**
+ * @file blockTransform.h
+ * @brief Header file for the transforms that are applied to every block before it is encoded.
+ *
+ * This file contains declarations for functions for reversible transforms that make repetitive data cheaper to
+ * encode with a coder that only looks at the probability of each character. The block sorting transform of
+ * Burrows and Wheeler groups the characters that come before the same context, the move to front transform turns
+ * those groups into runs of small numbers, and the run length transform shortens long runs of the same character.
+ * Any chain of them can be used, each transform at most once, and the decoder applies their inverses in the
+ * opposite order.
+ *
+ * Every block is transformed on its own, so blocks can still be decoded separately. All the buffers are allocated
+ * once for the whole file. The transforms keep ASCII text in the ASCII table, so the models still fit the
+ * transformed blocks, and a count file of the transformed blocks gives the best model for them.
+ *
+ * @author Spyros Sachmpazidis
+ * @bug No know bugs.
+ * @version 1.1
+ * @since 19/10/26
+ */
+
+#ifndef BLOCK_TRANSFORM_H
+#define BLOCK_TRANSFORM_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "pipeline.h"
+#include "huffmanTree.h"
+
+/*The transforms that can be in a chain*/
+#define TRANSFORM_NONE 0
+#define TRANSFORM_RLE 1
+#define TRANSFORM_MTF 2
+#define TRANSFORM_BWT 3
+
+/*The largest number of transforms in a chain*/
+#define TRANSFORM_MAX_STAGES 4
+/*The number of equal characters after which the run length transform writes the length of the rest of the run*/
+#define TRANSFORM_RLE_RUN 4
+/*The largest rest of a run, so the lengths are ASCII characters*/
+#define TRANSFORM_RLE_MAX_EXTRA (ASCII_SIZE - 1)
+/*The largest transformed block, the run length transform writes at most 5 characters for every 4*/
+#define TRANSFORM_MAX_LENGTH (PIPELINE_BLOCK_SIZE + PIPELINE_BLOCK_SIZE / TRANSFORM_RLE_RUN)
+
+/**
+ * @struct TransformChain
+ * @brief Represents the transforms that are applied to every block, in the order they are applied.
+ *
+ * @since 1.0
+ */
+typedef struct
+{
+    int count;
+    int stages[TRANSFORM_MAX_STAGES];
+} TransformChain;
+
+/**
+ * @struct TransformBuffers
+ * @brief Represents the memory that the transforms work in.
+ *
+ * The blocks move between the 2 buffers from one transform to the next, and the block sorting transform
+ * sorts its rotations in the integer arrays.
+ *
+ * @since 1.0
+ */
+typedef struct
+{
+    unsigned char blocks[2][TRANSFORM_MAX_LENGTH];
+    int32_t rotations[TRANSFORM_MAX_LENGTH];
+    int32_t ranks[TRANSFORM_MAX_LENGTH];
+    int32_t work[TRANSFORM_MAX_LENGTH];
+    int32_t counts[TRANSFORM_MAX_LENGTH];
+} TransformBuffers;
+
+/**
+ * @brief Reads a chain of transforms from their names.
+ *
+ * The names are rle, mtf and bwt separated by commas, in the order they are applied, or none for no transforms.
+ * The program stops if a name is unknown or a transform is given twice.
+ *
+ * @param names The names of the transforms, for example bwt,mtf,rle.
+ * @param chain Pointer to the chain that is filled.
+ * @since 1.0
+ */
+void parseTransformChain(char *names, TransformChain *chain);
+
+/**
+ * @brief Checks if a chain that was not made by parseTransformChain is valid.
+ *
+ * @param chain Pointer to the chain.
+ * @return 1 if the chain has known transforms, each one at most once, and 0 otherwise.
+ * @since 1.0
+ */
+int isValidTransformChain(const TransformChain *chain);
+
+/**
+ * @brief Allocates the buffers of the transforms.
+ *
+ * @return A pointer to the buffers.
+ * @since 1.0
+ */
+TransformBuffers *createTransformBuffers();
+
+/**
+ * @brief Transforms a block with every transform of a chain.
+ *
+ * Each transform gives back 1 number that its inverse needs, the block sorting transform the position of the
+ * original block among its sorted rotations and the others 0. The transformed block is left in one of the buffers.
+ *
+ * @param buffers Pointer to the buffers.
+ * @param chain Pointer to the chain.
+ * @param data The characters of the block.
+ * @param length The number of characters in the block, at most PIPELINE_BLOCK_SIZE.
+ * @param parameters The array that the number of each transform is written to.
+ * @param transformedLength Pointer to where the length of the transformed block is written.
+ * @return A pointer to the transformed block.
+ * @since 1.0
+ */
+const unsigned char *applyTransforms(TransformBuffers *buffers, const TransformChain *chain, const unsigned char *data,
+                                     size_t length, uint32_t *parameters, size_t *transformedLength);
+
+/**
+ * @brief Gives back the original block from a transformed block.
+ *
+ * The transformed block can be in the first of the buffers.
+ *
+ * @param buffers Pointer to the buffers.
+ * @param chain Pointer to the chain of the block.
+ * @param parameters The number of each transform.
+ * @param data The transformed block.
+ * @param transformedLength The length of the transformed block.
+ * @param out The buffer that the original block is written to.
+ * @param length The length of the original block.
+ * @return 1 if the block was given back, 0 if the numbers of the transforms are invalid or the block does not give
+ * back exactly length characters, the error is printed.
+ * @since 1.0
+ */
+int invertTransforms(TransformBuffers *buffers, const TransformChain *chain, const uint32_t *parameters,
+                     const unsigned char *data, size_t transformedLength, unsigned char *out, size_t length);
+
+/**
+ * @brief Counts the characters of a file after every block is transformed.
+ *
+ * The counts are those that the coder sees when the file is encoded with the chain, so a count file written from
+ * them gives the best model for the transformed file. Bytes outside the ASCII table are ignored.
+ *
+ * @param inputFile The input file.
+ * @param chain Pointer to the chain.
+ * @return a pointer to an array with the count of each character
+ * @since 1.0
+ */
+unsigned long long *countTransformedFile(char *inputFile, const TransformChain *chain);
+
+/**
+ * @brief Frees the buffers of the transforms.
+ *
+ * @param buffers Pointer to the buffers.
+ * @since 1.0
+ */
+void freeTransformBuffers(TransformBuffers *buffers);
+
+#endif
@@ -0,0 +1,256 @@
+#include "canonicalHuffman.h"
+
+/*A symbol and its weight, so the symbols can be sorted by weight*/
+typedef struct
+{
+    unsigned long long weight;
+    int symbol;
+} WeightedSymbol;
+
+/*The symbols with a code, sorted by weight, and the arrays used to merge them*/
+typedef struct
+{
+    int count;
+    WeightedSymbol *symbols;
+    unsigned long long *weights;
+    int *parents;
+    int *depths;
+} CodeBuilder;
+
+#ifdef DEBUG_CANONICAL_HUFFMAN
+int main(int argc, char *argv[])
+{
+    if (argc != 2)
+    {
+        printf("Number of symbols not given!\n");
+        exit(EXIT_FAILURE);
+    }
+    printf("Debugging canonicalHuffman.c:\n");
+    int symbolCount = atoi(argv[1]);
+    unsigned long long *weights = malloc(symbolCount * sizeof(unsigned long long));
+    unsigned long long a = 1, b = 1;
+    int i;
+    // fibonacci weights give the longest possible codes before they are limited
+    for (i = 0; i < symbolCount; i++)
+    {
+        weights[i] = i < 80 ? a : 1 + i % 1000;
+        unsigned long long c = a + b;
+        a = b;
+        b = c;
+    }
+    printf("Trying to create the codes of %d symbols...\n", symbolCount);
+    CanonicalCode *code = createCanonicalCode(weights, symbolCount);
+    printf("Success!The longest code has %d bits\n", code->maxCodeLength);
+    printf("Trying to create the decode tables...\n");
+    CanonicalDecodeTable *table = createCanonicalDecodeTable(code);
+    printf("Success!\n");
+    free(weights);
+    freeCanonicalCode(code);
+    freeCanonicalDecodeTable(table);
+}
+#endif
+
+static int compareSymbols(const void *a, const void *b)
+{
+    const WeightedSymbol *x = (const WeightedSymbol *)a, *y = (const WeightedSymbol *)b;
+    if (x->weight != y->weight)
+        return x->weight < y->weight ? -1 : 1;
+    return x->symbol - y->symbol;
+}
+
+/*takes the lightest tree from the front of the leaves or the front of the merged trees*/
+static int takeLightest(CodeBuilder *builder, int *leaf, int *merged, int next)
+{
+    if (*leaf < builder->count && (*merged >= next || builder->weights[*leaf] <= builder->weights[*merged]))
+        return (*leaf)++;
+    return (*merged)++;
+}
+
+/*finds the length of every code, the leaves are 0 to count - 1 and the merged trees follow them*/
+static int buildLengths(CodeBuilder *builder)
+{
+    int count = builder->count;
+    int leaf = 0, merged = count, next = count;
+    // merged trees are created in order of weight, so their queue is always sorted
+    while (next < 2 * count - 1)
+    {
+        int a = takeLightest(builder, &leaf, &merged, next);
+        int b = takeLightest(builder, &leaf, &merged, next);
+        builder->weights[next] = builder->weights[a] + builder->weights[b];
+        builder->parents[a] = next;
+        builder->parents[b] = next;
+        next++;
+    }
+
+    // the root is the last tree, every other tree is 1 deeper than the tree it was merged into
+    int maxLength = 0;
+    int i;
+    builder->depths[2 * count - 2] = 0;
+    for (i = 2 * count - 3; i >= 0; i--)
+    {
+        builder->depths[i] = builder->depths[builder->parents[i]] + 1;
+        if (i < count && builder->depths[i] > maxLength)
+            maxLength = builder->depths[i];
+    }
+    return maxLength;
+}
+
+CanonicalCode *createCanonicalCode(const unsigned long long *weights, int symbolCount)
+{
+    if (symbolCount > CANONICAL_MAX_SYMBOLS)
+    {
+        printf("Error: An alphabet cannot have more than %d symbols\n", CANONICAL_MAX_SYMBOLS);
+        exit(EXIT_FAILURE);
+    }
+
+    CanonicalCode *code = NULL;
+    CodeBuilder builder;
+    if ((code = (CanonicalCode *)malloc(sizeof(CanonicalCode))) == NULL ||
+        (code->lengths = (uint8_t *)calloc(symbolCount, sizeof(uint8_t))) == NULL ||
+        (code->codes = (uint32_t *)calloc(symbolCount, sizeof(uint32_t))) == NULL ||
+        (builder.symbols = (WeightedSymbol *)malloc(symbolCount * sizeof(WeightedSymbol))) == NULL ||
+        (builder.weights = (unsigned long long *)malloc(2 * symbolCount * sizeof(unsigned long long))) == NULL ||
+        (builder.parents = (int *)malloc(2 * symbolCount * sizeof(int))) == NULL ||
+        (builder.depths = (int *)malloc(2 * symbolCount * sizeof(int))) == NULL)
+    {
+        printf("System out of memory!");
+        exit(EXIT_FAILURE);
+    }
+    code->symbolCount = symbolCount;
+    code->maxCodeLength = 0;
+    uint64_t start = traceTime();
+    TRACE_PROBE1(canonical_start, symbolCount);
+
+    // only the symbols with a weight get a code, sorted from the lightest
+    int i;
+    builder.count = 0;
+    for (i = 0; i < symbolCount; i++)
+        if (weights[i] > 0)
+        {
+            builder.symbols[builder.count].weight = weights[i];
+            builder.symbols[builder.count++].symbol = i;
+        }
+    qsort(builder.symbols, builder.count, sizeof(WeightedSymbol), compareSymbols);
+    for (i = 0; i < builder.count; i++)
+        builder.weights[i] = builder.symbols[i].weight;
+
+    if (builder.count == 1)
+        code->lengths[builder.symbols[0].symbol] = 1;
+    else if (builder.count > 1)
+    {
+        // halving the weights makes the tree flatter, it keeps their order so the symbols stay sorted
+        while (buildLengths(&builder) > CANONICAL_MAX_CODE_LENGTH)
+            for (i = 0; i < builder.count; i++)
+                builder.weights[i] = 1 + builder.weights[i] / 2;
+        for (i = 0; i < builder.count; i++)
+            code->lengths[builder.symbols[i].symbol] = builder.depths[i];
+    }
+
+    // the codes of each length are consecutive, in the order of the symbols
+    uint32_t lengthCount[CANONICAL_MAX_CODE_LENGTH + 1] = {0};
+    uint32_t nextCode[CANONICAL_MAX_CODE_LENGTH + 1];
+    for (i = 0; i < symbolCount; i++)
+    {
+        lengthCount[code->lengths[i]]++;
+        if (code->lengths[i] > code->maxCodeLength)
+            code->maxCodeLength = code->lengths[i];
+    }
+    uint32_t next = 0;
+    lengthCount[0] = 0;
+    for (i = 1; i <= CANONICAL_MAX_CODE_LENGTH; i++)
+    {
+        next = (next + lengthCount[i - 1]) << 1;
+        nextCode[i] = next;
+    }
+    for (i = 0; i < symbolCount; i++)
+        if (code->lengths[i] > 0)
+            code->codes[i] = nextCode[code->lengths[i]]++;
+
+    free(builder.symbols);
+    free(builder.weights);
+    free(builder.parents);
+    free(builder.depths);
+    uint64_t time = traceTime() - start;
+    TRACE_PROBE2(canonical_done, time, code->maxCodeLength);
+    addTraceCounter(&getTraceCounters()->trees, 1);
+    addTraceCounter(&getTraceCounters()->treeTime, time);
+    return code;
+}
+
+CanonicalDecodeTable *createCanonicalDecodeTable(const CanonicalCode *code)
+{
+    CanonicalDecodeTable *table = NULL;
+    if ((table = (CanonicalDecodeTable *)calloc(1, sizeof(CanonicalDecodeTable))) == NULL ||
+        (table->sorted = (uint16_t *)malloc((code->symbolCount + 1) * sizeof(uint16_t))) == NULL)
+    {
+        printf("System out of memory!");
+        exit(EXIT_FAILURE);
+    }
+    table->maxCodeLength = code->maxCodeLength;
+
+    int i, length;
+    for (i = 0; i < code->symbolCount; i++)
+        if (code->lengths[i] > 0)
+            table->lengthCount[code->lengths[i]]++;
+
+    // the symbols of each length are stored in the order of their codes, which is the order of the symbols
+    uint32_t index = 0, next = 0;
+    for (length = 1; length <= CANONICAL_MAX_CODE_LENGTH; length++)
+    {
+        next = (next + table->lengthCount[length - 1]) << 1;
+        table->firstCode[length] = next;
+        table->firstIndex[length] = index;
+        index += table->lengthCount[length];
+    }
+    uint32_t position[CANONICAL_MAX_CODE_LENGTH + 1];
+    memcpy(position, table->firstIndex, sizeof(position));
+    for (i = 0; i < code->symbolCount; i++)
+        if (code->lengths[i] > 0)
+            table->sorted[position[code->lengths[i]]++] = i;
+
+    // every short code fills all the entries that start with it
+    for (i = 0; i < code->symbolCount; i++)
+    {
+        length = code->lengths[i];
+        if (length == 0 || length > CANONICAL_LUT_BITS)
+            continue;
+        uint32_t first = code->codes[i] << (CANONICAL_LUT_BITS - length);
+        uint32_t k;
+        for (k = 0; k < (1u << (CANONICAL_LUT_BITS - length)); k++)
+        {
+            table->lut[first + k].symbol = i;
+            table->lut[first + k].length = length;
+        }
+    }
+
+    return table;
+}
+
+int decodeLongCanonicalCode(const CanonicalDecodeTable *table, BitReader *reader)
+{
+    int length;
+    for (length = CANONICAL_LUT_BITS + 1; length <= table->maxCodeLength; length++)
+    {
+        // a longer code starts with bits above every code of this length
+        uint32_t offset = peekBits(reader, length) - table->firstCode[length];
+        if (offset < table->lengthCount[length])
+        {
+            skipBits(reader, length);
+            return table->sorted[table->firstIndex[length] + offset];
+        }
+    }
+    return -1;
+}
+
+void freeCanonicalCode(CanonicalCode *code)
+{
+    free(code->lengths);
+    free(code->codes);
+    free(code);
+}
+
+void freeCanonicalDecodeTable(CanonicalDecodeTable *table)
+{
+    free(table->sorted);
+    free(table);
+}
@@ -0,0 +1,139 @@
+/**
+ * @file canonicalHuffman.h
+ * @brief Header file for canonical huffman codes of large alphabets.
+ *
+ * This file contains declarations for functions for creating huffman codes for alphabets of up to
+ * CANONICAL_MAX_SYMBOLS symbols, where building a tree of nodes and finding the 2 lightest trees by scanning them
+ * all would take quadratic time. The symbols are sorted by weight once, and the lightest trees are then always at
+ * the front of 2 queues, the queue of the leaves and the queue of the merged trees, so the lengths of all the codes
+ * are found in O(n log n) without creating any node.
+ *
+ * The codes are limited to CANONICAL_MAX_CODE_LENGTH bits, by halving the weights and building them again when a
+ * code is longer. The codes are canonical, so the codes of each length are consecutive numbers and the decoder only
+ * needs a small lookup table for the short codes and the first code of each length for the long ones.
+ *
+ * @author Spyros Sachmpazidis
+ * @bug No know bugs.
+ * @version 1.1
+ * @since 19/10/26
+ */
+
+#ifndef CANONICAL_HUFFMAN_H
+#define CANONICAL_HUFFMAN_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "bitStream.h"
+#include "traceProbes.h"
+
+/*The largest number of symbols, so every symbol fits in 16 bits*/
+#define CANONICAL_MAX_SYMBOLS (1 << 16)
+/*The longest code*/
+#define CANONICAL_MAX_CODE_LENGTH 24
+/*The number of bits that the lookup table of the decoder reads at once*/
+#define CANONICAL_LUT_BITS 11
+/*The number of entries in the lookup table of the decoder*/
+#define CANONICAL_LUT_SIZE (1 << CANONICAL_LUT_BITS)
+
+/**
+ * @struct CanonicalCode
+ * @brief Represents the code of every symbol.
+ *
+ * A symbol with a length of 0 has no code.
+ *
+ * @since 1.0
+ */
+typedef struct
+{
+    int symbolCount;
+    int maxCodeLength;
+    uint8_t *lengths;
+    uint32_t *codes;
+} CanonicalCode;
+
+/**
+ * @struct CanonicalLutEntry
+ * @brief Represents the code that starts with some CANONICAL_LUT_BITS bits.
+ *
+ * A length of 0 means that the code is longer than CANONICAL_LUT_BITS bits.
+ *
+ * @since 1.0
+ */
+typedef struct
+{
+    uint16_t symbol;
+    uint8_t length;
+} CanonicalLutEntry;
+
+/**
+ * @struct CanonicalDecodeTable
+ * @brief Represents the tables used to decode canonical codes.
+ *
+ * The structure contains the lookup table, and for every length the first code, the number of codes and where
+ * their symbols start in the array of the symbols sorted by code.
+ *
+ * @since 1.0
+ */
+typedef struct
+{
+    CanonicalLutEntry lut[CANONICAL_LUT_SIZE];
+    int maxCodeLength;
+    uint32_t firstCode[CANONICAL_MAX_CODE_LENGTH + 1];
+    uint32_t lengthCount[CANONICAL_MAX_CODE_LENGTH + 1];
+    uint32_t firstIndex[CANONICAL_MAX_CODE_LENGTH + 1];
+    uint16_t *sorted;
+} CanonicalDecodeTable;
+
+/**
+ * @brief Creates the canonical huffman codes of an alphabet.
+ *
+ * Every symbol with a weight above 0 gets a code, and the program stops if there are more than
+ * CANONICAL_MAX_SYMBOLS symbols. A single symbol gets a code of 1 bit.
+ *
+ * @param weights a pointer to an array with the weight of each symbol.
+ * @param symbolCount The number of symbols.
+ * @return A pointer to the created codes.
+ * @since 1.0
+ */
+CanonicalCode *createCanonicalCode(const unsigned long long *weights, int symbolCount);
+
+/**
+ * @brief Creates the decode tables of canonical codes.
+ *
+ * @param code Pointer to the codes.
+ * @return A pointer to the created tables.
+ * @since 1.0
+ */
+CanonicalDecodeTable *createCanonicalDecodeTable(const CanonicalCode *code);
+
+/**
+ * @brief Reads a code that is longer than CANONICAL_LUT_BITS bits.
+ *
+ * The reader must have at least CANONICAL_MAX_CODE_LENGTH bits in its buffer.
+ *
+ * @param table Pointer to the decode tables.
+ * @param reader Pointer to the reader.
+ * @return The symbol of the code, or -1 if the bits are not a code.
+ * @since 1.0
+ */
+int decodeLongCanonicalCode(const CanonicalDecodeTable *table, BitReader *reader);
+
+/**
+ * @brief Frees the memory allocated for the codes.
+ *
+ * @param code Pointer to the codes.
+ * @since 1.0
+ */
+void freeCanonicalCode(CanonicalCode *code);
+
+/**
+ * @brief Frees the memory allocated for the decode tables.
+ *
+ * @param table Pointer to the decode tables.
+ * @since 1.0
+ */
+void freeCanonicalDecodeTable(CanonicalDecodeTable *table);
+
+#endif
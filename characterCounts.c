@@ -0,0 +1,218 @@
+#include "characterCounts.h"
+
+#ifdef DEBUG_CHARACTER_COUNTS
+int main(int argc, char *argv[])
+{
+    if (argc == 1)
+    {
+        printf("Input file not given!\n");
+        exit(EXIT_FAILURE);
+    }
+    printf("Debugging characterCounts.c:\n");
+    printf("Trying to open %s to count characters...\n", argv[1]);
+    unsigned long long *a = calculateCounts(argv[1]);
+    printf("Success!Printing counts for all visible characters:\n");
+    for (int i = 32; i < ASCII_SIZE - 1; i++)
+        printf("%c\t%llu\n", i, a[i]);
+    printf("Saving counts in counts.txt\n");
+    writeCounts("counts.txt", a);
+    printf("Trying to read counts.txt back...\n");
+    unsigned long long *b = readCounts("counts.txt");
+    printf("%s\n", memcmp(a, b, ASCII_SIZE * sizeof(unsigned long long)) == 0 ? "Success!" : "Counts differ!");
+    free(a);
+    free(b);
+}
+#endif
+
+unsigned long long *calculateCounts(char *inputFile)
+{
+    FILE *fp = NULL;
+    // check if file opens correctly
+    if ((fp = fopen(inputFile, "r")) == NULL)
+    {
+        printf("Input file cannot be read!\n");
+        exit(EXIT_FAILURE);
+    }
+
+    unsigned long long *charCount = NULL;
+    unsigned char *buffer = NULL;
+    // check for calloc error
+    if ((charCount = (unsigned long long *)calloc(ASCII_SIZE, sizeof(unsigned long long))) == NULL)
+    {
+        printf("System out of memory!");
+        exit(EXIT_FAILURE);
+    }
+    if ((buffer = (unsigned char *)malloc(BUFSIZ)) == NULL)
+    {
+        printf("System out of memory!");
+        exit(EXIT_FAILURE);
+    }
+
+    size_t n;
+    // count all the characters of the file
+    while ((n = fread(buffer, 1, BUFSIZ, fp)) > 0)
+    {
+        size_t i;
+        for (i = 0; i < n; i++)
+            if (buffer[i] < ASCII_SIZE)
+                charCount[buffer[i]]++;
+    }
+
+    fclose(fp);
+    free(buffer);
+    return charCount;
+}
+
+void writeCounts(char *outputFile, unsigned long long *charCount)
+{
+    FILE *fp = NULL;
+    // check if file can be opened
+    if ((fp = fopen(outputFile, "w")) == NULL)
+    {
+        printf("Error: Unable to open %s\n", outputFile);
+        exit(EXIT_FAILURE);
+    }
+
+    // write the header and every count in output file
+    fprintf(fp, "%s\n", COUNT_FILE_HEADER);
+    int i;
+    for (i = 0; i < ASCII_SIZE; i++)
+        fprintf(fp, "%llu\n", charCount[i]);
+
+    fclose(fp);
+}
+
+unsigned long long *readCounts(char *inputFile)
+{
+    unsigned long long *charCount = tryReadCounts(inputFile);
+    if (charCount == NULL)
+        exit(EXIT_FAILURE);
+    return charCount;
+}
+
+unsigned long long *tryReadCounts(char *inputFile)
+{
+    FILE *fp = NULL;
+    // check if file opens correctly
+    if ((fp = fopen(inputFile, "r")) == NULL)
+    {
+        printf("Error: Unable to open %s\n", inputFile);
+        return NULL;
+    }
+
+    // read the whole file at once, count files are small
+    fseek(fp, 0, SEEK_END);
+    long size = ftell(fp);
+    rewind(fp);
+    char *text = NULL;
+    unsigned long long *charCount = NULL;
+    if (size < 0 || (text = (char *)malloc(size + 1)) == NULL)
+    {
+        printf("System out of memory!");
+        exit(EXIT_FAILURE);
+    }
+    if ((charCount = (unsigned long long *)calloc(ASCII_SIZE, sizeof(unsigned long long))) == NULL)
+    {
+        printf("System out of memory!");
+        exit(EXIT_FAILURE);
+    }
+    size = fread(text, 1, size, fp);
+    text[size] = '\0';
+    fclose(fp);
+
+    size_t headerLength = strlen(COUNT_FILE_HEADER);
+    if (strncmp(text, COUNT_FILE_HEADER, headerLength) != 0)
+    {
+        printf("Error: %s is not a count file\n", inputFile);
+        free(text);
+        free(charCount);
+        return NULL;
+    }
+
+    // parse exactly one count for each character
+    char *tp = text + headerLength;
+    int i;
+    for (i = 0; i < ASCII_SIZE; i++)
+    {
+        char *end;
+        while (*tp == ' ' || *tp == '\t' || *tp == '\r' || *tp == '\n')
+            tp++;
+        errno = 0;
+        charCount[i] = strtoull(tp, &end, 10);
+        if (end == tp || *tp == '-' || errno == ERANGE)
+        {
+            printf("Error: Invalid count in line %d of %s\n", i + 2, inputFile);
+            free(text);
+            free(charCount);
+            return NULL;
+        }
+        tp = end;
+    }
+    while (*tp == ' ' || *tp == '\t' || *tp == '\r' || *tp == '\n')
+        tp++;
+    if (*tp != '\0')
+    {
+        printf("Error: %s has more than %d counts\n", inputFile, ASCII_SIZE);
+        free(text);
+        free(charCount);
+        return NULL;
+    }
+
+    free(text);
+    return charCount;
+}
+
+int isCountFile(char *inputFile)
+{
+    int found = tryIsCountFile(inputFile);
+    if (found < 0)
+        exit(EXIT_FAILURE);
+    return found;
+}
+
+int tryIsCountFile(char *inputFile)
+{
+    FILE *fp = NULL;
+    // check if file opens correctly
+    if ((fp = fopen(inputFile, "r")) == NULL)
+    {
+        printf("Error: Unable to open %s\n", inputFile);
+        return -1;
+    }
+
+    char line[sizeof(COUNT_FILE_HEADER)];
+    int found = fgets(line, sizeof(line), fp) != NULL && strcmp(line, COUNT_FILE_HEADER) == 0;
+
+    fclose(fp);
+    return found;
+}
+
+void mergeCountFiles(char *outputFile, char **countFiles, int fileCount)
+{
+    unsigned long long *total = NULL;
+    if ((total = (unsigned long long *)calloc(ASCII_SIZE, sizeof(unsigned long long))) == NULL)
+    {
+        printf("System out of memory!");
+        exit(EXIT_FAILURE);
+    }
+
+    // add the counts of every file to the total
+    int i, j;
+    for (i = 0; i < fileCount; i++)
+    {
+        unsigned long long *charCount = readCounts(countFiles[i]);
+        for (j = 0; j < ASCII_SIZE; j++)
+        {
+            if (total[j] + charCount[j] < total[j])
+            {
+                printf("Error: Count of character %d is too big\n", j);
+                exit(EXIT_FAILURE);
+            }
+            total[j] += charCount[j];
+        }
+        free(charCount);
+    }
+
+    writeCounts(outputFile, total);
+    free(total);
+}
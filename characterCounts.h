@@ -0,0 +1,110 @@
+/**
+ * @file characterCounts.h
+ * @brief Header file for exact character count files.
+ *
+ * This file contains declarations for functions for counting how many times each one of the 128
+ * ASCII characters occurs in a text file, and for reading, writing and merging count files.
+ * Unlike the probabilities, the counts are exact integers, so rare characters are never rounded to 0
+ * and the counts of many files can be added together to create one model. A count file starts with
+ * the COUNT_FILE_HEADER line and then has one integer per line, the count of that specific character.
+ * The functions that start with try print the error and return instead of stopping the program, for the server
+ * that must keep running when a count file it reloads is damaged.
+ *
+ * @author Spyros Sachmpazidis
+ * @bug No know bugs.
+ * @version 1.1
+ * @since 19/10/26
+ */
+
+#ifndef CHARACTER_COUNTS_H
+#define CHARACTER_COUNTS_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#ifndef ASCII_SIZE
+/*The size of the ASCII table*/
+#define ASCII_SIZE 128
+#endif
+
+/*The first line of every count file*/
+#define COUNT_FILE_HEADER "# huffman counts"
+
+/** @brief Reads a file and counts the occurrences of each character
+ *
+ *  This function reads a file and counts how many times each one of the 128 ASCII characters occurs.
+ *  Bytes outside the ASCII table are ignored.
+ *
+ *  @param inputFile the name of the input file(including .txt)
+ *  @return a pointer to an array with the count of each character
+ *  @since 1.0
+ */
+unsigned long long *calculateCounts(char *inputFile);
+
+/** @brief Writes the counts in a count file
+ *
+ *  This function writes the header line and then the count of each one of the 128 characters in a
+ *  separate line of the output file.
+ *
+ *  @param outputFile the name of the output file(including .txt)
+ *  @param charCount a pointer to the array with the count of each character
+ *  @since 1.0
+ */
+void writeCounts(char *outputFile, unsigned long long *charCount);
+
+/** @brief Reads a count file
+ *
+ *  This function reads the count of each one of the 128 characters from a count file. The whole file
+ *  is read at once and then parsed, and the program stops if the file does not have the header line
+ *  or does not have exactly 128 counts.
+ *
+ *  @param inputFile the name of the count file(including .txt)
+ *  @return a pointer to an array with the count of each character
+ *  @since 1.0
+ */
+unsigned long long *readCounts(char *inputFile);
+
+/** @brief Reads a count file without stopping the program
+ *
+ *  This function works like readCounts, but prints the error and returns NULL if the file cannot be read or
+ *  is not a valid count file.
+ *
+ *  @param inputFile the name of the count file(including .txt)
+ *  @return a pointer to an array with the count of each character, or NULL
+ *  @since 1.1
+ */
+unsigned long long *tryReadCounts(char *inputFile);
+
+/** @brief Checks if a file is a count file
+ *
+ *  This function checks if the first line of a file is the count file header.
+ *
+ *  @param inputFile the name of the file(including .txt)
+ *  @return 1 if the file is a count file and 0 otherwise
+ *  @since 1.0
+ */
+int isCountFile(char *inputFile);
+
+/** @brief Checks if a file is a count file without stopping the program
+ *
+ *  @param inputFile the name of the file(including .txt)
+ *  @return 1 if the file is a count file, 0 otherwise and -1 if the file cannot be opened
+ *  @since 1.1
+ */
+int tryIsCountFile(char *inputFile);
+
+/** @brief Merges many count files into one
+ *
+ *  This function adds together the counts of all the given count files and writes the sums
+ *  in the output file. The result is the same as counting all the original input files at once.
+ *
+ *  @param outputFile the name of the output count file(including .txt)
+ *  @param countFiles an array with the names of the count files to merge
+ *  @param fileCount the number of count files
+ *  @since 1.0
+ */
+void mergeCountFiles(char *outputFile, char **countFiles, int fileCount);
+
+#endif
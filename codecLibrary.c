@@ -0,0 +1,272 @@
+#include "codecLibrary.h"
+#include <math.h>
+
+/*The state of tryLibraryEncodeSegment between the blocks of the input file*/
+typedef struct
+{
+    CodecLibrary *library;
+    int backend;
+    HuffmanEncoder *encoders[LIBRARY_MAX_MODELS];
+    const TansTable *tables[LIBRARY_MAX_MODELS];
+    uint32_t costs[LIBRARY_MAX_MODELS][BYTE_SIZE];
+} LibraryEncoder;
+
+#ifdef DEBUG_CODEC_LIBRARY
+int main(int argc, char *argv[])
+{
+    if (argc != 4)
+    {
+        printf("Correct files not given!\n");
+        exit(EXIT_FAILURE);
+    }
+    printf("Debugging codecLibrary.c:\n");
+    printf("Trying to load the library %s...\n", argv[1]);
+    CodecModel *model = loadCodecLibrary(argv[1]);
+    printf("Success!Loaded %d models\n", model->library->count);
+    printf("Trying to encode %s into %s...\n", argv[2], argv[3]);
+    TransformChain transforms;
+    transforms.count = 0;
+    codecEncodeFile(model, BACKEND_HUFFMAN, &transforms, argv[2], argv[3]);
+    printf("Success!\n");
+    freeCodecModel(model);
+}
+#endif
+
+/*the CRC32C of the weights of a model as they are recorded in a segment*/
+static uint32_t modelFingerprint(CodecModel *model)
+{
+    EncodedSegment segment;
+    unsigned char payload[ENCODED_SEGMENT_SIZE];
+    describeSegment(&segment, model, BACKEND_HUFFMAN, 0);
+    writeSegment(payload, &segment);
+    uint32_t crc = crc32c(0, payload + 2, 1);
+    return crc32c(crc, payload + 16, ENCODED_SEGMENT_SIZE - 16);
+}
+
+CodecModel *loadCodecLibrary(char *probFiles)
+{
+    CodecModel *model = tryLoadCodecLibrary(probFiles);
+    if (model == NULL)
+        exit(EXIT_FAILURE);
+    return model;
+}
+
+/*frees the models that were loaded before a probfile of the library could not be loaded*/
+static CodecModel *abandonCodecLibrary(CodecLibrary *library, char *names)
+{
+    int i;
+    for (i = 0; i < library->count; i++)
+        freeCodecModel(library->models[i]);
+    free(library->models);
+    free(library);
+    free(names);
+    return NULL;
+}
+
+CodecModel *tryLoadCodecLibrary(char *probFiles)
+{
+    CodecLibrary *library = NULL;
+    char *names = NULL;
+    if ((library = (CodecLibrary *)malloc(sizeof(CodecLibrary))) == NULL ||
+        (library->models = (CodecModel **)malloc(LIBRARY_MAX_MODELS * sizeof(CodecModel *))) == NULL ||
+        (names = strdup(probFiles)) == NULL)
+    {
+        printf("System out of memory!");
+        exit(EXIT_FAILURE);
+    }
+
+    library->count = 0;
+    char *name = names, *end;
+    do
+    {
+        if ((end = strchr(name, LIBRARY_SEPARATOR)) != NULL)
+            *end = '\0';
+        if (*name == '\0')
+        {
+            printf("Error: Library %s has an empty probfile name\n", probFiles);
+            return abandonCodecLibrary(library, names);
+        }
+        if (library->count == LIBRARY_MAX_MODELS)
+        {
+            printf("Error: Library %s has more than %d probfiles\n", probFiles, LIBRARY_MAX_MODELS);
+            return abandonCodecLibrary(library, names);
+        }
+        CodecModel *model = tryLoadCodecModel(name);
+        if (model == NULL)
+            return abandonCodecLibrary(library, names);
+        library->fingerprints[library->count] = modelFingerprint(model);
+        library->models[library->count++] = model;
+        name = end + 1;
+    } while (end != NULL);
+    free(names);
+
+    library->models[0]->library = library;
+    return library->models[0];
+}
+
+void describeLibrarySegment(EncodedSegment *segment, CodecModel *model, int backend, unsigned long long inputOffset)
+{
+    CodecLibrary *library = model->library;
+    initializeSegment(segment, backend, inputOffset);
+    segment->hasModel = ENCODED_LIBRARY_MODEL;
+    segment->exact = 1;
+    segment->weights[0] = library->count;
+    int i;
+    for (i = 0; i < library->count; i++)
+        segment->weights[1 + i] = library->fingerprints[i];
+}
+
+int checkLibrarySegment(CodecModel *model, const EncodedSegment *segment)
+{
+    CodecLibrary *library = model->library;
+    if (library == NULL)
+    {
+        printf("Error: Encoded file was encoded with a library of %d models, give the same probfiles separated by "
+               "commas\n", (int)segment->weights[0]);
+        return 0;
+    }
+
+    int i, same = segment->weights[0] == library->count;
+    for (i = 0; same && i < library->count; i++)
+        same = segment->weights[1 + i] == library->fingerprints[i];
+    if (!same)
+    {
+        printf("Error: Encoded file was encoded with a different library of models, give the same probfiles in the "
+               "same order\n");
+        return 0;
+    }
+    return 1;
+}
+
+CodecModel *libraryBlockModel(CodecModel *model, const unsigned char *payload, size_t payloadLength)
+{
+    if (payloadLength == 0 || payload[0] >= model->library->count)
+    {
+        printf("Error: Encoded file has a block of a model that is not in the library of %d models\n",
+               model->library->count);
+        return NULL;
+    }
+
+    return model->library->models[payload[0]];
+}
+
+/*finds the bits of every character in every model, in LIBRARY_COST_SCALE parts of a bit*/
+static void computeCosts(LibraryEncoder *encoder)
+{
+    int m, c;
+    for (m = 0; m < encoder->library->count; m++)
+        for (c = 0; c < BYTE_SIZE; c++)
+        {
+            if (encoder->backend == BACKEND_HUFFMAN)
+            {
+                encoder->costs[m][c] = encoder->encoders[m]->lengths[c] * LIBRARY_COST_SCALE;
+                continue;
+            }
+            // a character that is not in the tans tables costs the escape symbol and its 8 bits
+            const int *frequency = encoder->tables[m]->frequency;
+            int symbol = c < ASCII_SIZE && frequency[c] > 0 ? c : TANS_ESCAPE;
+            double bits = log2((double)TANS_TABLE_SIZE / frequency[symbol]) + (symbol == TANS_ESCAPE ? 8 : 0);
+            encoder->costs[m][c] = (uint32_t)(bits * LIBRARY_COST_SCALE + 0.5);
+        }
+}
+
+/*finds the model that codes a block in the fewest bits from the histogram of the block*/
+static int cheapestModel(const LibraryEncoder *encoder, const unsigned char *data, size_t length, uint64_t *cost)
+{
+    // 4 histograms, so a run of the same character does not wait on 1 counter
+    uint32_t histograms[4][BYTE_SIZE];
+    memset(histograms, 0, sizeof(histograms));
+    size_t i;
+    for (i = 0; i + 4 <= length; i += 4)
+    {
+        histograms[0][data[i]]++;
+        histograms[1][data[i + 1]]++;
+        histograms[2][data[i + 2]]++;
+        histograms[3][data[i + 3]]++;
+    }
+    for (; i < length; i++)
+        histograms[0][data[i]]++;
+
+    uint32_t counts[BYTE_SIZE];
+    int used[BYTE_SIZE], usedCount = 0, c;
+    for (c = 0; c < BYTE_SIZE; c++)
+    {
+        counts[c] = histograms[0][c] + histograms[1][c] + histograms[2][c] + histograms[3][c];
+        if (counts[c] > 0)
+            used[usedCount++] = c;
+    }
+
+    int best = 0, m, k;
+    for (m = 0; m < encoder->library->count; m++)
+    {
+        uint64_t total = 0;
+        for (k = 0; k < usedCount; k++)
+            total += (uint64_t)counts[used[k]] * encoder->costs[m][used[k]];
+        if (m == 0 || total < *cost)
+        {
+            best = m;
+            *cost = total;
+        }
+    }
+    return best;
+}
+
+static size_t encodeLibraryBlock(const void *state, const unsigned char *data, size_t length, unsigned char *payload)
+{
+    const LibraryEncoder *encoder = (const LibraryEncoder *)state;
+    uint64_t cost = 0;
+    int model = cheapestModel(encoder, data, length, &cost);
+    TRACE_PROBE2(library_block, model, cost / LIBRARY_COST_SCALE);
+
+    payload[0] = model;
+    if (encoder->backend == BACKEND_TANS)
+        return 1 + encodeTansPayload(encoder->tables[model], data, length, payload + 1);
+    return 1 + encodeHuffmanPayload(encoder->encoders[model], data, length, payload + 1);
+}
+
+int tryLibraryEncodeSegment(CodecModel *model, const EncodedSegment *segment, char *inputFile, char *outputFile)
+{
+    LibraryEncoder *encoder = NULL;
+    if ((encoder = (LibraryEncoder *)malloc(sizeof(LibraryEncoder))) == NULL)
+    {
+        printf("System out of memory!");
+        exit(EXIT_FAILURE);
+    }
+
+    // every table is created before the first block, so the blocks only count their characters
+    encoder->library = model->library;
+    encoder->backend = segment->backend;
+    size_t maxPayload = TANS_MAX_PAYLOAD;
+    int m;
+    for (m = 0; m < encoder->library->count; m++)
+    {
+        CodecModel *libraryModel = encoder->library->models[m];
+        if (encoder->backend == BACKEND_TANS)
+            encoder->tables[m] = getTansTable(libraryModel);
+        else
+        {
+            encoder->encoders[m] = createHuffmanEncoder(libraryModel->codes);
+            size_t modelPayload = MAX_BLOCK_PAYLOAD(maxCodeLength(libraryModel->codes));
+            if (m == 0 || modelPayload > maxPayload)
+                maxPayload = modelPayload;
+        }
+    }
+    computeCosts(encoder);
+
+    int done = tryEncodeBlocks(inputFile, outputFile, segment, encodeLibraryBlock, 1 + maxPayload, encoder);
+
+    if (encoder->backend == BACKEND_HUFFMAN)
+        for (m = 0; m < encoder->library->count; m++)
+            free(encoder->encoders[m]);
+    free(encoder);
+    return done;
+}
+
+void freeCodecLibrary(CodecLibrary *library)
+{
+    int i;
+    for (i = 1; i < library->count; i++)
+        freeCodecModel(library->models[i]);
+    free(library->models);
+    free(library);
+}
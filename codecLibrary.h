@@ -0,0 +1,138 @@
+/**
+ * @file codecLibrary.h
+ * @brief Header file for libraries of models that are chosen block by block.
+ *
+ * This file contains declarations for functions for loading many probfiles at once and encoding every block with
+ * the model that codes it in the fewest bits. Files that mix different kinds of data, like text and tables of
+ * numbers, are encoded with a model that fits each part instead of 1 model that fits none of them.
+ *
+ * The models are loaded once, with all their tables, before the first block. For every block the characters are
+ * counted into 4 histograms, so the counts of the same character do not wait for each other, and the cost of the
+ * block with every model is the sum of each count times the bits of its character in that model. The bits of every
+ * character are found once for every model, the length of its huffman code or the bits of its frequency in the tans
+ * tables, so choosing a model costs 1 pass over the block and a few multiplications, and no tree is built while the
+ * blocks are encoded.
+ *
+ * The segment of a file that is encoded with a library records the number of models and a CRC32C of each of them
+ * instead of the weights of 1 model, and the payload of every block starts with the number of its model in the
+ * library. The same probfiles must be given in the same order to decode it.
+ *
+ * @author Spyros Sachmpazidis
+ * @bug No know bugs.
+ * @version 1.2
+ * @since 19/10/26
+ */
+
+#ifndef CODEC_LIBRARY_H
+#define CODEC_LIBRARY_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "codecModel.h"
+#include "encodedFile.h"
+#include "crc32c.h"
+
+/*The character that separates the probfiles of a library*/
+#define LIBRARY_SEPARATOR ','
+/*The most models of a library, their number and checksums fill the weights of a segment*/
+#define LIBRARY_MAX_MODELS (ASCII_SIZE - 1)
+/*The fraction of a bit that the cost of a character is counted in*/
+#define LIBRARY_COST_SCALE 16
+
+/**
+ * @struct codecLibrary
+ * @brief Represents the models of a library.
+ *
+ * The structure contains the number of models, the models in the order of their probfiles and the CRC32C of the
+ * recorded weights of every model, which is all that is recorded in an encoded file.
+ *
+ * @since 1.0
+ */
+struct codecLibrary
+{
+    int count;
+    CodecModel **models;
+    uint32_t fingerprints[LIBRARY_MAX_MODELS];
+};
+
+/**
+ * @brief Loads every probfile of a list separated by LIBRARY_SEPARATOR.
+ *
+ * The first model is returned and has the library, so it is used like any other model where a library is not
+ * supported. The program stops if the list has more than LIBRARY_MAX_MODELS probfiles or an empty name.
+ *
+ * @param probFiles The list of probfiles.
+ * @return A pointer to the first model of the library.
+ * @since 1.0
+ */
+CodecModel *loadCodecLibrary(char *probFiles);
+
+/**
+ * @brief Loads every probfile of a list separated by LIBRARY_SEPARATOR without stopping the program.
+ *
+ * This function works like loadCodecLibrary, but prints the error and returns NULL if any probfile cannot be loaded,
+ * freeing the models that were already loaded.
+ *
+ * @param probFiles The list of probfiles.
+ * @return A pointer to the first model of the library, or NULL.
+ * @since 1.1
+ */
+CodecModel *tryLoadCodecLibrary(char *probFiles);
+
+/**
+ * @brief Describes a segment that is encoded with the library of a model and records the library in it.
+ *
+ * @param segment Pointer to the segment.
+ * @param model Pointer to the first model of the library.
+ * @param backend The coder of the segment, either BACKEND_HUFFMAN or BACKEND_TANS.
+ * @param inputOffset The offset in the decoded file where the segment starts.
+ * @since 1.0
+ */
+void describeLibrarySegment(EncodedSegment *segment, CodecModel *model, int backend, unsigned long long inputOffset);
+
+/**
+ * @brief Checks that a segment was encoded with the library of a model.
+ *
+ * @param model Pointer to the model given by the user.
+ * @param segment Pointer to a segment that records a library.
+ * @return 1 if the model has the library of the segment, 0 if it has no library or a different one, the error is
+ * printed.
+ * @since 1.0
+ */
+int checkLibrarySegment(CodecModel *model, const EncodedSegment *segment);
+
+/**
+ * @brief Finds the model that a block of a segment with a library was encoded with.
+ *
+ * @param model Pointer to the first model of the library.
+ * @param payload The payload of the coder, it starts with the number of the model.
+ * @param payloadLength The number of bytes in the payload.
+ * @return A pointer to the model of the block, or NULL if the payload is empty or names a model that the library
+ * does not have, the error is printed.
+ * @since 1.0
+ */
+CodecModel *libraryBlockModel(CodecModel *model, const unsigned char *payload, size_t payloadLength);
+
+/**
+ * @brief Encodes a file into a segment that records a library, choosing the model of every block.
+ *
+ * @param model Pointer to the first model of the library.
+ * @param segment Pointer to the segment, described with describeLibrarySegment.
+ * @param inputFile The input file.
+ * @param outputFile The encoded file.
+ * @return 1 if the file was encoded, 0 if a file could not be opened, read or written, the error is printed.
+ * @since 1.0
+ */
+int tryLibraryEncodeSegment(CodecModel *model, const EncodedSegment *segment, char *inputFile, char *outputFile);
+
+/**
+ * @brief Frees the models of a library except the first and the library itself.
+ *
+ * @param library Pointer to the library.
+ * @since 1.0
+ */
+void freeCodecLibrary(CodecLibrary *library);
+
+#endif
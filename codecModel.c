@@ -0,0 +1,516 @@
+#include "codecModel.h"
+#include "codecLibrary.h"
+
+#ifdef BAKED_MODEL
+/*The model generated by modelGenerator.c and compiled into the program*/
+extern CodecModel bakedModel;
+#endif
+
+CodecModel *loadCodecModel(char *probFile)
+{
+    CodecModel *model = tryLoadCodecModel(probFile);
+    if (model == NULL)
+        exit(EXIT_FAILURE);
+    return model;
+}
+
+CodecModel *tryLoadCodecModel(char *probFile)
+{
+#ifdef BAKED_MODEL
+    if (strcmp(probFile, BAKED_MODEL_NAME) == 0)
+        return &bakedModel;
+#endif
+    if (strchr(probFile, LIBRARY_SEPARATOR) != NULL)
+        return tryLoadCodecLibrary(probFile);
+
+    int exact;
+    double *weights = tryReadModel(probFile, &exact);
+    if (weights == NULL)
+        return NULL;
+    return createCodecModel(weights, exact);
+}
+
+CodecModel *createCodecModel(double *weights, int exact)
+{
+    CodecModel *model = NULL;
+    if ((model = (CodecModel *)malloc(sizeof(CodecModel))) == NULL)
+    {
+        printf("System out of memory!");
+        exit(EXIT_FAILURE);
+    }
+
+    model->weights = weights;
+    model->exact = exact;
+    model->tree = createHuffmanTreeFromWeights(weights, exact);
+    model->codes = createHuffmanTable(model->tree);
+    model->decodeTable = NULL;
+    model->legacyTree = NULL;
+    model->tansTable = NULL;
+    model->baked = 0;
+    model->library = NULL;
+    return model;
+}
+
+const HuffmanDecodeTable *getHuffmanDecodeTable(CodecModel *model)
+{
+    if (model->decodeTable == NULL)
+        model->decodeTable = createHuffmanDecodeTable(model->tree, model->codes);
+
+    return model->decodeTable;
+}
+
+HuffmanTree *getLegacyTree(CodecModel *model)
+{
+    if (model->legacyTree == NULL)
+        model->legacyTree = createLegacyHuffmanTree(model->weights, model->exact);
+
+    return model->legacyTree;
+}
+
+const TansTable *getTansTable(CodecModel *model)
+{
+    if (model->tansTable == NULL)
+        model->tansTable = createTansTable(model->weights);
+
+    return model->tansTable;
+}
+
+void prepareCodecModel(CodecModel *model)
+{
+    getHuffmanDecodeTable(model);
+    getLegacyTree(model);
+    getTansTable(model);
+    int i;
+    for (i = 1; model->library != NULL && i < model->library->count; i++)
+        prepareCodecModel(model->library->models[i]);
+}
+
+void describeSegment(EncodedSegment *segment, CodecModel *model, int backend, unsigned long long inputOffset)
+{
+    initializeSegment(segment, backend, inputOffset);
+    segment->hasModel = 1;
+    segment->exact = model->exact;
+    memcpy(segment->weights, model->weights, sizeof(segment->weights));
+}
+
+CodecModel *createSegmentModel(const EncodedSegment *segment)
+{
+    double *weights = NULL;
+    if ((weights = (double *)malloc(sizeof(segment->weights))) == NULL)
+    {
+        printf("System out of memory!");
+        exit(EXIT_FAILURE);
+    }
+    memcpy(weights, segment->weights, sizeof(segment->weights));
+    return createCodecModel(weights, segment->exact);
+}
+
+CodecModel *segmentModel(CodecModel *model, const EncodedSegment *segment, CodecModel **recorded)
+{
+    // a library is only recorded by its checksums, so the blocks are decoded with the models of the user
+    if (segment->hasModel == ENCODED_LIBRARY_MODEL)
+    {
+        return checkLibrarySegment(model, segment) ? model : NULL;
+    }
+    if (!segment->hasModel ||
+        (segment->exact == model->exact && memcmp(segment->weights, model->weights, sizeof(segment->weights)) == 0))
+        return model;
+
+    // the model of the last segment is kept, since the segments of a file almost always share it
+    if (*recorded != NULL && segment->exact == (*recorded)->exact &&
+        memcmp(segment->weights, (*recorded)->weights, sizeof(segment->weights)) == 0)
+        return *recorded;
+
+    if (*recorded != NULL)
+        freeCodecModel(*recorded);
+    *recorded = createSegmentModel(segment);
+    return *recorded;
+}
+
+/*decodes the characters that the coder of the segment wrote, before any transform is inverted, returns 0 if they
+ cannot be decoded*/
+static int decodeCoderPayload(CodecModel *model, const EncodedSegment *segment, const unsigned char *payload,
+                              size_t payloadLength, size_t length, unsigned char *out)
+{
+    // every block of a library starts with the number of its model
+    if (segment->hasModel == ENCODED_LIBRARY_MODEL)
+    {
+        if ((model = libraryBlockModel(model, payload, payloadLength)) == NULL)
+            return 0;
+        payload++;
+        payloadLength--;
+    }
+    if (segment->backend == BACKEND_TANS)
+        return decodeTansPayload(getTansTable(model), payload, payloadLength, length, out);
+    if (segment->backend == BACKEND_HUFFMAN)
+        return decodeHuffmanPayload(getHuffmanDecodeTable(model), payload, payloadLength, length, out);
+
+    if (segment->backend == BACKEND_PACKED_LEGACY)
+        printf("Error: Encoded file was packed from a text file, its blocks can only be decoded in order\n");
+    else if (segment->backend == BACKEND_TOKENS)
+        printf("Error: Encoded file was encoded with a token model, decode it with its token model file\n");
+    else
+        printf("Error: Unknown coder %d in encoded file\n", segment->backend);
+    return 0;
+}
+
+int decodeCodecPayload(CodecModel *model, const EncodedSegment *segment, TransformBuffers *buffers,
+                       const unsigned char *payload, size_t payloadLength, size_t length, unsigned char *out)
+{
+    if (segment->transforms.count == 0)
+        return decodeCoderPayload(model, segment, payload, payloadLength, length, out);
+
+    uint32_t parameters[TRANSFORM_MAX_STAGES];
+    size_t transformedLength;
+    size_t headerLength = readTransformHeader(segment, payload, payloadLength, parameters, &transformedLength);
+    return headerLength > 0 &&
+           decodeCoderPayload(model, segment, payload + headerLength, payloadLength - headerLength, transformedLength,
+                              buffers->blocks[0]) &&
+           invertTransforms(buffers, &segment->transforms, parameters, buffers->blocks[0], transformedLength, out,
+                            length);
+}
+
+void codecEncodeSegment(CodecModel *model, const EncodedSegment *segment, char *inputFile, char *outputFile)
+{
+    if (!tryCodecEncodeSegment(model, segment, inputFile, outputFile))
+        exit(EXIT_FAILURE);
+}
+
+int tryCodecEncodeSegment(CodecModel *model, const EncodedSegment *segment, char *inputFile, char *outputFile)
+{
+    if (segment->hasModel == ENCODED_LIBRARY_MODEL)
+        return tryLibraryEncodeSegment(model, segment, inputFile, outputFile);
+    if (segment->backend == BACKEND_TANS)
+        return tryTansEncodeFile(inputFile, outputFile, getTansTable(model), segment);
+    return tryEncodeFile(inputFile, outputFile, model->codes, segment);
+}
+
+void codecEncodeFile(CodecModel *model, int backend, const TransformChain *transforms, char *inputFile, char *outputFile)
+{
+    if (!tryCodecEncodeFile(model, backend, transforms, inputFile, outputFile))
+        exit(EXIT_FAILURE);
+}
+
+int tryCodecEncodeFile(CodecModel *model, int backend, const TransformChain *transforms, char *inputFile,
+                       char *outputFile)
+{
+    EncodedSegment segment;
+    if (model->library != NULL)
+        describeLibrarySegment(&segment, model, backend, 0);
+    else
+        describeSegment(&segment, model, backend, 0);
+    segment.transforms = *transforms;
+    return tryCodecEncodeSegment(model, &segment, inputFile, outputFile);
+}
+
+/*The state of the counting pass of codecTrainEncodeFile*/
+typedef struct
+{
+    const TransformChain *transforms;
+    TransformBuffers *buffers;
+    unsigned long long counts[ASCII_SIZE];
+} MemoryCounter;
+
+static void countMemoryBlock(void *state, const unsigned char *data, size_t length, Pipeline *pipe)
+{
+    MemoryCounter *counter = (MemoryCounter *)state;
+    (void)pipe;
+    // the characters are counted as the coder will see them
+    if (counter->transforms->count > 0)
+    {
+        uint32_t parameters[TRANSFORM_MAX_STAGES];
+        data = applyTransforms(counter->buffers, counter->transforms, data, length, parameters, &length);
+    }
+    size_t i;
+    for (i = 0; i < length; i++)
+        if (data[i] < ASCII_SIZE)
+            counter->counts[data[i]]++;
+}
+
+/*maps the input file, or reads it into memory if it cannot be mapped, and finds if it is too large to keep in memory*/
+static unsigned char *mapInput(char *inputFile, size_t *length, int *mapped, int *stream)
+{
+    int fd;
+    if ((fd = open(inputFile, O_RDONLY)) < 0)
+    {
+        printf("Error: Unable to open %s\n", inputFile);
+        exit(EXIT_FAILURE);
+    }
+
+    struct stat inputStat;
+    *mapped = 0;
+    *stream = 0;
+    if (fstat(fd, &inputStat) == 0 && S_ISREG(inputStat.st_mode) && inputStat.st_size > 0)
+    {
+        // a file larger than a quarter of the memory is streamed, the pages of the mapping are let go of as they are passed
+        long pages = sysconf(_SC_PHYS_PAGES), pageSize = sysconf(_SC_PAGE_SIZE);
+        *length = inputStat.st_size;
+        *stream = pages > 0 && pageSize > 0 && (unsigned long long)*length > (unsigned long long)pages * pageSize / 4;
+        int flags = MAP_PRIVATE;
+#ifdef MAP_POPULATE
+        if (!*stream)
+            flags |= MAP_POPULATE;
+#endif
+        void *data = mmap(NULL, *length, PROT_READ, flags, fd, 0);
+        if (data != MAP_FAILED)
+        {
+            close(fd);
+            *mapped = 1;
+            return (unsigned char *)data;
+        }
+        *stream = 0;
+    }
+
+    // pipes and files that cannot be mapped are read into memory
+    size_t capacity = PIPELINE_BLOCK_SIZE;
+    unsigned char *data = NULL;
+    *length = 0;
+    for (;;)
+    {
+        if (*length == capacity || data == NULL)
+        {
+            capacity *= 2;
+            unsigned char *temp = (unsigned char *)realloc(data, capacity);
+            if (temp == NULL)
+            {
+                printf("System out of memory!");
+                exit(EXIT_FAILURE);
+            }
+            data = temp;
+        }
+        ssize_t n = read(fd, data + *length, capacity - *length);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n < 0)
+        {
+            printf("Error: Unable to read input file\n");
+            exit(EXIT_FAILURE);
+        }
+        if (n == 0)
+            break;
+        *length += n;
+    }
+    close(fd);
+    return data;
+}
+
+void codecTrainEncodeFile(int backend, const TransformChain *transforms, char *inputFile, char *outputFile)
+{
+    size_t length;
+    int mapped, stream;
+    unsigned char *data = mapInput(inputFile, &length, &mapped, &stream);
+
+    // the first pass counts the characters in memory, so the file is only read once when it fits
+    MemoryCounter *counter = NULL;
+    if ((counter = (MemoryCounter *)calloc(1, sizeof(MemoryCounter))) == NULL)
+    {
+        printf("System out of memory!");
+        exit(EXIT_FAILURE);
+    }
+    counter->transforms = transforms;
+    counter->buffers = transforms->count > 0 ? createTransformBuffers() : NULL;
+    runPipelineOnMemory(data, length, stream, NULL, countMemoryBlock, counter);
+
+    double *weights = NULL;
+    if ((weights = (double *)malloc(ASCII_SIZE * sizeof(double))) == NULL)
+    {
+        printf("System out of memory!");
+        exit(EXIT_FAILURE);
+    }
+    int i;
+    for (i = 0; i < ASCII_SIZE; i++)
+        weights[i] = counter->counts[i];
+    if (counter->buffers != NULL)
+        freeTransformBuffers(counter->buffers);
+    free(counter);
+
+    // the exact counts are recorded in the segment, so the file is decoded without a probfile
+    CodecModel *model = createCodecModel(weights, 1);
+    EncodedSegment segment;
+    describeSegment(&segment, model, backend, 0);
+    segment.transforms = *transforms;
+    if (backend == BACKEND_TANS)
+        tansEncodeMemory(data, length, stream, outputFile, getTansTable(model), &segment);
+    else
+        encodeMemory(data, length, stream, outputFile, model->codes, &segment);
+
+    freeCodecModel(model);
+    if (mapped)
+        munmap(data, length);
+    else
+        free(data);
+}
+
+/*The state of tryCodecDecodeFile between the blocks of the encoded file*/
+typedef struct
+{
+    CodecModel *model;
+    CodecModel *recorded;
+    TransformBuffers *buffers;
+    unsigned char buffer[PIPELINE_BLOCK_SIZE];
+} CodecDecoder;
+
+static const unsigned char *codecDecodeBlock(void *state, const EncodedSegment *segment, const unsigned char *payload,
+                                            size_t payloadLength, size_t length, Pipeline *pipe)
+{
+    CodecDecoder *decoder = (CodecDecoder *)state;
+    CodecModel *model = segmentModel(decoder->model, segment, &decoder->recorded);
+    if (model == NULL ||
+        !decodeCodecPayload(model, segment, decoder->buffers, payload, payloadLength, length, decoder->buffer))
+    {
+        failPipeline(pipe);
+        return NULL;
+    }
+    return decoder->buffer;
+}
+
+void codecDecodeFile(CodecModel *model, char *inputFile, char *outputFile)
+{
+    if (!tryCodecDecodeFile(model, inputFile, outputFile))
+        exit(EXIT_FAILURE);
+}
+
+int tryCodecDecodeFile(CodecModel *model, char *inputFile, char *outputFile)
+{
+    int backend = readEncodedBackend(inputFile);
+    if (backend == BACKEND_UNREADABLE)
+        return 0;
+    if (backend == BACKEND_LEGACY)
+        return tryDecodeLegacyFile(inputFile, outputFile, getLegacyTree(model));
+    if (backend == BACKEND_PACKED_LEGACY)
+        return tryDecodePackedLegacyFile(inputFile, outputFile, getLegacyTree(model));
+
+    CodecDecoder *decoder = NULL;
+    if ((decoder = (CodecDecoder *)malloc(sizeof(CodecDecoder))) == NULL)
+    {
+        printf("System out of memory!");
+        exit(EXIT_FAILURE);
+    }
+
+    decoder->model = model;
+    decoder->recorded = NULL;
+    decoder->buffers = createTransformBuffers();
+    int decoded = tryDecodeBlocks(inputFile, outputFile, codecDecodeBlock, ENCODED_MAX_PAYLOAD, decoder);
+    if (decoder->recorded != NULL)
+        freeCodecModel(decoder->recorded);
+    freeTransformBuffers(decoder->buffers);
+    free(decoder);
+    return decoded;
+}
+
+void codecDecodeMember(CodecModel *model, const EncodedSegment *segment, const unsigned char *data, size_t length,
+                       char *name, char *outputFile)
+{
+    CodecDecoder *decoder = NULL;
+    if ((decoder = (CodecDecoder *)malloc(sizeof(CodecDecoder))) == NULL)
+    {
+        printf("System out of memory!");
+        exit(EXIT_FAILURE);
+    }
+
+    decoder->model = model;
+    decoder->recorded = NULL;
+    decoder->buffers = createTransformBuffers();
+    decodeMemoryBlocks(segment, data, length, name, outputFile, codecDecodeBlock, ENCODED_MAX_PAYLOAD, decoder);
+    if (decoder->recorded != NULL)
+        freeCodecModel(decoder->recorded);
+    freeTransformBuffers(decoder->buffers);
+    free(decoder);
+}
+
+/*returns 1 if the characters of the input file before the offset have the checksum of the last block*/
+static int endsWithLastBlock(char *inputFile, unsigned long long offset, const EncodedTail *tail)
+{
+    FILE *fp = NULL;
+    if ((fp = fopen(inputFile, "rb")) == NULL)
+    {
+        printf("Error: Unable to open %s\n", inputFile);
+        exit(EXIT_FAILURE);
+    }
+
+    unsigned char *block = NULL;
+    if ((block = (unsigned char *)malloc(tail->blockLength)) == NULL)
+    {
+        printf("System out of memory!");
+        exit(EXIT_FAILURE);
+    }
+    int same = fseeko(fp, offset - tail->blockLength, SEEK_SET) == 0 &&
+               fread(block, 1, tail->blockLength, fp) == tail->blockLength &&
+               crc32c(0, block, tail->blockLength) == tail->blockCrc;
+    free(block);
+    fclose(fp);
+    return same;
+}
+
+void codecAppendFile(char *inputFile, char *encodedFile)
+{
+    EncodedSegment segment;
+    EncodedTail tail;
+    unsigned long long encodedLength = readLastSegment(encodedFile, &segment, &tail);
+    if (!segment.hasModel)
+    {
+        printf("Error: %s has no recorded model, encode it again with -e\n", encodedFile);
+        exit(EXIT_FAILURE);
+    }
+    if (segment.hasModel == ENCODED_LIBRARY_MODEL)
+    {
+        printf("Error: %s was encoded with a library of models, which is not recorded, encode it again with -e\n",
+               encodedFile);
+        exit(EXIT_FAILURE);
+    }
+
+    // the input file must only have grown since it was encoded
+    struct stat inputStat;
+    if (stat(inputFile, &inputStat) != 0)
+    {
+        printf("Error: Unable to open %s\n", inputFile);
+        exit(EXIT_FAILURE);
+    }
+    if ((unsigned long long)inputStat.st_size < encodedLength)
+    {
+        printf("Error: %s is shorter than the %llu characters already encoded in %s\n", inputFile, encodedLength, encodedFile);
+        exit(EXIT_FAILURE);
+    }
+    if ((unsigned long long)inputStat.st_size == encodedLength)
+        return;
+    // only the last block is read again, to find an input that was changed instead of only added to
+    if (tail.blockLength > 0 && !endsWithLastBlock(inputFile, encodedLength, &tail))
+    {
+        printf("Error: The characters of %s that are encoded in %s have changed, encode it again with -e\n", inputFile,
+               encodedFile);
+        exit(EXIT_FAILURE);
+    }
+
+    // the new segment is written over the tail block, and is followed by a new one
+    if (truncate(encodedFile, tail.end) != 0)
+    {
+        printf("Error: Unable to write %s\n", encodedFile);
+        exit(EXIT_FAILURE);
+    }
+    CodecModel *model = createSegmentModel(&segment);
+    segment.inputOffset = encodedLength;
+    codecEncodeSegment(model, &segment, inputFile, encodedFile);
+    freeCodecModel(model);
+}
+
+void freeCodecModel(CodecModel *model)
+{
+    if (model->library != NULL)
+    {
+        freeCodecLibrary(model->library);
+        model->library = NULL;
+    }
+    if (model->baked)
+        return;
+
+    free(model->weights);
+    freeHuffmanTree(model->tree);
+    freeHuffmanTable(model->codes);
+    if (model->decodeTable != NULL)
+        freeHuffmanDecodeTable(model->decodeTable);
+    if (model->legacyTree != NULL)
+        freeHuffmanTree(model->legacyTree);
+    if (model->tansTable != NULL)
+        freeTansTable(model->tansTable);
+    free(model);
+}
@@ -0,0 +1,345 @@
+/**
+ * @file codecModel.h
+ * @brief Header file for loading a model with all its coding tables.
+ *
+ * This file contains declarations for functions for loading a probability or count file and creating
+ * everything that the coders need from it: the huffman tree, the huffman table, the huffman decode tables and the tans tables.
+ * When the program is built with a baked model (make baked), the name BAKED_MODEL_NAME can be used instead
+ * of a probfile, and the tables that were generated at compile time are used without any setup.
+ * The file also has the functions that encode and decode a file with a model, choosing the coder.
+ * Every encoded file records the model it was encoded with, so a file can be decoded and extended with its own
+ * model even if the probfile has changed since. A list of probfiles separated by commas is loaded as a library of
+ * models, see codecLibrary.h, whose blocks only record the number of their model.
+ *
+ * @author Spyros Sachmpazidis
+ * @bug No know bugs.
+ * @version 1.13
+ * @since 19/10/26
+ */
+
+#ifndef CODEC_MODEL_H
+#define CODEC_MODEL_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "huffmanTree.h"
+#include "huffmanTreeCreator.h"
+#include "huffmanTable.h"
+#include "huffmanEncoder.h"
+#include "huffmanDecoder.h"
+#include "tansCoder.h"
+
+/*The name that is given instead of a probfile to use the model baked into the program*/
+#define BAKED_MODEL_NAME "baked"
+
+/*The models of a library, defined in codecLibrary.h*/
+typedef struct codecLibrary CodecLibrary;
+
+/**
+ * @struct CodecModel
+ * @brief Represents a loaded model and its coding tables.
+ *
+ * The structure contains the weight of each character, if they are exact counts, the huffman tree,
+ * the huffman table, the huffman decode tables, the tree of the legacy text files and the tans tables.
+ * Every table except the huffman tree and table is only created the first time it is needed. The coders only read the
+ * tree, the decode tables and the tans tables, so those of the baked model can be static const. The first model of a
+ * library also has the library, and is used like any other model where a library cannot be used.
+ *
+ * @since 1.0
+ */
+typedef struct codecModel
+{
+    double *weights;
+    int exact;
+    const HuffmanTree *tree;
+    char **codes;
+    const HuffmanDecodeTable *decodeTable;
+    HuffmanTree *legacyTree;
+    const TansTable *tansTable;
+    int baked;
+    CodecLibrary *library;
+} CodecModel;
+
+/**
+ * @brief Loads a model from a probability or count file.
+ *
+ * This function reads the model file and creates the huffman tree and table of the model. If the name is a list
+ * of probfiles separated by commas, every one of them is loaded into a library.
+ * If the program was built with a baked model and the name is BAKED_MODEL_NAME, the baked model is returned
+ * and no file is read.
+ *
+ * @param probFile the name of the probability or count file(including .txt)
+ * @return A pointer to the loaded model.
+ * @since 1.0
+ */
+CodecModel *loadCodecModel(char *probFile);
+
+/**
+ * @brief Loads a model from a probability or count file without stopping the program.
+ *
+ * This function works like loadCodecModel, but prints the error and returns NULL if the probfile cannot be read or
+ * is not valid, so a program that must keep running can keep the model it already has.
+ *
+ * @param probFile the name of the probability or count file(including .txt)
+ * @return A pointer to the loaded model, or NULL.
+ * @since 1.11
+ */
+CodecModel *tryLoadCodecModel(char *probFile);
+
+/**
+ * @brief Creates a model from the weight of each character.
+ *
+ * @param weights a pointer to a double array with the weight of each character, the model frees it.
+ * @param exact 1 if the weights are exact counts and 0 if they are probabilities.
+ * @return A pointer to the created model.
+ * @since 1.3
+ */
+CodecModel *createCodecModel(double *weights, int exact);
+
+/**
+ * @brief Returns the huffman decode tables of a model.
+ *
+ * The tables are created the first time this function is called for the model.
+ *
+ * @param model Pointer to the model.
+ * @return A pointer to the huffman decode tables.
+ * @since 1.1
+ */
+const HuffmanDecodeTable *getHuffmanDecodeTable(CodecModel *model);
+
+/**
+ * @brief Returns the tree that decodes the text files of the first versions of the program.
+ *
+ * The tree is created the first time this function is called for the model.
+ *
+ * @param model Pointer to the model.
+ * @return A pointer to the legacy huffman tree.
+ * @since 1.1
+ */
+HuffmanTree *getLegacyTree(CodecModel *model);
+
+/**
+ * @brief Returns the tans tables of a model.
+ *
+ * The tables are created the first time this function is called for the model.
+ *
+ * @param model Pointer to the model.
+ * @return A pointer to the tans tables.
+ * @since 1.0
+ */
+const TansTable *getTansTable(CodecModel *model);
+
+/**
+ * @brief Creates all the tables of a model that are normally created the first time they are needed.
+ *
+ * After this function the model is only read by the coders, so it can be used by many threads at once.
+ *
+ * @param model Pointer to the model.
+ * @since 1.2
+ */
+void prepareCodecModel(CodecModel *model);
+
+/**
+ * @brief Describes a segment that is encoded with a model and records the model in it.
+ *
+ * @param segment Pointer to the segment.
+ * @param model Pointer to the model.
+ * @param backend The coder of the segment.
+ * @param inputOffset The offset in the decoded file where the segment starts.
+ * @since 1.3
+ */
+void describeSegment(EncodedSegment *segment, CodecModel *model, int backend, unsigned long long inputOffset);
+
+/**
+ * @brief Creates the model that is recorded in a segment.
+ *
+ * @param segment Pointer to a segment that records its model.
+ * @return A pointer to the new model.
+ * @since 1.8
+ */
+CodecModel *createSegmentModel(const EncodedSegment *segment);
+
+/**
+ * @brief Finds the model that decodes the blocks of a segment.
+ *
+ * The given model is used when the segment has no recorded model or records the same one. Otherwise the recorded
+ * model is created and kept in recorded, where it is used again for the next segments if they record the same
+ * model. The caller frees the model left in recorded.
+ *
+ * @param model Pointer to the model given by the user.
+ * @param segment Pointer to the segment.
+ * @param recorded Pointer to the model created for earlier segments, or to NULL.
+ * @return A pointer to the model of the segment, or NULL if the segment records a library that is not the model of
+ * the user, the error is printed.
+ * @since 1.3
+ */
+CodecModel *segmentModel(CodecModel *model, const EncodedSegment *segment, CodecModel **recorded);
+
+/**
+ * @brief Decodes the payload of 1 block into memory with the coder of its segment.
+ *
+ * If the segment has transforms, the transformed block is decoded into the buffers and the transforms are inverted.
+ *
+ * @param model Pointer to the model of the segment.
+ * @param segment Pointer to the segment.
+ * @param buffers Pointer to the buffers of the transforms.
+ * @param payload The payload of the block.
+ * @param payloadLength The number of bytes in the payload.
+ * @param length The number of characters that the block encodes.
+ * @param out The buffer that the characters are written to.
+ * @return 1 if the block was decoded, 0 if it is invalid or its coder cannot decode it here, the error is printed.
+ * @since 1.3
+ */
+int decodeCodecPayload(CodecModel *model, const EncodedSegment *segment, TransformBuffers *buffers,
+                       const unsigned char *payload, size_t payloadLength, size_t length, unsigned char *out);
+
+/**
+ * @brief Encodes a file into a segment with the coder of the segment.
+ *
+ * The segment can be the first of a new file, a segment added to the end of an encoded file or a member of an
+ * archive.
+ *
+ * @param model Pointer to the model of the segment.
+ * @param segment Pointer to the segment, its backend is either BACKEND_HUFFMAN or BACKEND_TANS.
+ * @param inputFile The input file.
+ * @param outputFile The encoded file.
+ * @since 1.8
+ */
+void codecEncodeSegment(CodecModel *model, const EncodedSegment *segment, char *inputFile, char *outputFile);
+
+/**
+ * @brief Encodes a file into a segment without stopping the program.
+ *
+ * This function works like codecEncodeSegment, but prints the error and returns 0 if a file cannot be opened, read
+ * or written.
+ *
+ * @param model Pointer to the model of the segment.
+ * @param segment Pointer to the segment, its backend is either BACKEND_HUFFMAN or BACKEND_TANS.
+ * @param inputFile The input file.
+ * @param outputFile The encoded file.
+ * @return 1 if the file was encoded, 0 otherwise.
+ * @since 1.13
+ */
+int tryCodecEncodeSegment(CodecModel *model, const EncodedSegment *segment, char *inputFile, char *outputFile);
+
+/**
+ * @brief Encodes a file with a model.
+ *
+ * The transforms are applied to every block before it is encoded and are recorded in the file, so the decoder
+ * inverts them without being told.
+ *
+ * @param model Pointer to the model.
+ * @param backend The coder to use, either BACKEND_HUFFMAN or BACKEND_TANS.
+ * @param transforms Pointer to the chain of transforms, it can have no transforms.
+ * @param inputFile The input file.
+ * @param outputFile The encoded file.
+ * @since 1.2
+ */
+void codecEncodeFile(CodecModel *model, int backend, const TransformChain *transforms, char *inputFile, char *outputFile);
+
+/**
+ * @brief Encodes a file with a model without stopping the program.
+ *
+ * This function works like codecEncodeFile, but prints the error and returns 0 if a file cannot be opened, read or
+ * written, so a server can go on with its other requests.
+ *
+ * @param model Pointer to the model.
+ * @param backend The coder to use, either BACKEND_HUFFMAN or BACKEND_TANS.
+ * @param transforms Pointer to the chain of transforms, it can have no transforms.
+ * @param inputFile The input file.
+ * @param outputFile The encoded file.
+ * @return 1 if the file was encoded, 0 otherwise.
+ * @since 1.13
+ */
+int tryCodecEncodeFile(CodecModel *model, int backend, const TransformChain *transforms, char *inputFile,
+                       char *outputFile);
+
+/**
+ * @brief Counts the characters of a file and encodes it with their exact counts, reading it only once.
+ *
+ * The file is mapped into memory, or read into memory if it cannot be mapped, and the characters are counted from
+ * the mapping. The model is created from the counts and the blocks are encoded straight from the same mapping, and
+ * the counts are recorded in the encoded file like every other model, so no probfile is written or read. A file
+ * larger than a quarter of the memory is streamed in both passes, each window of the mapping is read ahead and let
+ * go of after it is passed, so it is read twice but never opened again.
+ *
+ * @param backend The coder to use, either BACKEND_HUFFMAN or BACKEND_TANS.
+ * @param transforms Pointer to the chain of transforms, the characters are counted after them.
+ * @param inputFile The input file.
+ * @param outputFile The encoded file.
+ * @since 1.7
+ */
+void codecTrainEncodeFile(int backend, const TransformChain *transforms, char *inputFile, char *outputFile);
+
+/**
+ * @brief Decodes a file with a model.
+ *
+ * The coder and the model of every segment are found from the file, so files with many segments are decoded
+ * like any other. The given model is only used for the segments that do not record one, and files without a header
+ * are decoded as the text files of the first versions of the program.
+ *
+ * @param model Pointer to the model.
+ * @param inputFile The encoded file.
+ * @param outputFile The decoded file.
+ * @since 1.2
+ */
+void codecDecodeFile(CodecModel *model, char *inputFile, char *outputFile);
+
+/**
+ * @brief Decodes a file with a model without stopping the program.
+ *
+ * This function works like codecDecodeFile, but prints the error and returns 0 if the file is invalid, corrupt or
+ * was encoded with a different model, or if a file cannot be opened, read or written. The decoding stops at the
+ * first block that cannot be decoded, and the output file is left with the characters decoded before it.
+ *
+ * @param model Pointer to the model.
+ * @param inputFile The encoded file.
+ * @param outputFile The decoded file.
+ * @return 1 if the whole file was decoded, 0 otherwise.
+ * @since 1.13
+ */
+int tryCodecDecodeFile(CodecModel *model, char *inputFile, char *outputFile);
+
+/**
+ * @brief Decodes a member of an archive that is in memory.
+ *
+ * The model must have all its tables prepared when members are decoded by many threads at once.
+ *
+ * @param model Pointer to the model of the segment.
+ * @param segment Pointer to the segment of the member, from the model table of the archive.
+ * @param data The blocks of the member.
+ * @param length The number of bytes of the blocks.
+ * @param name The name of the member.
+ * @param outputFile The decoded file.
+ * @since 1.8
+ */
+void codecDecodeMember(CodecModel *model, const EncodedSegment *segment, const unsigned char *data, size_t length,
+                       char *name, char *outputFile);
+
+/**
+ * @brief Encodes the part of a file that was added since it was last encoded.
+ *
+ * The encoded file already has the first characters of the input file. Only the characters after them are
+ * encoded, with the coder, the model and the transforms of the last segment, and they are added to the end of the encoded file as a
+ * new segment. The cost is proportional to the new characters only. The input file must only have grown since, and
+ * the characters of the last block are read again to check that they still match its checksum. The new segment is
+ * written over the tail block of the encoded file.
+ *
+ * @param inputFile The input file.
+ * @param encodedFile The encoded file.
+ * @since 1.3
+ */
+void codecAppendFile(char *inputFile, char *encodedFile);
+
+/**
+ * @brief Frees the memory allocated for a model and its tables.
+ *
+ * A baked model is never freed.
+ *
+ * @param model Pointer to the model.
+ * @since 1.0
+ */
+void freeCodecModel(CodecModel *model);
+
+#endif
@@ -0,0 +1,552 @@
+#include "codecServer.h"
+
+/*A loaded model, it is freed when the server and the last request that uses it are done with it*/
+typedef struct
+{
+    CodecModel *model;
+    int references;
+} CachedModel;
+
+/*A model of the server and the probfile it is loaded from*/
+typedef struct
+{
+    char probFile[SERVER_PATH_SIZE];
+    struct timespec loaded;
+    struct timespec pending;
+    CachedModel *cached;
+} ModelSlot;
+
+/*The models of the server and the connections that are waiting for a worker*/
+typedef struct
+{
+    ModelSlot *slots;
+    int slotCount;
+    pthread_mutex_t lock;
+    pthread_cond_t notEmpty;
+    pthread_cond_t notFull;
+    int queue[SERVER_QUEUE_SIZE];
+    int head;
+    int count;
+} Server;
+
+/*Set by SIGINT and SIGTERM to stop the server*/
+static volatile sig_atomic_t stopServer = 0;
+
+#ifdef DEBUG_CODEC_SERVER
+int main(int argc, char *argv[])
+{
+    if (argc < 3)
+    {
+        printf("Correct files not given!\n");
+        exit(EXIT_FAILURE);
+    }
+    printf("Debugging codecServer.c:\n");
+    printf("Trying to serve %d models on %s...\n", argc - 2, argv[1]);
+    runServer(argv[1], &argv[2], argc - 2);
+    printf("Success!\n");
+}
+#endif
+
+static void handleStop(int signal)
+{
+    (void)signal;
+    stopServer = 1;
+}
+
+/*turns a path into a full path, the file does not need to exist*/
+static void resolvePath(char *path, char *resolved)
+{
+    char buffer[PATH_MAX];
+    if (realpath(path, buffer) != NULL && strlen(buffer) < SERVER_PATH_SIZE)
+    {
+        strcpy(resolved, buffer);
+        return;
+    }
+
+    if (path[0] == '/')
+        buffer[0] = '\0';
+    else if (getcwd(buffer, sizeof(buffer)) == NULL)
+    {
+        printf("Error: Unable to find the current directory\n");
+        exit(EXIT_FAILURE);
+    }
+    if (snprintf(resolved, SERVER_PATH_SIZE, "%s%s%s", buffer, buffer[0] ? "/" : "", path) >= SERVER_PATH_SIZE)
+    {
+        printf("Error: Path %s is too long\n", path);
+        exit(EXIT_FAILURE);
+    }
+}
+
+static int readFully(int fd, void *data, size_t length)
+{
+    unsigned char *bytes = (unsigned char *)data;
+    while (length > 0)
+    {
+        ssize_t n = read(fd, bytes, length);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return 0;
+        bytes += n;
+        length -= n;
+    }
+    return 1;
+}
+
+static int writeFully(int fd, const void *data, size_t length)
+{
+    const unsigned char *bytes = (const unsigned char *)data;
+    while (length > 0)
+    {
+        ssize_t n = send(fd, bytes, length, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return 0;
+        bytes += n;
+        length -= n;
+    }
+    return 1;
+}
+
+static int setSocketAddress(struct sockaddr_un *address, char *socketPath)
+{
+    if (strlen(socketPath) >= sizeof(address->sun_path))
+        return 0;
+
+    memset(address, 0, sizeof(struct sockaddr_un));
+    address->sun_family = AF_UNIX;
+    strcpy(address->sun_path, socketPath);
+    return 1;
+}
+
+/*returns a socket connected to the server, or -1 if no server is listening*/
+static int connectToServer(char *socketPath)
+{
+    struct sockaddr_un address;
+    if (!setSocketAddress(&address, socketPath))
+        return -1;
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0)
+        return -1;
+    if (connect(fd, (struct sockaddr *)&address, sizeof(address)) != 0)
+    {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/*returns 0 if the file does not exist*/
+static int readModifiedTime(char *path, struct timespec *modified)
+{
+    struct stat fileStat;
+    if (stat(path, &fileStat) != 0)
+        return 0;
+
+    *modified = fileStat.st_mtim;
+    return 1;
+}
+
+static int sameTime(struct timespec a, struct timespec b)
+{
+    return a.tv_sec == b.tv_sec && a.tv_nsec == b.tv_nsec;
+}
+
+/*loads a model with all its tables, so the workers only ever read it, returns NULL if the probfile is not valid*/
+static CachedModel *loadCachedModel(char *probFile)
+{
+    CodecModel *model = tryLoadCodecModel(probFile);
+    if (model == NULL)
+        return NULL;
+
+    CachedModel *cached = NULL;
+    if ((cached = (CachedModel *)malloc(sizeof(CachedModel))) == NULL)
+    {
+        printf("System out of memory!");
+        exit(EXIT_FAILURE);
+    }
+
+    cached->model = model;
+    prepareCodecModel(cached->model);
+    cached->references = 1;
+    return cached;
+}
+
+static CachedModel *acquireModel(Server *server, char *probFile)
+{
+    CachedModel *cached = NULL;
+    int i;
+    pthread_mutex_lock(&server->lock);
+    for (i = 0; i < server->slotCount; i++)
+    {
+        if (strcmp(server->slots[i].probFile, probFile) == 0)
+        {
+            cached = server->slots[i].cached;
+            cached->references++;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&server->lock);
+    return cached;
+}
+
+static void releaseModel(Server *server, CachedModel *cached)
+{
+    pthread_mutex_lock(&server->lock);
+    int last = --cached->references == 0;
+    pthread_mutex_unlock(&server->lock);
+
+    if (last)
+    {
+        freeCodecModel(cached->model);
+        free(cached);
+    }
+}
+
+/*checks that both files can be opened before they are coded, so the client is told which request it cannot do*/
+static int canOpenFiles(ServerRequest *request)
+{
+    int fd;
+    if ((fd = open(request->inputFile, O_RDONLY)) < 0)
+        return 0;
+    close(fd);
+    if ((fd = open(request->outputFile, O_WRONLY | O_CREAT, 0644)) < 0)
+        return 0;
+    close(fd);
+    return 1;
+}
+
+/*codes a request with the loaded model, the coders print their error and return it instead of stopping the server*/
+static unsigned char codeRequest(CachedModel *cached, ServerRequest *request)
+{
+    int done;
+    if (request->operation == 'e')
+        done = tryCodecEncodeFile(cached->model, request->backend, &request->transforms, request->inputFile,
+                                  request->outputFile);
+    else
+        done = tryCodecDecodeFile(cached->model, request->inputFile, request->outputFile);
+    if (done)
+        return SERVER_OK;
+
+    printf("Error: The request for %s failed\n", request->inputFile);
+    fflush(stdout);
+    return SERVER_FAILED;
+}
+
+static void serveConnection(Server *server, int fd)
+{
+    ServerRequest request;
+    if (!readFully(fd, &request, sizeof(ServerRequest)))
+    {
+        close(fd);
+        return;
+    }
+    request.model[SERVER_PATH_SIZE - 1] = '\0';
+    request.inputFile[SERVER_PATH_SIZE - 1] = '\0';
+    request.outputFile[SERVER_PATH_SIZE - 1] = '\0';
+
+    unsigned char status = SERVER_OK;
+    CachedModel *cached = acquireModel(server, request.model);
+    if (cached == NULL)
+        status = SERVER_UNKNOWN_MODEL;
+    else if (request.operation != 'd' &&
+             (request.operation != 'e' || (request.backend != BACKEND_HUFFMAN && request.backend != BACKEND_TANS) ||
+              !isValidTransformChain(&request.transforms)))
+        status = SERVER_BAD_REQUEST;
+    else if (!canOpenFiles(&request))
+        status = SERVER_CANNOT_OPEN;
+    else
+        status = codeRequest(cached, &request);
+
+    if (cached != NULL)
+        releaseModel(server, cached);
+    writeFully(fd, &status, 1);
+    close(fd);
+}
+
+static void *workerThread(void *arg)
+{
+    Server *server = (Server *)arg;
+    for (;;)
+    {
+        pthread_mutex_lock(&server->lock);
+        while (server->count == 0 && !stopServer)
+            pthread_cond_wait(&server->notEmpty, &server->lock);
+        if (server->count == 0)
+        {
+            pthread_mutex_unlock(&server->lock);
+            break;
+        }
+        int fd = server->queue[server->head];
+        server->head = (server->head + 1) % SERVER_QUEUE_SIZE;
+        server->count--;
+        pthread_cond_signal(&server->notFull);
+        pthread_mutex_unlock(&server->lock);
+
+        serveConnection(server, fd);
+    }
+    return NULL;
+}
+
+static void *reloadThread(void *arg)
+{
+    Server *server = (Server *)arg;
+    while (!stopServer)
+    {
+        sleep(SERVER_RELOAD_INTERVAL);
+
+        int i;
+        for (i = 0; i < server->slotCount && !stopServer; i++)
+        {
+            ModelSlot *slot = &server->slots[i];
+            struct timespec modified;
+            if (!readModifiedTime(slot->probFile, &modified) || sameTime(modified, slot->loaded))
+            {
+                slot->pending = slot->loaded;
+                continue;
+            }
+            // a file that is still being written is only loaded once it has not changed for a whole interval
+            if (!sameTime(modified, slot->pending))
+            {
+                slot->pending = modified;
+                continue;
+            }
+
+            // a probfile that is not valid keeps the old model until it changes again
+            CachedModel *cached = loadCachedModel(slot->probFile);
+            slot->loaded = modified;
+            if (cached == NULL)
+            {
+                printf("Error: Unable to reload %s, the model that was loaded before is kept\n", slot->probFile);
+                fflush(stdout);
+                continue;
+            }
+            pthread_mutex_lock(&server->lock);
+            CachedModel *old = slot->cached;
+            slot->cached = cached;
+            pthread_mutex_unlock(&server->lock);
+            releaseModel(server, old);
+            printf("Reloaded %s\n", slot->probFile);
+            fflush(stdout);
+        }
+    }
+    return NULL;
+}
+
+/*creates the socket of the server, only the user that started the server can connect to it*/
+static int createServerSocket(char *socketPath)
+{
+    struct sockaddr_un address;
+    if (!setSocketAddress(&address, socketPath))
+    {
+        printf("Error: Socket path %s is too long\n", socketPath);
+        exit(EXIT_FAILURE);
+    }
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0)
+    {
+        printf("Error: Unable to create socket %s\n", socketPath);
+        exit(EXIT_FAILURE);
+    }
+
+    mode_t oldMask = umask(0077);
+    int result = bind(fd, (struct sockaddr *)&address, sizeof(address));
+    // a socket file that no server listens on is left from a server that did not stop cleanly
+    if (result != 0 && errno == EADDRINUSE)
+    {
+        int other = connectToServer(socketPath);
+        if (other >= 0)
+        {
+            close(other);
+            printf("Error: A server is already listening on %s\n", socketPath);
+            exit(EXIT_FAILURE);
+        }
+        unlink(socketPath);
+        result = bind(fd, (struct sockaddr *)&address, sizeof(address));
+    }
+    umask(oldMask);
+
+    if (result != 0 || listen(fd, SERVER_QUEUE_SIZE) != 0)
+    {
+        printf("Error: Unable to listen on %s\n", socketPath);
+        exit(EXIT_FAILURE);
+    }
+    return fd;
+}
+
+void runServer(char *socketPath, char **probFiles, int modelCount)
+{
+    Server *server = NULL;
+    if ((server = (Server *)malloc(sizeof(Server))) == NULL ||
+        (server->slots = (ModelSlot *)malloc(modelCount * sizeof(ModelSlot))) == NULL)
+    {
+        printf("System out of memory!");
+        exit(EXIT_FAILURE);
+    }
+
+    // load every model with all its tables before any request is accepted
+    int i;
+    server->slotCount = modelCount;
+    for (i = 0; i < modelCount; i++)
+    {
+        ModelSlot *slot = &server->slots[i];
+        resolvePath(probFiles[i], slot->probFile);
+        if (!readModifiedTime(slot->probFile, &slot->loaded))
+            memset(&slot->loaded, 0, sizeof(struct timespec));
+        slot->pending = slot->loaded;
+        if ((slot->cached = loadCachedModel(probFiles[i])) == NULL)
+            exit(EXIT_FAILURE);
+    }
+    pthread_mutex_init(&server->lock, NULL);
+    pthread_cond_init(&server->notEmpty, NULL);
+    pthread_cond_init(&server->notFull, NULL);
+    server->head = 0;
+    server->count = 0;
+
+    int listenFd = createServerSocket(socketPath);
+
+    // only the main thread gets the signals, so that they interrupt accept
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = SIG_IGN;
+    sigaction(SIGPIPE, &action, NULL);
+    action.sa_handler = handleStop;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+    sigset_t stopSignals;
+    sigset_t oldSignals;
+    sigemptyset(&stopSignals);
+    sigaddset(&stopSignals, SIGINT);
+    sigaddset(&stopSignals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &stopSignals, &oldSignals);
+
+    long threadCount = sysconf(_SC_NPROCESSORS_ONLN);
+    if (threadCount < 1)
+        threadCount = SERVER_DEFAULT_THREADS;
+    pthread_t *workers = NULL;
+    if ((workers = (pthread_t *)malloc(threadCount * sizeof(pthread_t))) == NULL)
+    {
+        printf("System out of memory!");
+        exit(EXIT_FAILURE);
+    }
+    pthread_t reloader;
+    for (i = 0; i < threadCount; i++)
+    {
+        if (pthread_create(&workers[i], NULL, workerThread, server) != 0)
+        {
+            printf("Error: Unable to start worker thread\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    if (pthread_create(&reloader, NULL, reloadThread, server) != 0)
+    {
+        printf("Error: Unable to start reload thread\n");
+        exit(EXIT_FAILURE);
+    }
+    pthread_sigmask(SIG_SETMASK, &oldSignals, NULL);
+
+    printf("Listening on %s with %d models and %ld threads\n", socketPath, modelCount, threadCount);
+    fflush(stdout);
+
+    // hand every connection to a worker, waiting when all of them are busy and the queue is full
+    while (!stopServer)
+    {
+        int fd = accept(listenFd, NULL, NULL);
+        if (fd < 0)
+        {
+            if (errno == EINTR || errno == ECONNABORTED)
+                continue;
+            printf("Error: Unable to accept a connection on %s\n", socketPath);
+            break;
+        }
+
+        pthread_mutex_lock(&server->lock);
+        while (server->count == SERVER_QUEUE_SIZE)
+            pthread_cond_wait(&server->notFull, &server->lock);
+        server->queue[(server->head + server->count) % SERVER_QUEUE_SIZE] = fd;
+        server->count++;
+        pthread_cond_signal(&server->notEmpty);
+        pthread_mutex_unlock(&server->lock);
+    }
+
+    // the workers finish the connections that are already queued
+    close(listenFd);
+    unlink(socketPath);
+    stopServer = 1;
+    pthread_mutex_lock(&server->lock);
+    pthread_cond_broadcast(&server->notEmpty);
+    pthread_mutex_unlock(&server->lock);
+    for (i = 0; i < threadCount; i++)
+        pthread_join(workers[i], NULL);
+    pthread_join(reloader, NULL);
+    printf("Server stopped\n");
+
+    for (i = 0; i < modelCount; i++)
+        releaseModel(server, server->slots[i].cached);
+    pthread_mutex_destroy(&server->lock);
+    pthread_cond_destroy(&server->notEmpty);
+    pthread_cond_destroy(&server->notFull);
+    free(workers);
+    free(server->slots);
+    free(server);
+}
+
+void requestFromServer(char *socketPath, char operation, int backend, const TransformChain *transforms, char *probFile,
+                       char *inputFile, char *outputFile)
+{
+    ServerRequest *request = NULL;
+    if ((request = (ServerRequest *)calloc(1, sizeof(ServerRequest))) == NULL)
+    {
+        printf("System out of memory!");
+        exit(EXIT_FAILURE);
+    }
+
+    request->operation = operation;
+    request->backend = backend;
+    request->transforms = *transforms;
+    resolvePath(probFile, request->model);
+    resolvePath(inputFile, request->inputFile);
+    resolvePath(outputFile, request->outputFile);
+
+    int fd = connectToServer(socketPath);
+    if (fd < 0)
+    {
+        printf("Error: Unable to connect to the server on %s\n", socketPath);
+        exit(EXIT_FAILURE);
+    }
+
+    unsigned char status;
+    if (!writeFully(fd, request, sizeof(ServerRequest)) || !readFully(fd, &status, 1))
+    {
+        printf("Error: The server stopped before the request was done\n");
+        exit(EXIT_FAILURE);
+    }
+
+    if (status == SERVER_UNKNOWN_MODEL)
+    {
+        printf("Error: The server does not have the model %s\n", request->model);
+        exit(EXIT_FAILURE);
+    }
+    if (status == SERVER_BAD_REQUEST)
+    {
+        printf("Error: The server did not accept the request\n");
+        exit(EXIT_FAILURE);
+    }
+    if (status == SERVER_CANNOT_OPEN)
+    {
+        printf("Error: The server is unable to open %s or %s\n", request->inputFile, request->outputFile);
+        exit(EXIT_FAILURE);
+    }
+    if (status == SERVER_FAILED)
+    {
+        printf("Error: The server was unable to %s %s, its error is in the output of the server\n",
+               operation == 'e' ? "encode" : "decode", request->inputFile);
+        exit(EXIT_FAILURE);
+    }
+    close(fd);
+    free(request);
+}
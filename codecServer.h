@@ -0,0 +1,118 @@
+/**
+ * @file codecServer.h
+ * @brief Header file for the encoding and decoding server and its client.
+ *
+ * This file contains declarations for functions for a server that loads its models once and then encodes and
+ * decodes files for the requests it gets on a unix domain socket. Starting the program and reading the probfile
+ * costs much more than coding a small file, so keeping the models and all their tables in memory lets small
+ * requests finish in microseconds. The requests are handled by a pool of worker threads, and a model is loaded
+ * again when its probfile changes.
+ *
+ * A request names the model and the input and output files with their full paths, and the server reads and
+ * writes the files itself with the pipelined I/O engine. The socket can only be used by the user that started
+ * the server.
+ *
+ * The workers code the requests with the loaded models themselves. A coder that finds a damaged file or cannot read
+ * or write a file prints the error in the output of the server and returns it, so only that request fails and the
+ * server keeps running. A probfile that cannot be loaded again, for example because it is being replaced by a file
+ * that is not a model, is reported and the model that was loaded before is kept.
+ *
+ * @author Spyros Sachmpazidis
+ * @bug No know bugs.
+ * @version 1.3
+ * @since 19/10/26
+ */
+
+#ifndef CODEC_SERVER_H
+#define CODEC_SERVER_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include <signal.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "codecModel.h"
+
+/*The number of worker threads when the number of processors is unknown*/
+#define SERVER_DEFAULT_THREADS 4
+/*The number of connections that can wait for a worker*/
+#define SERVER_QUEUE_SIZE 64
+/*The seconds between checks of the probfiles for changes*/
+#define SERVER_RELOAD_INTERVAL 1
+/*The largest path in a request, including the final '\0'*/
+#define SERVER_PATH_SIZE 4096
+
+/*The request was done*/
+#define SERVER_OK 0
+/*The server does not have the model of the request*/
+#define SERVER_UNKNOWN_MODEL 1
+/*The request is not an encode or decode request*/
+#define SERVER_BAD_REQUEST 2
+/*The server is unable to open the input or the output file*/
+#define SERVER_CANNOT_OPEN 3
+/*The coder failed, the error is in the output of the server*/
+#define SERVER_FAILED 4
+
+/**
+ * @struct ServerRequest
+ * @brief Represents a request that a client sends to the server.
+ *
+ * The operation is 'e' to encode or 'd' to decode, and the backend and the transforms are used to encode.
+ * The server answers with 1 byte, SERVER_OK or the reason the request was not done.
+ *
+ * @since 1.0
+ */
+typedef struct
+{
+    char operation;
+    signed char backend;
+    TransformChain transforms;
+    char model[SERVER_PATH_SIZE];
+    char inputFile[SERVER_PATH_SIZE];
+    char outputFile[SERVER_PATH_SIZE];
+} ServerRequest;
+
+/**
+ * @brief Runs the server until it gets SIGINT or SIGTERM.
+ *
+ * This function loads every model with all its tables, creates the socket and starts the worker threads.
+ * The main thread accepts the connections and gives them to the workers, and another thread checks the probfiles
+ * every SERVER_RELOAD_INTERVAL seconds. A probfile that has changed is loaded again once it has stopped changing,
+ * and the requests that are still using the old model finish with it. The program stops if a model cannot be
+ * loaded when the server starts, but not when it is loaded again.
+ *
+ * @param socketPath The path of the unix socket.
+ * @param probFiles The probability or count files of the models.
+ * @param modelCount The number of models.
+ * @since 1.0
+ */
+void runServer(char *socketPath, char **probFiles, int modelCount);
+
+/**
+ * @brief Sends an encode or decode request to a server and waits until it is done.
+ *
+ * The paths are sent in full, so the client and the server do not need to be in the same directory. The program
+ * stops with an error if the request failed.
+ *
+ * @param socketPath The path of the unix socket of the server.
+ * @param operation 'e' to encode or 'd' to decode.
+ * @param backend The coder to encode with, either BACKEND_HUFFMAN or BACKEND_TANS.
+ * @param transforms Pointer to the transforms to encode with.
+ * @param probFile The probfile of the model, it must be one of the models of the server.
+ * @param inputFile The input file.
+ * @param outputFile The output file.
+ * @since 1.0
+ */
+void requestFromServer(char *socketPath, char operation, int backend, const TransformChain *transforms, char *probFile,
+                       char *inputFile, char *outputFile);
+
+#endif
@@ -0,0 +1,106 @@
+#include "crc32c.h"
+
+#ifdef HAVE_CRC32C_INSTRUCTION
+#include <nmmintrin.h>
+#endif
+
+/*The Castagnoli polynomial with its bits reversed*/
+#define CRC32C_POLYNOMIAL 0x82F63B78u
+
+/*The tables of slicing by 8, table k gives the checksum of a byte followed by k zero bytes*/
+static uint32_t tables[8][256];
+static int useInstruction = 0;
+static pthread_once_t tablesOnce = PTHREAD_ONCE_INIT;
+
+#ifdef DEBUG_CRC32C
+int main(int argc, char *argv[])
+{
+    if (argc != 2)
+    {
+        printf("String not given!\n");
+        exit(EXIT_FAILURE);
+    }
+    printf("Debugging crc32c.c:\n");
+    printf("Computing checksums with %s\n", crc32cMethod());
+    // the checksum of "123456789" is e3069283
+    printf("Check:\t%08x\n", crc32c(0, (const unsigned char *)"123456789", 9));
+    size_t length = strlen(argv[1]);
+    printf("Whole:\t%08x\n", crc32c(0, (const unsigned char *)argv[1], length));
+    printf("Parts:\t%08x\n", crc32c(crc32c(0, (const unsigned char *)argv[1], length / 3),
+                                    (const unsigned char *)argv[1] + length / 3, length - length / 3));
+}
+#endif
+
+static void createTables(void)
+{
+    int i, k;
+    for (i = 0; i < 256; i++)
+    {
+        uint32_t crc = i;
+        for (k = 0; k < 8; k++)
+            crc = crc & 1 ? (crc >> 1) ^ CRC32C_POLYNOMIAL : crc >> 1;
+        tables[0][i] = crc;
+    }
+    for (i = 0; i < 256; i++)
+        for (k = 1; k < 8; k++)
+            tables[k][i] = (tables[k - 1][i] >> 8) ^ tables[0][tables[k - 1][i] & 0xFF];
+
+#ifdef HAVE_CRC32C_INSTRUCTION
+    __builtin_cpu_init();
+    useInstruction = __builtin_cpu_supports("sse4.2");
+#endif
+}
+
+static uint32_t crc32cSlicing(uint32_t crc, const unsigned char *data, size_t length)
+{
+    // the first bytes are added 1 at a time until the rest can be read 8 at a time
+    while (length > 0 && ((uintptr_t)data & 7) != 0)
+    {
+        crc = (crc >> 8) ^ tables[0][(crc ^ *data++) & 0xFF];
+        length--;
+    }
+    for (; length >= 8; data += 8, length -= 8)
+    {
+        uint32_t low = crc ^ ((uint32_t)data[0] | (uint32_t)data[1] << 8 | (uint32_t)data[2] << 16 | (uint32_t)data[3] << 24);
+        crc = tables[7][low & 0xFF] ^ tables[6][(low >> 8) & 0xFF] ^ tables[5][(low >> 16) & 0xFF] ^ tables[4][low >> 24] ^
+              tables[3][data[4]] ^ tables[2][data[5]] ^ tables[1][data[6]] ^ tables[0][data[7]];
+    }
+    while (length-- > 0)
+        crc = (crc >> 8) ^ tables[0][(crc ^ *data++) & 0xFF];
+    return crc;
+}
+
+#ifdef HAVE_CRC32C_INSTRUCTION
+__attribute__((target("sse4.2"))) static uint32_t crc32cInstruction(uint32_t crc, const unsigned char *data,
+                                                                     size_t length)
+{
+    uint64_t crc64 = crc;
+    for (; length >= 8; data += 8, length -= 8)
+    {
+        uint64_t word;
+        memcpy(&word, data, sizeof(word));
+        crc64 = _mm_crc32_u64(crc64, word);
+    }
+    crc = crc64;
+    while (length-- > 0)
+        crc = _mm_crc32_u8(crc, *data++);
+    return crc;
+}
+#endif
+
+uint32_t crc32c(uint32_t crc, const unsigned char *data, size_t length)
+{
+    pthread_once(&tablesOnce, createTables);
+    crc = ~crc;
+#ifdef HAVE_CRC32C_INSTRUCTION
+    if (useInstruction)
+        return ~crc32cInstruction(crc, data, length);
+#endif
+    return ~crc32cSlicing(crc, data, length);
+}
+
+const char *crc32cMethod(void)
+{
+    pthread_once(&tablesOnce, createTables);
+    return useInstruction ? "sse4.2" : "slicing-by-8";
+}
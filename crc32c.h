@@ -0,0 +1,52 @@
+/**
+ * @file crc32c.h
+ * @brief Header file for the CRC32C checksums of the binary encoded files.
+ *
+ * This file contains the checksum that protects every block of a binary encoded file, the CRC32C of the Castagnoli
+ * polynomial. On x86-64 it is computed with the crc32 instruction of SSE4.2, 8 bytes at a time, when the processor
+ * has it. The program is not built with -msse4.2, so the instruction is only used by 1 function that is compiled for
+ * SSE4.2 and is chosen when the checksum is first used. Otherwise, or with -DNO_SIMD, it is computed with 8 tables
+ * of 256 numbers, 8 bytes at a time (slicing by 8). Both give the same checksums.
+ *
+ * @author Spyros Sachmpazidis
+ * @bug No know bugs.
+ * @version 1.0
+ * @since 19/10/26
+ */
+
+#ifndef CRC32C_H
+#define CRC32C_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <pthread.h>
+
+#if defined(__x86_64__) && defined(__GNUC__) && !defined(NO_SIMD)
+#define HAVE_CRC32C_INSTRUCTION 1
+#endif
+
+/**
+ * @brief Adds bytes to a CRC32C checksum.
+ *
+ * The checksum of a buffer can be computed in parts, the checksum of the first part is given when the next part is
+ * added.
+ *
+ * @param crc The checksum of the bytes before these, or 0 for the first bytes.
+ * @param data The bytes.
+ * @param length The number of bytes.
+ * @return The checksum of all the bytes so far.
+ * @since 1.0
+ */
+uint32_t crc32c(uint32_t crc, const unsigned char *data, size_t length);
+
+/**
+ * @brief Returns how the checksums are computed on this processor.
+ *
+ * @return "sse4.2" or "slicing-by-8".
+ * @since 1.0
+ */
+const char *crc32cMethod(void);
+
+#endif
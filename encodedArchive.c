@@ -0,0 +1,443 @@
+#include "encodedArchive.h"
+
+/*The state of the threads that extract the members of an archive*/
+typedef struct
+{
+    Archive *archive;
+    char *directory;
+    int next;
+} ArchiveExtractor;
+
+#ifdef DEBUG_ENCODED_ARCHIVE
+int main(int argc, char *argv[])
+{
+    if (argc < 5)
+    {
+        printf("Correct files not given!\n");
+        exit(EXIT_FAILURE);
+    }
+    printf("Debugging encodedArchive.c:\n");
+    printf("Trying to pack %d files into %s with %s...\n", argc - 4, argv[2], argv[1]);
+    CodecModel *model = loadCodecModel(argv[1]);
+    TransformChain transforms;
+    transforms.count = 0;
+    createArchive(argv[2], model, BACKEND_HUFFMAN, &transforms, argv + 4, argc - 4);
+    freeCodecModel(model);
+    listArchive(argv[2]);
+    printf("Trying to extract %s into %s...\n", argv[2], argv[3]);
+    extractArchive(argv[2], argv[3]);
+    printf("Success!\n");
+}
+#endif
+
+/*a name is kept inside the directory it is extracted into if it is relative and never goes up*/
+static int isValidMemberName(const char *name, size_t length)
+{
+    if (length == 0 || length >= ARCHIVE_NAME_SIZE || name[0] == '/' || memchr(name, '\0', length) != NULL)
+        return 0;
+
+    size_t start = 0, i;
+    for (i = 0; i <= length; i++)
+        if (i == length || name[i] == '/')
+        {
+            if (i - start == 2 && name[start] == '.' && name[start + 1] == '.')
+                return 0;
+            start = i + 1;
+        }
+    return name[length - 1] != '/';
+}
+
+static int compareNames(const void *a, const void *b)
+{
+    return strcmp(*(char *const *)a, *(char *const *)b);
+}
+
+/*checks that no 2 members have the same name, they would be extracted into the same file*/
+static void checkDuplicateNames(char **memberFiles, int memberCount)
+{
+    char **names = NULL;
+    if ((names = (char **)malloc(memberCount * sizeof(char *))) == NULL)
+    {
+        printf("System out of memory!");
+        exit(EXIT_FAILURE);
+    }
+    memcpy(names, memberFiles, memberCount * sizeof(char *));
+    qsort(names, memberCount, sizeof(char *), compareNames);
+
+    int i;
+    for (i = 1; i < memberCount; i++)
+        if (strcmp(names[i - 1], names[i]) == 0)
+        {
+            printf("Error: %s is given more than once, every member of an archive needs its own name\n", names[i]);
+            exit(EXIT_FAILURE);
+        }
+    free(names);
+}
+
+/*returns the size of a file, which is the offset where the next part of an archive starts*/
+static unsigned long long fileSize(char *file)
+{
+    struct stat fileStat;
+    if (stat(file, &fileStat) != 0)
+    {
+        printf("Error: Unable to open %s\n", file);
+        exit(EXIT_FAILURE);
+    }
+    return fileStat.st_size;
+}
+
+/*adds the number of characters of every block of a member, only the headers of the blocks are read*/
+static unsigned long long memberLength(char *archiveFile, unsigned long long offset, unsigned long long encodedLength)
+{
+    FILE *fp = NULL;
+    if ((fp = fopen(archiveFile, "rb")) == NULL || fseeko(fp, offset, SEEK_SET) != 0)
+    {
+        printf("Error: Unable to open %s\n", archiveFile);
+        exit(EXIT_FAILURE);
+    }
+
+    unsigned long long length = 0, position = 0;
+    unsigned char header[ENCODED_BLOCK_HEADER_SIZE];
+    while (position < encodedLength)
+    {
+        if (fread(header, 1, ENCODED_BLOCK_HEADER_SIZE, fp) != ENCODED_BLOCK_HEADER_SIZE || fseeko(fp, getUint32(header + 4), SEEK_CUR) != 0)
+        {
+            printf("Error: Unable to read %s\n", archiveFile);
+            exit(EXIT_FAILURE);
+        }
+        length += getUint32(header);
+        position += ENCODED_BLOCK_HEADER_SIZE + getUint32(header + 4);
+    }
+    fclose(fp);
+    return length;
+}
+
+void createArchive(char *archiveFile, CodecModel *model, int backend, const TransformChain *transforms,
+                   char **memberFiles, int memberCount)
+{
+    ArchiveMember *members = NULL;
+    if ((members = (ArchiveMember *)malloc(memberCount * sizeof(ArchiveMember))) == NULL)
+    {
+        printf("System out of memory!");
+        exit(EXIT_FAILURE);
+    }
+    int i;
+    for (i = 0; i < memberCount; i++)
+        if (!isValidMemberName(memberFiles[i], strlen(memberFiles[i])))
+        {
+            printf("Error: %s cannot be a member of an archive, use a relative name without ..\n", memberFiles[i]);
+            exit(EXIT_FAILURE);
+        }
+    checkDuplicateNames(memberFiles, memberCount);
+
+    FILE *fp = NULL;
+    if ((fp = fopen(archiveFile, "wb")) == NULL)
+    {
+        printf("Error: Unable to open %s\n", archiveFile);
+        exit(EXIT_FAILURE);
+    }
+    unsigned char header[ARCHIVE_HEADER_SIZE] = {0};
+    memcpy(header, ARCHIVE_MAGIC, 4);
+    header[4] = ARCHIVE_VERSION;
+    header[5] = ENCODED_FILE_VERSION;
+    fwrite(header, 1, ARCHIVE_HEADER_SIZE, fp);
+    fclose(fp);
+
+    // the blocks of every member are added to the end of the archive, its model is only in the model table
+    EncodedSegment segment;
+    describeSegment(&segment, model, backend, 0);
+    segment.transforms = *transforms;
+    segment.member = 1;
+    for (i = 0; i < memberCount; i++)
+    {
+        members[i].name = memberFiles[i];
+        members[i].offset = fileSize(archiveFile);
+        members[i].model = 0;
+        codecEncodeSegment(model, &segment, memberFiles[i], archiveFile);
+        members[i].encodedLength = fileSize(archiveFile) - members[i].offset;
+        members[i].length = memberLength(archiveFile, members[i].offset, members[i].encodedLength);
+    }
+
+    // the model table and the directory are written and checked together
+    unsigned long long modelOffset = fileSize(archiveFile);
+    size_t tableLength = ENCODED_SEGMENT_SIZE, directoryLength = 0;
+    for (i = 0; i < memberCount; i++)
+        directoryLength += ARCHIVE_ENTRY_SIZE + strlen(members[i].name);
+    unsigned char *table = NULL;
+    if ((table = (unsigned char *)malloc(tableLength + directoryLength + ARCHIVE_TRAILER_SIZE)) == NULL)
+    {
+        printf("System out of memory!");
+        exit(EXIT_FAILURE);
+    }
+    writeSegment(table, &segment);
+    unsigned char *entry = table + tableLength;
+    for (i = 0; i < memberCount; i++)
+    {
+        size_t nameLength = strlen(members[i].name);
+        putUint64(entry, members[i].offset);
+        putUint64(entry + 8, members[i].encodedLength);
+        putUint64(entry + 16, members[i].length);
+        putUint32(entry + 24, members[i].model);
+        putUint32(entry + 28, nameLength);
+        memcpy(entry + ARCHIVE_ENTRY_SIZE, members[i].name, nameLength);
+        entry += ARCHIVE_ENTRY_SIZE + nameLength;
+    }
+    putUint64(entry, modelOffset);
+    putUint64(entry + 8, modelOffset + tableLength);
+    putUint32(entry + 16, 1);
+    putUint32(entry + 20, memberCount);
+    putUint32(entry + 24, crc32c(0, table, tableLength + directoryLength));
+    memcpy(entry + 28, ARCHIVE_MAGIC, 4);
+
+    if ((fp = fopen(archiveFile, "ab")) == NULL ||
+        fwrite(table, 1, tableLength + directoryLength + ARCHIVE_TRAILER_SIZE, fp) !=
+            tableLength + directoryLength + ARCHIVE_TRAILER_SIZE ||
+        fclose(fp) != 0)
+    {
+        printf("Error: Unable to write %s\n", archiveFile);
+        exit(EXIT_FAILURE);
+    }
+    free(table);
+    free(members);
+}
+
+/*stops the program when a part of an archive is not valid*/
+static void invalidArchive(char *archiveFile)
+{
+    printf("Error: %s is not a valid archive\n", archiveFile);
+    exit(EXIT_FAILURE);
+}
+
+Archive *openArchive(char *archiveFile)
+{
+    Archive *archive = NULL;
+    if ((archive = (Archive *)calloc(1, sizeof(Archive))) == NULL)
+    {
+        printf("System out of memory!");
+        exit(EXIT_FAILURE);
+    }
+    archive->file = archiveFile;
+
+    int fd;
+    struct stat archiveStat;
+    if ((fd = open(archiveFile, O_RDONLY)) < 0 || fstat(fd, &archiveStat) != 0)
+    {
+        printf("Error: Unable to open %s\n", archiveFile);
+        exit(EXIT_FAILURE);
+    }
+    if (archiveStat.st_size < ARCHIVE_HEADER_SIZE + ARCHIVE_TRAILER_SIZE)
+        invalidArchive(archiveFile);
+    archive->size = archiveStat.st_size;
+    void *data = mmap(NULL, archive->size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+    {
+        printf("Error: Unable to read %s\n", archiveFile);
+        exit(EXIT_FAILURE);
+    }
+    archive->data = (const unsigned char *)data;
+
+    // the trailer finds the model table and the directory, which must lie between the members and the trailer
+    const unsigned char *trailer = archive->data + archive->size - ARCHIVE_TRAILER_SIZE;
+    if (memcmp(archive->data, ARCHIVE_MAGIC, 4) != 0 || archive->data[4] != ARCHIVE_VERSION ||
+        archive->data[5] != ENCODED_FILE_VERSION || memcmp(trailer + 28, ARCHIVE_MAGIC, 4) != 0)
+        invalidArchive(archiveFile);
+    unsigned long long modelOffset = getUint64(trailer), directoryOffset = getUint64(trailer + 8);
+    unsigned long long directoryEnd = archive->size - ARCHIVE_TRAILER_SIZE;
+    archive->modelCount = getUint32(trailer + 16);
+    archive->memberCount = getUint32(trailer + 20);
+    if (modelOffset < ARCHIVE_HEADER_SIZE || directoryOffset < modelOffset || directoryOffset > directoryEnd ||
+        directoryOffset - modelOffset != (unsigned long long)archive->modelCount * ENCODED_SEGMENT_SIZE ||
+        archive->modelCount < 1 || archive->memberCount < 0 ||
+        (unsigned long long)archive->memberCount > (directoryEnd - directoryOffset) / ARCHIVE_ENTRY_SIZE)
+        invalidArchive(archiveFile);
+    if (crc32c(0, archive->data + modelOffset, directoryEnd - modelOffset) != getUint32(trailer + 24))
+    {
+        printf("Error: The directory of %s is corrupt\n", archiveFile);
+        exit(EXIT_FAILURE);
+    }
+
+    if ((archive->segments = (EncodedSegment *)malloc(archive->modelCount * sizeof(EncodedSegment))) == NULL ||
+        (archive->models = (CodecModel **)calloc(archive->modelCount, sizeof(CodecModel *))) == NULL ||
+        (archive->members = (ArchiveMember *)malloc((archive->memberCount + 1) * sizeof(ArchiveMember))) == NULL)
+    {
+        printf("System out of memory!");
+        exit(EXIT_FAILURE);
+    }
+    int i;
+    for (i = 0; i < archive->modelCount; i++)
+    {
+        initializeSegment(&archive->segments[i], BACKEND_HUFFMAN, 0);
+        readSegment(archive->data + modelOffset + (size_t)i * ENCODED_SEGMENT_SIZE, &archive->segments[i]);
+        if ((archive->segments[i].backend != BACKEND_HUFFMAN && archive->segments[i].backend != BACKEND_TANS) ||
+            archive->segments[i].hasModel != 1)
+            invalidArchive(archiveFile);
+    }
+
+    const unsigned char *entry = archive->data + directoryOffset;
+    for (i = 0; i < archive->memberCount; i++)
+    {
+        ArchiveMember *member = &archive->members[i];
+        if ((unsigned long long)(entry - archive->data) + ARCHIVE_ENTRY_SIZE > directoryEnd)
+            invalidArchive(archiveFile);
+        member->offset = getUint64(entry);
+        member->encodedLength = getUint64(entry + 8);
+        member->length = getUint64(entry + 16);
+        uint32_t model = getUint32(entry + 24), nameLength = getUint32(entry + 28);
+        if (member->offset < ARCHIVE_HEADER_SIZE || member->offset > modelOffset ||
+            member->encodedLength > modelOffset - member->offset || model >= (uint32_t)archive->modelCount ||
+            nameLength > directoryEnd - (entry - archive->data) - ARCHIVE_ENTRY_SIZE ||
+            !isValidMemberName((const char *)entry + ARCHIVE_ENTRY_SIZE, nameLength))
+            invalidArchive(archiveFile);
+        member->model = model;
+        if ((member->name = (char *)malloc(nameLength + 1)) == NULL)
+        {
+            printf("System out of memory!");
+            exit(EXIT_FAILURE);
+        }
+        memcpy(member->name, entry + ARCHIVE_ENTRY_SIZE, nameLength);
+        member->name[nameLength] = '\0';
+        entry += ARCHIVE_ENTRY_SIZE + nameLength;
+    }
+    return archive;
+}
+
+/*creates the model of a member the first time it is needed, with every table so threads can share it*/
+static CodecModel *archiveModel(Archive *archive, int model)
+{
+    if (archive->models[model] == NULL)
+    {
+        archive->models[model] = createSegmentModel(&archive->segments[model]);
+        prepareCodecModel(archive->models[model]);
+    }
+    return archive->models[model];
+}
+
+/*decodes the blocks of a member straight from the mapping of the archive*/
+static void extractMember(Archive *archive, ArchiveMember *member, char *outputFile)
+{
+    codecDecodeMember(archiveModel(archive, member->model), &archive->segments[member->model],
+                      archive->data + member->offset, member->encodedLength, member->name, outputFile);
+}
+
+void listArchive(char *archiveFile)
+{
+    Archive *archive = openArchive(archiveFile);
+    printf("Characters\tEncoded\t\tModel\tName\n");
+    int i;
+    for (i = 0; i < archive->memberCount; i++)
+        printf("%llu\t\t%llu\t\t%d\t%s\n", archive->members[i].length, archive->members[i].encodedLength,
+               archive->members[i].model, archive->members[i].name);
+    closeArchive(archive);
+}
+
+/*creates the directory of a file and every directory above it that does not exist*/
+static void createDirectories(char *path)
+{
+    char *slash;
+    for (slash = strchr(path + 1, '/'); slash != NULL; slash = strchr(slash + 1, '/'))
+    {
+        *slash = '\0';
+        if (mkdir(path, 0755) != 0 && errno != EEXIST)
+        {
+            printf("Error: Unable to create %s\n", path);
+            exit(EXIT_FAILURE);
+        }
+        *slash = '/';
+    }
+}
+
+static void *extractorThread(void *argument)
+{
+    ArchiveExtractor *extractor = (ArchiveExtractor *)argument;
+    Archive *archive = extractor->archive;
+    char *path = NULL;
+    if ((path = (char *)malloc(strlen(extractor->directory) + ARCHIVE_NAME_SIZE + 2)) == NULL)
+    {
+        printf("System out of memory!");
+        exit(EXIT_FAILURE);
+    }
+
+    // every thread takes the next member that nobody has taken
+    int i;
+    while ((i = __atomic_fetch_add(&extractor->next, 1, __ATOMIC_RELAXED)) < archive->memberCount)
+    {
+        sprintf(path, "%s/%s", extractor->directory, archive->members[i].name);
+        createDirectories(path);
+        extractMember(archive, &archive->members[i], path);
+    }
+    free(path);
+    return NULL;
+}
+
+void extractArchive(char *archiveFile, char *directory)
+{
+    Archive *archive = openArchive(archiveFile);
+    if (mkdir(directory, 0755) != 0 && errno != EEXIST)
+    {
+        printf("Error: Unable to create %s\n", directory);
+        exit(EXIT_FAILURE);
+    }
+
+    // the models are created before the threads start, so the threads only read them
+    int i;
+    for (i = 0; i < archive->memberCount; i++)
+        archiveModel(archive, archive->members[i].model);
+
+    long processors = sysconf(_SC_NPROCESSORS_ONLN);
+    int threadCount = processors > 0 ? (int)processors : ARCHIVE_DEFAULT_THREADS;
+    if (threadCount > archive->memberCount)
+        threadCount = archive->memberCount;
+    ArchiveExtractor extractor;
+    extractor.archive = archive;
+    extractor.directory = directory;
+    extractor.next = 0;
+    pthread_t *threads = NULL;
+    if ((threads = (pthread_t *)malloc((threadCount + 1) * sizeof(pthread_t))) == NULL)
+    {
+        printf("System out of memory!");
+        exit(EXIT_FAILURE);
+    }
+    for (i = 0; i < threadCount; i++)
+        if (pthread_create(&threads[i], NULL, extractorThread, &extractor) != 0)
+        {
+            printf("Error: Unable to start archive threads\n");
+            exit(EXIT_FAILURE);
+        }
+    for (i = 0; i < threadCount; i++)
+        pthread_join(threads[i], NULL);
+
+    free(threads);
+    closeArchive(archive);
+}
+
+void extractArchiveMember(char *archiveFile, char *memberName, char *outputFile)
+{
+    Archive *archive = openArchive(archiveFile);
+    int i;
+    for (i = 0; i < archive->memberCount; i++)
+        if (strcmp(archive->members[i].name, memberName) == 0)
+            break;
+    if (i == archive->memberCount)
+    {
+        printf("Error: %s has no member %s\n", archiveFile, memberName);
+        exit(EXIT_FAILURE);
+    }
+    extractMember(archive, &archive->members[i], outputFile);
+    closeArchive(archive);
+}
+
+void closeArchive(Archive *archive)
+{
+    int i;
+    for (i = 0; i < archive->modelCount; i++)
+        if (archive->models[i] != NULL)
+            freeCodecModel(archive->models[i]);
+    for (i = 0; i < archive->memberCount; i++)
+        free(archive->members[i].name);
+    munmap((void *)archive->data, archive->size);
+    free(archive->segments);
+    free(archive->models);
+    free(archive->members);
+    free(archive);
+}
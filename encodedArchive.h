@@ -0,0 +1,172 @@
+/**
+ * @file encodedArchive.h
+ * @brief Header file for archives of many encoded files.
+ *
+ * This file contains declarations for functions for packing many files into 1 archive and extracting them again.
+ * Encoding every file into its own encoded file costs an inode and an open for every file, and records the same
+ * model in every one of them. An archive keeps every member as the blocks of an encoded file, with their checksums
+ * but without a file header or a segment block, followed by a model table with the segment of every model and a
+ * central directory with the name, the offset and the lengths of every member. A trailer at the end of the archive
+ * finds the model table and the directory, so a member is found without reading the other members.
+ *
+ * The archive is mapped into memory when it is read, so only the pages of the members that are extracted are read
+ * from the disk. Every member is extracted by its own thread from a pool with 1 thread per processor, which
+ * decodes it straight from the mapping.
+ *
+ * The archive has the following layout, every number is little endian:\n
+ * header: ARCHIVE_MAGIC, the version, the version of the encoded file format of the members and 2 zero bytes\n
+ * members: the blocks of every member, 1 after the other\n
+ * model table: the ENCODED_SEGMENT_SIZE payload of the segment block of every model\n
+ * directory: for every member its offset, encoded length and length as 64 bit numbers, its model and the length of
+ * its name as 32 bit numbers and then its name\n
+ * trailer: the offsets of the model table and the directory as 64 bit numbers, the number of models and members,
+ * the CRC32C of the model table and the directory and ARCHIVE_MAGIC
+ *
+ * @author Spyros Sachmpazidis
+ * @bug No know bugs.
+ * @version 1.2
+ * @since 19/10/26
+ */
+
+#ifndef ENCODED_ARCHIVE_H
+#define ENCODED_ARCHIVE_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include "codecModel.h"
+#include "encodedFile.h"
+#include "crc32c.h"
+
+/*The first and the last bytes of every archive*/
+#define ARCHIVE_MAGIC "HUFZ"
+/*The version of the archive format*/
+#define ARCHIVE_VERSION 1
+/*The size of the header of an archive*/
+#define ARCHIVE_HEADER_SIZE 8
+/*The size of the trailer at the end of an archive*/
+#define ARCHIVE_TRAILER_SIZE 32
+/*The size of an entry of the directory before the name of the member*/
+#define ARCHIVE_ENTRY_SIZE 32
+/*The longest name of a member*/
+#define ARCHIVE_NAME_SIZE 4096
+/*The number of threads that extract members when the number of processors is unknown*/
+#define ARCHIVE_DEFAULT_THREADS 4
+
+/**
+ * @struct ArchiveMember
+ * @brief Represents an entry of the directory of an archive.
+ *
+ * The structure contains the name of the member, the offset of its blocks in the archive, the number of bytes of
+ * its blocks, the number of characters they decode to and the number of its model in the model table.
+ *
+ * @since 1.0
+ */
+typedef struct
+{
+    char *name;
+    unsigned long long offset;
+    unsigned long long encodedLength;
+    unsigned long long length;
+    int model;
+} ArchiveMember;
+
+/**
+ * @struct Archive
+ * @brief Represents an archive that is open for reading.
+ *
+ * The structure contains the memory mapping of the archive, its model table, where a model is only created the
+ * first time a member needs it, and its directory.
+ *
+ * @since 1.0
+ */
+typedef struct
+{
+    char *file;
+    const unsigned char *data;
+    size_t size;
+    int modelCount;
+    EncodedSegment *segments;
+    CodecModel **models;
+    int memberCount;
+    ArchiveMember *members;
+} Archive;
+
+/**
+ * @brief Packs files into a new archive.
+ *
+ * Every file is encoded with the same model, coder and transforms, and the model is recorded once in the model table.
+ * The names of the members are the names of the files, which must be relative and must not go up with "..", so the
+ * members are always extracted inside the directory they are extracted into. No 2 members can have the same name.
+ *
+ * @param archiveFile The archive.
+ * @param model Pointer to the model of the members.
+ * @param backend The coder to use, either BACKEND_HUFFMAN or BACKEND_TANS.
+ * @param transforms Pointer to the chain of transforms, it can have no transforms.
+ * @param memberFiles The files that are packed.
+ * @param memberCount The number of files.
+ * @since 1.0
+ */
+void createArchive(char *archiveFile, CodecModel *model, int backend, const TransformChain *transforms,
+                   char **memberFiles, int memberCount);
+
+/**
+ * @brief Opens an archive for reading.
+ *
+ * Only the trailer, the model table and the directory are read. The program stops if the archive is not valid or
+ * its model table or directory does not match its checksum.
+ *
+ * @param archiveFile The archive.
+ * @return A pointer to the open archive.
+ * @since 1.0
+ */
+Archive *openArchive(char *archiveFile);
+
+/**
+ * @brief Prints the directory of an archive.
+ *
+ * @param archiveFile The archive.
+ * @since 1.0
+ */
+void listArchive(char *archiveFile);
+
+/**
+ * @brief Extracts every member of an archive into a directory, many members at a time.
+ *
+ * The directory and the directories in the names of the members are created if they do not exist.
+ *
+ * @param archiveFile The archive.
+ * @param directory The directory that the members are written to.
+ * @since 1.0
+ */
+void extractArchive(char *archiveFile, char *directory);
+
+/**
+ * @brief Extracts 1 member of an archive into a file.
+ *
+ * Only the directory and the blocks of the member are read. The program stops if the archive has no such member.
+ *
+ * @param archiveFile The archive.
+ * @param memberName The name of the member.
+ * @param outputFile The decoded file.
+ * @since 1.0
+ */
+void extractArchiveMember(char *archiveFile, char *memberName, char *outputFile);
+
+/**
+ * @brief Closes an archive and frees its models and its directory.
+ *
+ * @param archive Pointer to the archive.
+ * @since 1.0
+ */
+void closeArchive(Archive *archive);
+
+#endif
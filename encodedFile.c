@@ -0,0 +1,802 @@
+#include "encodedFile.h"
+
+/*The state of encodeBlocks between the blocks of the pipeline*/
+typedef struct
+{
+    const EncodedSegment *segment;
+    BlockEncoder encoder;
+    const void *state;
+    int headerWritten;
+    unsigned long long offset;
+    unsigned long long position;
+    unsigned long long segmentPosition;
+    unsigned long long blockPosition;
+    unsigned char *block;
+    TransformBuffers *buffers;
+} BlockWriter;
+
+/*The state of decodeBlocks between the blocks of the pipeline*/
+typedef struct
+{
+    EncodedSegment segment;
+    BlockDecoder decoder;
+    void *state;
+    char *inputFile;
+    int writeOutput;
+    size_t maxPayload;
+    int headerRead;
+    int resync;
+    size_t windowLength;
+    unsigned char window[ENCODED_BLOCK_HEADER_SIZE];
+    unsigned long long segmentOffset;
+    int segmentKnown;
+    int inPayload;
+    size_t length;
+    size_t need;
+    size_t have;
+    uint32_t headerCrc;
+    uint32_t dataCrc;
+    uint32_t payloadCrc;
+    unsigned long long blocks;
+    unsigned long long offset;
+    unsigned long long corrupt;
+    unsigned long long lost;
+    unsigned char *zeros;
+    unsigned char *buffer;
+} BlockReader;
+
+void putUint32(unsigned char *bytes, uint32_t value)
+{
+    bytes[0] = value & 0xFF;
+    bytes[1] = (value >> 8) & 0xFF;
+    bytes[2] = (value >> 16) & 0xFF;
+    bytes[3] = (value >> 24) & 0xFF;
+}
+
+uint32_t getUint32(const unsigned char *bytes)
+{
+    return (uint32_t)bytes[0] | (uint32_t)bytes[1] << 8 | (uint32_t)bytes[2] << 16 | (uint32_t)bytes[3] << 24;
+}
+
+void putUint64(unsigned char *bytes, uint64_t value)
+{
+    putUint32(bytes, value & 0xFFFFFFFF);
+    putUint32(bytes + 4, value >> 32);
+}
+
+uint64_t getUint64(const unsigned char *bytes)
+{
+    return (uint64_t)getUint32(bytes) | (uint64_t)getUint32(bytes + 4) << 32;
+}
+
+void initializeSegment(EncodedSegment *segment, int backend, unsigned long long inputOffset)
+{
+    segment->backend = backend;
+    segment->hasModel = 0;
+    segment->exact = 0;
+    segment->inputOffset = inputOffset;
+    segment->number = 0;
+    segment->member = 0;
+    segment->transforms.count = 0;
+    memset(segment->weights, 0, sizeof(segment->weights));
+}
+
+void writeSegment(unsigned char *payload, const EncodedSegment *segment)
+{
+    memset(payload, 0, ENCODED_SEGMENT_SIZE);
+    payload[0] = segment->backend;
+    payload[1] = segment->hasModel;
+    payload[2] = segment->exact;
+    payload[3] = segment->transforms.count;
+    int i;
+    for (i = 0; i < segment->transforms.count; i++)
+        payload[4 + i] = segment->transforms.stages[i];
+    putUint64(payload + 8, segment->inputOffset);
+
+    for (i = 0; i < ASCII_SIZE; i++)
+    {
+        uint64_t value = (uint64_t)segment->weights[i];
+        if (!segment->exact)
+        {
+            float probability = segment->weights[i];
+            uint32_t bits;
+            memcpy(&bits, &probability, sizeof(bits));
+            value = bits;
+        }
+        putUint64(payload + 16 + 8 * i, value);
+    }
+}
+
+int readSegment(const unsigned char *payload, EncodedSegment *segment)
+{
+    segment->backend = payload[0];
+    segment->hasModel = payload[1];
+    segment->exact = payload[2];
+    segment->inputOffset = getUint64(payload + 8);
+    segment->number++;
+
+    int i;
+    segment->transforms.count = payload[3];
+    for (i = 0; i < segment->transforms.count && i < TRANSFORM_MAX_STAGES; i++)
+        segment->transforms.stages[i] = payload[4 + i];
+    if (!isValidTransformChain(&segment->transforms))
+    {
+        printf("Error: Invalid segment in encoded file\n");
+        return 0;
+    }
+
+    for (i = 0; i < ASCII_SIZE; i++)
+    {
+        uint64_t value = getUint64(payload + 16 + 8 * i);
+        if (segment->exact)
+            segment->weights[i] = value;
+        else
+        {
+            uint32_t bits = value;
+            float probability;
+            memcpy(&probability, &bits, sizeof(probability));
+            segment->weights[i] = probability;
+        }
+    }
+    return 1;
+}
+
+/*reads the header of a file, returns 0 if the file does not start with the ENCODED_FILE_MAGIC bytes and -1 if it
+ cannot be opened*/
+static int readFileHeader(char *inputFile, unsigned char *header)
+{
+    FILE *fp = NULL;
+    // check if file can be opened
+    if ((fp = fopen(inputFile, "rb")) == NULL)
+    {
+        printf("Error: Unable to open %s\n", inputFile);
+        return -1;
+    }
+
+    int found = fread(header, 1, ENCODED_HEADER_SIZE, fp) == ENCODED_HEADER_SIZE &&
+                memcmp(header, ENCODED_FILE_MAGIC, 4) == 0;
+    fclose(fp);
+    return found;
+}
+
+int readEncodedBackend(char *inputFile)
+{
+    unsigned char header[ENCODED_HEADER_SIZE];
+    int found = readFileHeader(inputFile, header);
+    return found < 0 ? BACKEND_UNREADABLE : found ? header[5] : BACKEND_LEGACY;
+}
+
+/*fills the lengths and the checksums of the block whose payload follows its header and returns the size of the block*/
+static size_t fillBlock(BlockWriter *writer, uint32_t length, size_t payloadLength, uint32_t dataCrc)
+{
+    putUint32(writer->block, length);
+    putUint32(writer->block + 4, payloadLength);
+    // the checksum of the payload also covers the rest of the header, so a block with a corrupt length is found
+    putUint32(writer->block + 8, dataCrc);
+    putUint32(writer->block + 12, crc32c(crc32c(0, writer->block, 12), writer->block + ENCODED_BLOCK_HEADER_SIZE,
+                                         payloadLength));
+    // the decoder finds the next block after a corrupt header by the sync word and the checksum of the header
+    putUint32(writer->block + 16, ENCODED_SYNC_WORD);
+    putUint64(writer->block + 20, writer->segment->inputOffset);
+    putUint64(writer->block + 28, writer->offset);
+    putUint32(writer->block + 36, crc32c(0, writer->block, 36));
+    // the tail block records where the last segment block and the last block are
+    if (length == ENCODED_SEGMENT_MARKER)
+        writer->segmentPosition = writer->position;
+    else if (length != ENCODED_TAIL_MARKER)
+    {
+        writer->blockPosition = writer->position;
+        writer->offset += length;
+    }
+    writer->position += ENCODED_BLOCK_HEADER_SIZE + payloadLength;
+    return ENCODED_BLOCK_HEADER_SIZE + payloadLength;
+}
+
+static void writeBlock(BlockWriter *writer, uint32_t length, size_t payloadLength, uint32_t dataCrc, Pipeline *pipe)
+{
+    writeToPipeline(pipe, writer->block, fillBlock(writer, length, payloadLength, dataCrc));
+}
+
+static void fillFileHeader(BlockWriter *writer, unsigned char *header)
+{
+    memset(header, 0, ENCODED_HEADER_SIZE);
+    memcpy(header, ENCODED_FILE_MAGIC, 4);
+    header[4] = ENCODED_FILE_VERSION;
+    header[5] = writer->segment->backend;
+    writer->position += ENCODED_HEADER_SIZE;
+}
+
+static void encodeBlock(void *state, const unsigned char *data, size_t length, Pipeline *pipe)
+{
+    BlockWriter *writer = (BlockWriter *)state;
+    // the segment of a member is kept in the model table of its archive
+    if (!writer->headerWritten && !writer->segment->member)
+    {
+        // a segment that is added to an existing file does not repeat the file header
+        if (writer->segment->inputOffset == 0)
+        {
+            unsigned char header[ENCODED_HEADER_SIZE];
+            fillFileHeader(writer, header);
+            writeToPipeline(pipe, header, ENCODED_HEADER_SIZE);
+        }
+        writeSegment(writer->block + ENCODED_BLOCK_HEADER_SIZE, writer->segment);
+        writeBlock(writer, ENCODED_SEGMENT_MARKER, ENCODED_SEGMENT_SIZE, 0, pipe);
+        writer->headerWritten = 1;
+    }
+
+    unsigned char *payload = writer->block + ENCODED_BLOCK_HEADER_SIZE;
+    size_t payloadLength;
+    const TransformChain *chain = &writer->segment->transforms;
+    if (chain->count > 0)
+    {
+        uint32_t parameters[TRANSFORM_MAX_STAGES];
+        size_t transformedLength;
+        const unsigned char *transformed = applyTransforms(writer->buffers, chain, data, length, parameters, &transformedLength);
+        size_t headerLength = ENCODED_TRANSFORM_HEADER_SIZE(chain->count);
+        putUint32(payload, transformedLength);
+        int i;
+        for (i = 0; i < chain->count; i++)
+            putUint32(payload + 4 + 4 * i, parameters[i]);
+        payloadLength = headerLength + writer->encoder(writer->state, transformed, transformedLength, payload + headerLength);
+    }
+    else
+        payloadLength = writer->encoder(writer->state, data, length, payload);
+    TRACE_PROBE3(encode_block, length, payloadLength, writer->segment->backend);
+    countTraceBlock(length, 8 * (uint64_t)payloadLength);
+    writeBlock(writer, length, payloadLength, crc32c(0, data, length), pipe);
+}
+
+/*allocates the block and the transform buffers of a writer*/
+static void initializeBlockWriter(BlockWriter *writer, const EncodedSegment *segment, BlockEncoder encoder,
+                                  size_t maxPayload, const void *state)
+{
+    writer->segment = segment;
+    writer->encoder = encoder;
+    writer->state = state;
+    writer->headerWritten = 0;
+    writer->offset = segment->inputOffset;
+    writer->position = 0;
+    writer->segmentPosition = 0;
+    writer->blockPosition = 0;
+    writer->buffers = NULL;
+    maxPayload += ENCODED_TRANSFORM_HEADER_SIZE(TRANSFORM_MAX_STAGES);
+    if (maxPayload < ENCODED_SEGMENT_SIZE)
+        maxPayload = ENCODED_SEGMENT_SIZE;
+    if ((writer->block = (unsigned char *)malloc(ENCODED_BLOCK_HEADER_SIZE + maxPayload)) == NULL)
+    {
+        printf("System out of memory!");
+        exit(EXIT_FAILURE);
+    }
+    if (segment->transforms.count > 0)
+        writer->buffers = createTransformBuffers();
+}
+
+/*adds what follows the blocks to the end of the output file, the file header and the segment block if the input was
+ empty, and the tail block*/
+static int finishBlockWriter(BlockWriter *writer, char *outputFile)
+{
+    int empty = !writer->headerWritten && !writer->segment->member && writer->segment->inputOffset == 0;
+    int tail = !writer->segment->member && (writer->headerWritten || empty);
+    if (outputFile == NULL || (!empty && !tail))
+        return 1;
+
+    FILE *fp = NULL;
+    if ((fp = fopen(outputFile, "ab")) == NULL)
+    {
+        printf("Error: Unable to open %s\n", outputFile);
+        return 0;
+    }
+    if (empty)
+    {
+        unsigned char header[ENCODED_HEADER_SIZE];
+        fillFileHeader(writer, header);
+        fwrite(header, 1, ENCODED_HEADER_SIZE, fp);
+        writeSegment(writer->block + ENCODED_BLOCK_HEADER_SIZE, writer->segment);
+        fwrite(writer->block, 1, fillBlock(writer, ENCODED_SEGMENT_MARKER, ENCODED_SEGMENT_SIZE, 0), fp);
+    }
+    if (tail)
+    {
+        unsigned char *payload = writer->block + ENCODED_BLOCK_HEADER_SIZE;
+        putUint64(payload, writer->segmentPosition);
+        putUint64(payload + 8, writer->blockPosition);
+        putUint64(payload + 16, writer->offset);
+        fwrite(writer->block, 1, fillBlock(writer, ENCODED_TAIL_MARKER, ENCODED_TAIL_SIZE, 0), fp);
+    }
+    if (fclose(fp) != 0)
+    {
+        printf("Error: Unable to write %s\n", outputFile);
+        return 0;
+    }
+    return 1;
+}
+
+static void freeBlockWriter(BlockWriter *writer)
+{
+    free(writer->block);
+    if (writer->buffers != NULL)
+        freeTransformBuffers(writer->buffers);
+}
+
+void encodeBlocks(char *inputFile, char *outputFile, const EncodedSegment *segment, BlockEncoder encoder, size_t maxPayload,
+                  const void *state)
+{
+    if (!tryEncodeBlocks(inputFile, outputFile, segment, encoder, maxPayload, state))
+        exit(EXIT_FAILURE);
+}
+
+int tryEncodeBlocks(char *inputFile, char *outputFile, const EncodedSegment *segment, BlockEncoder encoder,
+                    size_t maxPayload, const void *state)
+{
+    // a segment that is added to an existing file is written after its blocks
+    BlockWriter writer;
+    int append = segment->inputOffset > 0 && !segment->member;
+    initializeBlockWriter(&writer, segment, encoder, maxPayload, state);
+    struct stat outputStat;
+    if (append && stat(outputFile, &outputStat) == 0)
+        writer.position = outputStat.st_size;
+    TRACE_PROBE2(encode_start, segment->backend, segment->inputOffset);
+    int done = tryRunPipelineFrom(inputFile, segment->inputOffset, outputFile,
+                                  segment->inputOffset > 0 || segment->member, encodeBlock, &writer) &&
+               finishBlockWriter(&writer, outputFile);
+    TRACE_PROBE0(encode_done);
+    freeBlockWriter(&writer);
+    return done;
+}
+
+void encodeMemoryBlocks(const unsigned char *data, size_t length, int stream, char *outputFile,
+                        const EncodedSegment *segment, BlockEncoder encoder, size_t maxPayload, const void *state)
+{
+    BlockWriter writer;
+    initializeBlockWriter(&writer, segment, encoder, maxPayload, state);
+    TRACE_PROBE2(encode_start, segment->backend, segment->inputOffset);
+    runPipelineOnMemory(data, length, stream, outputFile, encodeBlock, &writer);
+    if (!finishBlockWriter(&writer, outputFile))
+        exit(EXIT_FAILURE);
+    TRACE_PROBE0(encode_done);
+    freeBlockWriter(&writer);
+}
+
+/*returns the next item of the file when all of its bytes have been read, copying them only if they are split between blocks*/
+static const unsigned char *collectBytes(BlockReader *reader, const unsigned char **data, size_t *length)
+{
+    if (reader->have == 0 && *length >= reader->need)
+    {
+        const unsigned char *item = *data;
+        *data += reader->need;
+        *length -= reader->need;
+        return item;
+    }
+
+    size_t n = reader->need - reader->have;
+    if (n > *length)
+        n = *length;
+    memcpy(reader->buffer + reader->have, *data, n);
+    reader->have += n;
+    *data += n;
+    *length -= n;
+    if (reader->have < reader->need)
+        return NULL;
+    reader->have = 0;
+    return reader->buffer;
+}
+
+/*writes the characters of blocks that cannot be decoded as zeros*/
+static void writeZeros(BlockReader *reader, unsigned long long count, Pipeline *pipe)
+{
+    if (reader->zeros == NULL && (reader->zeros = (unsigned char *)calloc(PIPELINE_BLOCK_SIZE, 1)) == NULL)
+    {
+        printf("System out of memory!");
+        exit(EXIT_FAILURE);
+    }
+    while (count > 0)
+    {
+        size_t n = count < PIPELINE_BLOCK_SIZE ? count : PIPELINE_BLOCK_SIZE;
+        writeToPipeline(pipe, reader->zeros, n);
+        count -= n;
+    }
+}
+
+/*returns 1 for the blocks that encode characters, 0 for the segment blocks and the tail block*/
+static int isDataBlock(uint32_t length)
+{
+    return length != ENCODED_SEGMENT_MARKER && length != ENCODED_TAIL_MARKER;
+}
+
+/*reports a block whose payload does not match its checksum, the blocks of a packed file depend on the blocks before*/
+static void reportCorruptBlock(BlockReader *reader, Pipeline *pipe)
+{
+    TRACE_PROBE2(corrupt_block, reader->blocks, reader->offset);
+    // the tail block is only an index for -t, the characters do not depend on it
+    if (reader->length == ENCODED_TAIL_MARKER)
+    {
+        reader->corrupt++;
+        printf("Error: The tail block of %s is corrupt, every character is still decoded\n", reader->inputFile);
+        return;
+    }
+    // the blocks of a corrupt segment are found by their segment offset and counted as corrupt
+    if (reader->length == ENCODED_SEGMENT_MARKER)
+    {
+        reader->segmentKnown = 0;
+        printf("Error: Segment %d of %s is corrupt, the characters of its blocks are %s\n", reader->segment.number + 1,
+               reader->inputFile, reader->writeOutput ? "written as zeros" : "skipped");
+        return;
+    }
+    if (reader->segment.backend == BACKEND_PACKED_LEGACY)
+    {
+        printf("Error: Block %llu of %s is corrupt, the blocks after it cannot be decoded\n", reader->blocks,
+               reader->inputFile);
+        failPipeline(pipe);
+        return;
+    }
+
+    reader->corrupt++;
+    if (reader->length == 0)
+    {
+        printf("Error: Block %llu of %s is corrupt\n", reader->blocks, reader->inputFile);
+        return;
+    }
+    printf("Error: Block %llu of %s is corrupt, its characters %llu to %llu are %s\n", reader->blocks, reader->inputFile,
+           reader->offset, reader->offset + reader->length - 1, reader->writeOutput ? "written as zeros" : "skipped");
+    if (reader->writeOutput)
+        writeZeros(reader, reader->length, pipe);
+}
+
+/*checks the lengths, the sync word and the checksum of a block header, and that it does not go back in the decoded
+ file*/
+static int isBlockHeader(BlockReader *reader, const unsigned char *item)
+{
+    uint32_t length = getUint32(item), payloadLength = getUint32(item + 4);
+    if (length == ENCODED_SEGMENT_MARKER  ? payloadLength != ENCODED_SEGMENT_SIZE
+        : length == ENCODED_TAIL_MARKER ? payloadLength != ENCODED_TAIL_SIZE
+                                        : length > PIPELINE_BLOCK_SIZE || payloadLength > reader->maxPayload)
+        return 0;
+    return getUint32(item + 16) == ENCODED_SYNC_WORD && crc32c(0, item, 36) == getUint32(item + 36) &&
+           getUint64(item + 28) >= reader->offset;
+}
+
+/*slides over the file 1 byte at a time until the last bytes are a valid block header, which is returned*/
+static const unsigned char *findBlockHeader(BlockReader *reader, const unsigned char **data, size_t *length)
+{
+    while (*length > 0)
+    {
+        reader->window[reader->windowLength++] = **data;
+        (*data)++;
+        (*length)--;
+        if (reader->windowLength < ENCODED_BLOCK_HEADER_SIZE)
+            continue;
+        if (isBlockHeader(reader, reader->window))
+        {
+            reader->resync = 0;
+            reader->windowLength = 0;
+            return reader->window;
+        }
+        memmove(reader->window, reader->window + 1, --reader->windowLength);
+    }
+    return NULL;
+}
+
+/*writes the characters of the blocks that were skipped to find the next block as zeros*/
+static void reportLostCharacters(BlockReader *reader, unsigned long long offset, Pipeline *pipe)
+{
+    if (reader->segment.backend == BACKEND_PACKED_LEGACY)
+    {
+        printf("Error: Blocks of %s are corrupt, the blocks after them cannot be decoded\n", reader->inputFile);
+        failPipeline(pipe);
+        return;
+    }
+    reader->lost += offset - reader->offset;
+    printf("Error: The characters %llu to %llu of %s are in corrupt blocks, they are %s\n", reader->offset, offset - 1,
+           reader->inputFile, reader->writeOutput ? "written as zeros" : "skipped");
+    if (reader->writeOutput)
+        writeZeros(reader, offset - reader->offset, pipe);
+    reader->offset = offset;
+}
+
+static void decodeBlock(void *state, const unsigned char *data, size_t length, Pipeline *pipe)
+{
+    BlockReader *reader = (BlockReader *)state;
+    const unsigned char *item;
+    // a block that cannot be decoded stops the pipeline, the blocks after it are not read
+    while (!hasPipelineFailed(pipe) && (item = reader->resync ? findBlockHeader(reader, &data, &length)
+                                                               : collectBytes(reader, &data, &length)) != NULL)
+    {
+        if (!reader->headerRead)
+        {
+            // check the header of the file, every file starts with a segment block
+            if (memcmp(item, ENCODED_FILE_MAGIC, 4) != 0 || item[4] != ENCODED_FILE_VERSION)
+            {
+                printf("Error: Invalid encoded file header\n");
+                failPipeline(pipe);
+                return;
+            }
+            initializeSegment(&reader->segment, item[5], 0);
+            reader->headerRead = 1;
+            reader->need = ENCODED_BLOCK_HEADER_SIZE;
+        }
+        else if (!reader->inPayload)
+        {
+            if (!isBlockHeader(reader, item))
+            {
+                // the next block may start at any of the bytes after the start of this header
+                printf("Error: Block %llu of %s is corrupt, the next block is searched for\n", reader->blocks + 1,
+                       reader->inputFile);
+                reader->resync = 1;
+                reader->windowLength = ENCODED_BLOCK_HEADER_SIZE - 1;
+                memmove(reader->window, item + 1, reader->windowLength);
+                continue;
+            }
+            reader->length = getUint32(item);
+            reader->need = getUint32(item + 4);
+            // the header may be overwritten by the payload, so its checksums are kept
+            reader->headerCrc = crc32c(0, item, 12);
+            reader->dataCrc = getUint32(item + 8);
+            reader->payloadCrc = getUint32(item + 12);
+            reader->segmentOffset = getUint64(item + 20);
+            if (getUint64(item + 28) > reader->offset)
+                reportLostCharacters(reader, getUint64(item + 28), pipe);
+            if (isDataBlock(reader->length))
+                reader->blocks++;
+            reader->inPayload = 1;
+        }
+        else
+        {
+            // a block whose segment block was skipped or is corrupt cannot be decoded without its model
+            if (crc32c(reader->headerCrc, item, reader->need) != reader->payloadCrc ||
+                (isDataBlock(reader->length) &&
+                 (!reader->segmentKnown || reader->segmentOffset != reader->segment.inputOffset)))
+                reportCorruptBlock(reader, pipe);
+            else if (reader->length == ENCODED_SEGMENT_MARKER)
+            {
+                if (!readSegment(item, &reader->segment))
+                {
+                    failPipeline(pipe);
+                    return;
+                }
+                reader->segmentKnown = 1;
+            }
+            else if (isDataBlock(reader->length))
+            {
+                TRACE_PROBE3(decode_block, reader->length, reader->need, reader->segment.backend);
+                countTraceBlock(reader->length, 8 * (uint64_t)reader->need);
+                const unsigned char *decoded = reader->decoder(reader->state, &reader->segment, item, reader->need,
+                                                               reader->length, pipe);
+                if (decoded != NULL && crc32c(0, decoded, reader->length) != reader->dataCrc)
+                {
+                    printf("Error: Block %llu of %s does not match its checksum after it was decoded, "
+                           "the probfile is not the one it was encoded with\n",
+                           reader->blocks, reader->inputFile);
+                    failPipeline(pipe);
+                    return;
+                }
+                if (decoded != NULL && reader->writeOutput)
+                    writeToPipeline(pipe, decoded, reader->length);
+            }
+            if (isDataBlock(reader->length))
+                reader->offset += reader->length;
+            reader->inPayload = 0;
+            reader->need = ENCODED_BLOCK_HEADER_SIZE;
+        }
+    }
+}
+
+/*allocates the buffer of a reader, which expects the file header first*/
+static void initializeBlockReader(BlockReader *reader, char *inputFile, char *outputFile, BlockDecoder decoder,
+                                  size_t maxPayload, void *state)
+{
+    reader->decoder = decoder;
+    reader->state = state;
+    reader->inputFile = inputFile;
+    reader->writeOutput = outputFile != NULL;
+    maxPayload += ENCODED_TRANSFORM_HEADER_SIZE(TRANSFORM_MAX_STAGES);
+    reader->maxPayload = maxPayload;
+    reader->headerRead = 0;
+    reader->resync = 0;
+    reader->windowLength = 0;
+    reader->segmentOffset = 0;
+    reader->segmentKnown = 0;
+    reader->inPayload = 0;
+    reader->need = ENCODED_HEADER_SIZE;
+    reader->have = 0;
+    reader->blocks = 0;
+    reader->offset = 0;
+    reader->corrupt = 0;
+    reader->lost = 0;
+    reader->zeros = NULL;
+    if (maxPayload < ENCODED_SEGMENT_SIZE)
+        maxPayload = ENCODED_SEGMENT_SIZE;
+    if ((reader->buffer = (unsigned char *)malloc(ENCODED_HEADER_SIZE + ENCODED_BLOCK_HEADER_SIZE + maxPayload)) ==
+        NULL)
+    {
+        printf("System out of memory!");
+        exit(EXIT_FAILURE);
+    }
+}
+
+/*frees the buffers of a reader and checks that the blocks ended where the file ended, which is skipped if the
+ decoding already failed*/
+static int finishBlockReader(BlockReader *reader, int decoded)
+{
+    free(reader->buffer);
+    free(reader->zeros);
+    if (!decoded)
+        return 0;
+    if (reader->resync)
+    {
+        printf("Error: No block of %s was found after the corrupt block, the characters after %llu are lost\n",
+               reader->inputFile, reader->offset);
+        return 0;
+    }
+    if (reader->have > 0 || reader->inPayload || (reader->headerRead && reader->need != ENCODED_BLOCK_HEADER_SIZE))
+    {
+        printf("Error: Encoded file %s is truncated\n", reader->inputFile);
+        return 0;
+    }
+    if (reader->corrupt > 0 || reader->lost > 0)
+    {
+        printf("Error: %llu of the %llu blocks of %s are corrupt", reader->corrupt, reader->blocks, reader->inputFile);
+        if (reader->lost > 0)
+            printf(" and %llu characters are in blocks that were not found", reader->lost);
+        printf("\n");
+        return 0;
+    }
+    return 1;
+}
+
+void decodeBlocks(char *inputFile, char *outputFile, BlockDecoder decoder, size_t maxPayload, void *state)
+{
+    if (!tryDecodeBlocks(inputFile, outputFile, decoder, maxPayload, state))
+        exit(EXIT_FAILURE);
+}
+
+int tryDecodeBlocks(char *inputFile, char *outputFile, BlockDecoder decoder, size_t maxPayload, void *state)
+{
+    BlockReader reader;
+    initializeBlockReader(&reader, inputFile, outputFile, decoder, maxPayload, state);
+    TRACE_PROBE0(decode_start);
+    int decoded = tryRunPipeline(inputFile, outputFile, decodeBlock, &reader);
+    TRACE_PROBE0(decode_done);
+    return finishBlockReader(&reader, decoded);
+}
+
+void decodeMemoryBlocks(const EncodedSegment *segment, const unsigned char *data, size_t length, char *name,
+                        char *outputFile, BlockDecoder decoder, size_t maxPayload, void *state)
+{
+    // the blocks start at once, as if the file header had been read
+    BlockReader reader;
+    initializeBlockReader(&reader, name, outputFile, decoder, maxPayload, state);
+    reader.segment = *segment;
+    reader.segmentKnown = 1;
+    reader.headerRead = 1;
+    reader.need = ENCODED_BLOCK_HEADER_SIZE;
+    TRACE_PROBE0(decode_start);
+    int decoded = tryRunPipelineOnMemory(data, length, 0, outputFile, decodeBlock, &reader);
+    TRACE_PROBE0(decode_done);
+    if (!finishBlockReader(&reader, decoded))
+        exit(EXIT_FAILURE);
+}
+
+/*the payload has already been checked when a block is given to the decoder*/
+static const unsigned char *skipBlock(void *state, const EncodedSegment *segment, const unsigned char *payload,
+                                      size_t payloadLength, size_t length, Pipeline *pipe)
+{
+    (void)state;
+    (void)segment;
+    (void)payload;
+    (void)payloadLength;
+    (void)length;
+    (void)pipe;
+    return NULL;
+}
+
+void verifyEncodedFile(char *inputFile)
+{
+    decodeBlocks(inputFile, NULL, skipBlock, ENCODED_MAX_PAYLOAD, NULL);
+    printf("Every block of %s matches its checksum\n", inputFile);
+}
+
+size_t readTransformHeader(const EncodedSegment *segment, const unsigned char *payload, size_t payloadLength,
+                           uint32_t *parameters, size_t *transformedLength)
+{
+    size_t headerLength = ENCODED_TRANSFORM_HEADER_SIZE(segment->transforms.count);
+    if (payloadLength < headerLength || getUint32(payload) > TRANSFORM_MAX_LENGTH)
+    {
+        printf("Error: Invalid block in encoded file\n");
+        return 0;
+    }
+
+    *transformedLength = getUint32(payload);
+    int i;
+    for (i = 0; i < segment->transforms.count; i++)
+        parameters[i] = getUint32(payload + 4 + 4 * i);
+    return headerLength;
+}
+
+/*reads the payload of a segment block after its header, returns 0 if the file ends before it*/
+static int readSegmentBlock(FILE *fp, const unsigned char *blockHeader, EncodedSegment *segment, char *inputFile)
+{
+    unsigned char payload[ENCODED_SEGMENT_SIZE];
+    if (getUint32(blockHeader + 4) != ENCODED_SEGMENT_SIZE || fread(payload, 1, ENCODED_SEGMENT_SIZE, fp) != ENCODED_SEGMENT_SIZE)
+        return 0;
+    // the model of a corrupt segment block is not used for the segments that are added after it
+    if (crc32c(crc32c(0, blockHeader, 12), payload, ENCODED_SEGMENT_SIZE) != getUint32(blockHeader + 12))
+    {
+        printf("Error: Segment %d of %s is corrupt\n", segment->number + 1, inputFile);
+        exit(EXIT_FAILURE);
+    }
+    if (!readSegment(payload, segment))
+        exit(EXIT_FAILURE);
+    return 1;
+}
+
+/*finds the end of a file from its tail block, returns 0 if the file has no valid tail block or the blocks it points
+ to are not there*/
+static int readTail(FILE *fp, unsigned long long fileSize, EncodedSegment *segment, EncodedTail *tail,
+                    unsigned long long *decodedLength, char *inputFile)
+{
+    unsigned char block[ENCODED_BLOCK_HEADER_SIZE + ENCODED_TAIL_SIZE];
+    size_t tailSize = ENCODED_BLOCK_HEADER_SIZE + ENCODED_TAIL_SIZE;
+    if (fileSize < ENCODED_HEADER_SIZE + tailSize || fseeko(fp, fileSize - tailSize, SEEK_SET) != 0 ||
+        fread(block, 1, tailSize, fp) != tailSize || getUint32(block) != ENCODED_TAIL_MARKER ||
+        getUint32(block + 4) != ENCODED_TAIL_SIZE || getUint32(block + 16) != ENCODED_SYNC_WORD ||
+        crc32c(0, block, 36) != getUint32(block + 36) ||
+        crc32c(crc32c(0, block, 12), block + ENCODED_BLOCK_HEADER_SIZE, ENCODED_TAIL_SIZE) != getUint32(block + 12))
+        return 0;
+    tail->segmentPosition = getUint64(block + ENCODED_BLOCK_HEADER_SIZE);
+    tail->blockPosition = getUint64(block + ENCODED_BLOCK_HEADER_SIZE + 8);
+    tail->end = fileSize - tailSize;
+    *decodedLength = getUint64(block + ENCODED_BLOCK_HEADER_SIZE + 16);
+
+    unsigned char blockHeader[ENCODED_BLOCK_HEADER_SIZE];
+    if (fseeko(fp, tail->segmentPosition, SEEK_SET) != 0 ||
+        fread(blockHeader, 1, ENCODED_BLOCK_HEADER_SIZE, fp) != ENCODED_BLOCK_HEADER_SIZE ||
+        getUint32(blockHeader) != ENCODED_SEGMENT_MARKER || !readSegmentBlock(fp, blockHeader, segment, inputFile))
+        return 0;
+    // a file of an empty input has no block
+    if (tail->blockPosition == 0)
+        return 1;
+    if (fseeko(fp, tail->blockPosition, SEEK_SET) != 0 ||
+        fread(blockHeader, 1, ENCODED_BLOCK_HEADER_SIZE, fp) != ENCODED_BLOCK_HEADER_SIZE ||
+        getUint32(blockHeader) > PIPELINE_BLOCK_SIZE)
+        return 0;
+    tail->blockLength = getUint32(blockHeader);
+    tail->blockCrc = getUint32(blockHeader + 8);
+    return 1;
+}
+
+unsigned long long readLastSegment(char *inputFile, EncodedSegment *segment, EncodedTail *tail)
+{
+    FILE *fp = NULL;
+    // check if file can be opened
+    if ((fp = fopen(inputFile, "rb")) == NULL)
+    {
+        printf("Error: Unable to open %s\n", inputFile);
+        exit(EXIT_FAILURE);
+    }
+
+    unsigned char header[ENCODED_HEADER_SIZE];
+    if (fread(header, 1, ENCODED_HEADER_SIZE, fp) != ENCODED_HEADER_SIZE || memcmp(header, ENCODED_FILE_MAGIC, 4) != 0 ||
+        header[4] != ENCODED_FILE_VERSION)
+    {
+        printf("Error: %s is not a binary encoded file\n", inputFile);
+        exit(EXIT_FAILURE);
+    }
+    struct stat fileStat;
+    if (fstat(fileno(fp), &fileStat) != 0)
+    {
+        printf("Error: Unable to read %s\n", inputFile);
+        exit(EXIT_FAILURE);
+    }
+
+    // the tail block points to the last segment block and the last block, so nothing else is read
+    unsigned long long decodedLength = 0;
+    memset(tail, 0, sizeof(EncodedTail));
+    initializeSegment(segment, header[5], 0);
+    if (!readTail(fp, fileStat.st_size, segment, tail, &decodedLength, inputFile))
+    {
+        printf("Error: The tail block of %s is missing or corrupt, decode it and encode it again with -e\n", inputFile);
+        exit(EXIT_FAILURE);
+    }
+
+    fclose(fp);
+    return decodedLength;
+}
@@ -0,0 +1,437 @@
+/**
+ * @file encodedFile.h
+ * @brief Header file for the binary encoded file format.
+ *
+ * This file contains declarations for functions for writing and reading binary encoded files.
+ * A binary encoded file starts with a small header that has the ENCODED_FILE_MAGIC bytes and the
+ * backend that encoded it, and then has a sequence of blocks. Each block has the number of characters
+ * it encodes and the size of its payload, followed by the payload itself. Every block of the input file
+ * is encoded separately, so the decoder only needs to keep 1 block in memory.
+ *
+ * The blocks are grouped in segments. A segment starts with a block that has ENCODED_SEGMENT_MARKER as its number
+ * of characters and records the backend and the model that the following blocks were encoded with, and where the
+ * segment starts in the decoded file. Every file starts with a segment block, and new segments can be added to the
+ * end of a file when its input grows, so only the new part of the input needs to be encoded. A segment can also
+ * record a library of models by their checksums, and then every block starts with the number of the model it was
+ * encoded with.
+ *
+ * A segment can also record a chain of transforms that were applied to every block before it was encoded. The
+ * payload of each of its blocks then starts with the length of the transformed block and the number that each
+ * transform needs to be inverted, and the number of characters of the block is still that of the original block.
+ *
+ * The header of every block is ENCODED_BLOCK_HEADER_SIZE bytes long:\n
+ * the number of characters, the size of the payload, a CRC32C checksum of the characters, a CRC32C checksum of the
+ * first 12 bytes of the header and the payload, the ENCODED_SYNC_WORD, the offset in the decoded file of the segment,
+ * the offset in the decoded file of the first character and a CRC32C checksum of the first 36 bytes of the header.
+ *
+ * Both checksums of the block are computed while the block is encoded and checked while it is decoded, the
+ * payload before it is decoded and the characters after, so a corrupt block is found before its bits are decoded
+ * and is reported with its number and the characters it encodes. The blocks are encoded separately, so the other
+ * blocks are still decoded and the characters of a corrupt block are written as zeros, which keeps every other
+ * character at its offset.
+ *
+ * After a corrupt header the decoder looks at every byte that follows for a header with the sync word and a matching
+ * checksum, and goes on decoding from there. The characters of the blocks that were skipped are written as zeros up
+ * to the offset of the block that was found, and a block whose segment block was skipped or is corrupt is written as
+ * zeros too, since its model is not known. Only the blocks of a packed file stop the decoder, since every block
+ * depends on the blocks before it, and the characters after the last block that is found are lost.
+ *
+ * A file ends with a tail block that has ENCODED_TAIL_MARKER as its number of characters. Its
+ * payload has the positions in the file of the last segment block and of the last block, and the number of
+ * characters of the whole file, so -t finds where to add a segment by reading the end of the file instead of every
+ * block header. A new segment replaces the tail block and is followed by a new one. -t cannot add to a file whose
+ * tail block is missing or corrupt, for example because the program stopped while adding a segment, but the
+ * decoder does not need it and still decodes every character.
+ *
+ * Every block that is encoded or decoded fires the encode_block or decode_block tracepoint and is added to the
+ * counters of traceProbes.h.
+ *
+ * Files created by the first versions of the program do not have the header and contain only
+ * '0' and '1' characters, so they are never mistaken for binary encoded files.
+ *
+ * @author Spyros Sachmpazidis
+ * @bug No know bugs.
+ * @version 1.14
+ * @since 19/10/26
+ */
+
+#ifndef ENCODED_FILE_H
+#define ENCODED_FILE_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "pipeline.h"
+#include "huffmanTree.h"
+#include "blockTransform.h"
+#include "traceProbes.h"
+#include "crc32c.h"
+
+/*The first bytes of every binary encoded file*/
+#define ENCODED_FILE_MAGIC "HUFB"
+/*The version of the binary encoded file format*/
+#define ENCODED_FILE_VERSION 1
+/*The size of the file header in bytes*/
+#define ENCODED_HEADER_SIZE 8
+/*The size of the header of each block in bytes*/
+#define ENCODED_BLOCK_HEADER_SIZE 40
+/*The sync word of every block header, its bytes are not text so it is rarely found in a payload*/
+#define ENCODED_SYNC_WORD 0xB10C5EC7u
+
+/*The number of characters of a block that starts a segment*/
+#define ENCODED_SEGMENT_MARKER 0xFFFFFFFFu
+/*The size of the payload of a block that starts a segment*/
+#define ENCODED_SEGMENT_SIZE (16 + 8 * ASCII_SIZE)
+/*The number of characters of the tail block at the end of a file*/
+#define ENCODED_TAIL_MARKER 0xFFFFFFFEu
+/*The size of the payload of the tail block, the positions of the last segment block and the last block and the number
+ of characters of the file*/
+#define ENCODED_TAIL_SIZE 24
+
+/*The size of the header of a transformed block, its length and the number of each transform*/
+#define ENCODED_TRANSFORM_HEADER_SIZE(stages) (4 + 4 * (size_t)(stages))
+
+/*The largest payload that a coder writes for a block where every character costs at most maxBits bits, a transformed
+ block can be longer than the original*/
+#define MAX_BLOCK_PAYLOAD(maxBits) ((size_t)TRANSFORM_MAX_LENGTH / 8 * (maxBits) + 16)
+/*The largest payload of any block, the longest huffman code has ASCII_SIZE bits and 8 more when it is escaped*/
+#define ENCODED_MAX_PAYLOAD MAX_BLOCK_PAYLOAD(ASCII_SIZE + 8)
+
+/*The file cannot be opened, so its backend is not known*/
+#define BACKEND_UNREADABLE (-2)
+/*The file is a text file of '0' and '1' characters without a header*/
+#define BACKEND_LEGACY (-1)
+/*The file was encoded with the huffman codes*/
+#define BACKEND_HUFFMAN 0
+/*The file was encoded with the table based asymmetric numeral system*/
+#define BACKEND_TANS 1
+/*The file was encoded with the canonical codes of a token model, which is never recorded in the file*/
+#define BACKEND_TOKENS 2
+/*The file was packed from a text file of the first versions of the program and is decoded with the same tree, the
+ payload of each block starts with the number of bits it has and its number of characters is that of the text*/
+#define BACKEND_PACKED_LEGACY 3
+
+/*The hasModel of a segment that records a library of models instead of 1 model, see codecLibrary.h*/
+#define ENCODED_LIBRARY_MODEL 2
+
+/**
+ * @struct EncodedSegment
+ * @brief Represents how the blocks of a segment were encoded.
+ *
+ * The structure contains the backend, the model if it is recorded, the transforms of the blocks, the offset in the
+ * decoded file where the segment starts and the number of the segment in the file. The weights are recorded exactly,
+ * counts as integers and probabilities as floats, so the recorded model creates the same tables as the probfile.
+ * A segment of a member of an archive is kept in the model table of the archive, so its blocks are written without
+ * the file header and the segment block.
+ *
+ * @since 1.1
+ */
+typedef struct
+{
+    int backend;
+    int hasModel;
+    int exact;
+    unsigned long long inputOffset;
+    int number;
+    int member;
+    TransformChain transforms;
+    double weights[ASCII_SIZE];
+} EncodedSegment;
+
+/**
+ * @struct EncodedTail
+ * @brief Represents the end of a binary encoded file, where the next segment is added.
+ *
+ * The structure contains the positions in the file of the last segment block and of the last block, the position
+ * where the blocks end, which is where the tail block starts, and the number of characters and the
+ * checksum of the characters of the last block. The last block has 0 characters if the file has no block.
+ *
+ * @since 1.12
+ */
+typedef struct
+{
+    unsigned long long segmentPosition;
+    unsigned long long blockPosition;
+    unsigned long long end;
+    uint32_t blockLength;
+    uint32_t blockCrc;
+} EncodedTail;
+
+/**
+ * @brief Encodes a block of the input file.
+ *
+ * A function of this type is called by encodeBlocks for every block of the input file, after the transforms of the
+ * segment have been applied to it.
+ *
+ * @param state The state given to encodeBlocks.
+ * @param data The characters of the block.
+ * @param length The number of characters in the block.
+ * @param payload The buffer that the encoded block is written to.
+ * @return The number of bytes written to the payload.
+ * @since 1.0
+ */
+typedef size_t (*BlockEncoder)(const void *state, const unsigned char *data, size_t length, unsigned char *payload);
+
+/**
+ * @brief Decodes a block of an encoded file.
+ *
+ * A function of this type is called by decodeBlocks for every block of the encoded file whose payload matches its
+ * checksum. It returns the decoded characters, which decodeBlocks checks against the checksum of the characters and
+ * writes to the pipeline. A decoder whose characters are not those that were encoded writes them to the pipeline
+ * itself and returns NULL. A decoder that cannot decode the block prints the error, calls failPipeline and returns
+ * NULL.
+ *
+ * @param state The state given to decodeBlocks.
+ * @param segment The segment of the block.
+ * @param payload The payload of the block.
+ * @param payloadLength The number of bytes in the payload.
+ * @param length The number of characters that the block encodes.
+ * @param pipe The pipeline that the decoder can write to.
+ * @return The decoded characters of the block, or NULL if they were written to the pipeline.
+ * @since 1.0
+ */
+typedef const unsigned char *(*BlockDecoder)(void *state, const EncodedSegment *segment, const unsigned char *payload, size_t payloadLength, size_t length, Pipeline *pipe);
+
+/**
+ * @brief Finds the backend that encoded a file.
+ *
+ * This function reads the header of an encoded file and returns the backend written in it.
+ * If the file does not start with the ENCODED_FILE_MAGIC bytes it is a legacy text file.
+ *
+ * @param inputFile The encoded file.
+ * @return The backend of the file, BACKEND_LEGACY if the file has no header, or BACKEND_UNREADABLE if it cannot be
+ * opened, the error is printed.
+ * @since 1.0
+ */
+int readEncodedBackend(char *inputFile);
+
+/**
+ * @brief Starts the description of a segment that does not record its model and has no transforms.
+ *
+ * @param segment Pointer to the segment.
+ * @param backend The backend of the segment.
+ * @param inputOffset The offset in the decoded file where the segment starts.
+ * @since 1.1
+ */
+void initializeSegment(EncodedSegment *segment, int backend, unsigned long long inputOffset);
+
+/**
+ * @brief Encodes a file block by block into a binary encoded file.
+ *
+ * This function writes the file header and the segment block and then uses the pipelined I/O engine to give every
+ * block of the input file to the encoder and write the returned payload as a block of the output file.
+ * The headers are written together with the first block, and after the blocks if the input file is empty, so every
+ * encoded file has its segment and -t can add to it. Every file ends with the tail
+ * block, which is written after the blocks. If the segment does not start at offset 0, only the input after that offset is encoded and the new segment is
+ * added to the end of the existing output file. If the segment is a member of an archive,
+ * only its blocks are added to the end of the output file. The checksums of each block are computed while the block
+ * is still in the cache. If the segment has transforms, every block is transformed in buffers
+ * that are allocated once, and the header of the transformed block is written before the payload of the encoder.
+ *
+ * @param inputFile The input file.
+ * @param outputFile The output file.
+ * @param segment The segment that is written before the blocks.
+ * @param encoder The function that encodes each block.
+ * @param maxPayload The largest payload the encoder can return for a block of TRANSFORM_MAX_LENGTH characters.
+ * @param state The state that is passed to the encoder.
+ * @since 1.0
+ */
+void encodeBlocks(char *inputFile, char *outputFile, const EncodedSegment *segment, BlockEncoder encoder, size_t maxPayload,
+                  const void *state);
+
+/**
+ * @brief Encodes a file block by block into a binary encoded file, without stopping the program if it fails.
+ *
+ * This function works like encodeBlocks, but if a file cannot be opened, read or written the error is printed and
+ * the function returns 0.
+ *
+ * @param inputFile The input file.
+ * @param outputFile The output file.
+ * @param segment The segment that is written before the blocks.
+ * @param encoder The function that encodes each block.
+ * @param maxPayload The largest payload the encoder can return for a block of TRANSFORM_MAX_LENGTH characters.
+ * @param state The state that is passed to the encoder.
+ * @return 1 if the file was encoded, 0 otherwise.
+ * @since 1.14
+ */
+int tryEncodeBlocks(char *inputFile, char *outputFile, const EncodedSegment *segment, BlockEncoder encoder,
+                    size_t maxPayload, const void *state);
+
+/**
+ * @brief Encodes a buffer that is in memory block by block into a new binary encoded file.
+ *
+ * This function works like encodeBlocks, but the blocks are parts of the buffer, which is usually a memory mapping
+ * of the input file. The segment must start at offset 0.
+ *
+ * @param data The buffer.
+ * @param length The number of bytes in the buffer.
+ * @param stream 1 if the buffer is a memory mapping that is read ahead and let go of a window at a time.
+ * @param outputFile The output file.
+ * @param segment The segment that is written before the blocks.
+ * @param encoder The function that encodes each block.
+ * @param maxPayload The largest payload the encoder can return for a block of TRANSFORM_MAX_LENGTH characters.
+ * @param state The state that is passed to the encoder.
+ * @since 1.5
+ */
+void encodeMemoryBlocks(const unsigned char *data, size_t length, int stream, char *outputFile,
+                        const EncodedSegment *segment, BlockEncoder encoder, size_t maxPayload, const void *state);
+
+/**
+ * @brief Decodes a binary encoded file block by block.
+ *
+ * This function uses the pipelined I/O engine to read the encoded file, checks its header and
+ * collects each block until its whole payload has been read. The complete block is then given to the decoder
+ * together with its segment, and the decoder checks the backend of the segment.
+ *
+ * Every corrupt block is reported, its characters are written as zeros and the other blocks are still decoded, and
+ * the program stops with an error after the whole file has been decoded. A corrupt segment block or block header
+ * does not stop the program either, the blocks that cannot be decoded are written as zeros and the decoder goes on
+ * from the next block that it finds. The program stops at once if a block of a packed file is corrupt, or if the
+ * decoded characters do not match their checksum, which means that the file was encoded with a different probfile.
+ *
+ * @param inputFile The encoded file.
+ * @param outputFile The output file, or NULL if the decoded characters are not written.
+ * @param decoder The function that decodes each block.
+ * @param maxPayload The largest payload that a valid block can have.
+ * @param state The state that is passed to the decoder.
+ * @since 1.0
+ */
+void decodeBlocks(char *inputFile, char *outputFile, BlockDecoder decoder, size_t maxPayload, void *state);
+
+/**
+ * @brief Decodes a binary encoded file block by block, without stopping the program if it fails.
+ *
+ * This function works like decodeBlocks, but where decodeBlocks stops the program the error is printed and the
+ * function returns 0. A block that cannot be decoded stops the decoding at once, like a corrupt block of a packed
+ * file.
+ *
+ * @param inputFile The encoded file.
+ * @param outputFile The output file, or NULL if the decoded characters are not written.
+ * @param decoder The function that decodes each block.
+ * @param maxPayload The largest payload that a valid block can have.
+ * @param state The state that is passed to the decoder.
+ * @return 1 if every block was decoded, 0 otherwise.
+ * @since 1.14
+ */
+int tryDecodeBlocks(char *inputFile, char *outputFile, BlockDecoder decoder, size_t maxPayload, void *state);
+
+/**
+ * @brief Decodes the blocks of a member of an archive that is in memory.
+ *
+ * This function works like decodeBlocks, but the blocks are read from a buffer, which is usually a part of a memory
+ * mapping of the archive, and have no file header or segment block. They belong to the given segment. Members of an archive can be decoded by many threads at once.
+ *
+ * @param segment The segment of the blocks.
+ * @param data The blocks.
+ * @param length The number of bytes of the blocks.
+ * @param name The name of the member in the messages about corrupt blocks.
+ * @param outputFile The output file, or NULL if the decoded characters are not written.
+ * @param decoder The function that decodes each block.
+ * @param maxPayload The largest payload that a valid block can have.
+ * @param state The state that is passed to the decoder.
+ * @since 1.8
+ */
+void decodeMemoryBlocks(const EncodedSegment *segment, const unsigned char *data, size_t length, char *name,
+                        char *outputFile, BlockDecoder decoder, size_t maxPayload, void *state);
+
+/**
+ * @brief Writes the payload of the block that starts a segment.
+ *
+ * The payload has ENCODED_SEGMENT_SIZE bytes, probabilities are kept as the bits of their float.
+ *
+ * @param payload The buffer that the payload is written to.
+ * @param segment The segment.
+ * @since 1.8
+ */
+void writeSegment(unsigned char *payload, const EncodedSegment *segment);
+
+/**
+ * @brief Reads the payload of the block that starts a segment.
+ *
+ * The segment gets the next number.
+ *
+ * @param payload The payload of ENCODED_SEGMENT_SIZE bytes.
+ * @param segment The segment that is read, its number is increased.
+ * @return 1 if the segment was read, 0 if its transforms are not valid, the error is printed.
+ * @since 1.8
+ */
+int readSegment(const unsigned char *payload, EncodedSegment *segment);
+
+/**
+ * @brief Checks the payload of every block of an encoded file against its checksum without decoding it.
+ *
+ * No model is needed, so a file can be checked before it is decoded or after it is copied. The corrupt blocks are
+ * reported like in decodeBlocks.
+ *
+ * @param inputFile The encoded file.
+ * @since 1.7
+ */
+void verifyEncodedFile(char *inputFile);
+
+/**
+ * @brief Reads the header of a block of a segment with transforms.
+ *
+ * @param segment The segment of the block.
+ * @param payload The payload of the block, it starts with the header.
+ * @param payloadLength The number of bytes in the payload.
+ * @param parameters The array that the number of each transform is written to.
+ * @param transformedLength Pointer to where the length of the transformed block is written.
+ * @return The number of bytes in the header, or 0 if the payload is too short for the header or the transformed block
+ * is too long, the error is printed.
+ * @since 1.2
+ */
+size_t readTransformHeader(const EncodedSegment *segment, const unsigned char *payload, size_t payloadLength,
+                           uint32_t *parameters, size_t *transformedLength);
+
+/**
+ * @brief Finds the last segment of a binary encoded file and the length of the decoded file.
+ *
+ * Only the tail block, the last segment block and the header of the last block are read. The program stops with an
+ * error if the tail block is missing or corrupt.
+ *
+ * @param inputFile The encoded file.
+ * @param segment Pointer to the segment that the last segment is written to.
+ * @param tail Pointer to where the end of the file is written to.
+ * @return The number of characters that the whole file encodes.
+ * @since 1.1
+ */
+unsigned long long readLastSegment(char *inputFile, EncodedSegment *segment, EncodedTail *tail);
+
+/**
+ * @brief Writes a 32 bit number in little endian order.
+ *
+ * @param bytes The 4 bytes to write to.
+ * @param value The number.
+ * @since 1.0
+ */
+void putUint32(unsigned char *bytes, uint32_t value);
+
+/**
+ * @brief Reads a 32 bit number in little endian order.
+ *
+ * @param bytes The 4 bytes to read from.
+ * @return The number.
+ * @since 1.0
+ */
+uint32_t getUint32(const unsigned char *bytes);
+
+/**
+ * @brief Writes a 64 bit number in little endian order.
+ *
+ * @param bytes The 8 bytes to write to.
+ * @param value The number.
+ * @since 1.1
+ */
+void putUint64(unsigned char *bytes, uint64_t value);
+
+/**
+ * @brief Reads a 64 bit number in little endian order.
+ *
+ * @param bytes The 8 bytes to read from.
+ * @return The number.
+ * @since 1.1
+ */
+uint64_t getUint64(const unsigned char *bytes);
+
+#endif
@@ -0,0 +1,223 @@
+#include "encodedSearch.h"
+
+/*The state of the search between the blocks of the encoded file*/
+typedef struct
+{
+    CodecModel *model;
+    CodecModel *recorded;
+    TransformBuffers *buffers;
+    SearchMatcher *matcher;
+    int offsetsOnly;
+    int state;
+    unsigned long long offset;
+    unsigned long long lineOffset;
+    int lineMatched;
+    unsigned long long matches;
+    unsigned char *line;
+    size_t lineLength;
+    size_t lineCapacity;
+    int lineTruncated;
+    unsigned char buffer[PIPELINE_BLOCK_SIZE];
+} Searcher;
+
+#ifdef DEBUG_ENCODED_SEARCH
+int main(int argc, char *argv[])
+{
+    if (argc != 4)
+    {
+        printf("Correct files not given!\n");
+        exit(EXIT_FAILURE);
+    }
+    printf("Debugging encodedSearch.c:\n");
+    printf("Trying to open %s to read the model...\n", argv[1]);
+    CodecModel *model = loadCodecModel(argv[1]);
+    printf("Success!\n");
+    printf("Trying to search %s for %s...\n", argv[2], argv[3]);
+    unsigned long long matches = searchEncodedFile(model, argv[2], argv[3], 0);
+    printf("Success!Found %llu matches\n", matches);
+    freeCodecModel(model);
+}
+#endif
+
+SearchMatcher *createSearchMatcher(char *pattern)
+{
+    int length = strlen(pattern);
+    if (length == 0)
+    {
+        printf("Error: The search pattern is empty\n");
+        exit(EXIT_FAILURE);
+    }
+
+    SearchMatcher *matcher = NULL;
+    if ((matcher = (SearchMatcher *)malloc(sizeof(SearchMatcher))) == NULL ||
+        (matcher->next = (int *)calloc((size_t)(length + 1) * BYTE_SIZE, sizeof(int))) == NULL)
+    {
+        printf("System out of memory!");
+        exit(EXIT_FAILURE);
+    }
+    matcher->length = length;
+
+    // the restart state is where the matcher would be after the pattern without its first character
+    const unsigned char *bytes = (const unsigned char *)pattern;
+    int *next = matcher->next;
+    int restart = 0;
+    int state, c;
+    next[bytes[0]] = 1;
+    for (state = 1; state < length; state++)
+    {
+        for (c = 0; c < BYTE_SIZE; c++)
+            next[state * BYTE_SIZE + c] = next[restart * BYTE_SIZE + c];
+        next[state * BYTE_SIZE + bytes[state]] = state + 1;
+        restart = next[restart * BYTE_SIZE + bytes[state]];
+    }
+    // after a match the search goes on from the restart state, so overlapping matches are found
+    for (c = 0; c < BYTE_SIZE; c++)
+        next[length * BYTE_SIZE + c] = next[restart * BYTE_SIZE + c];
+
+    return matcher;
+}
+
+/*keeps the part of the current line that is in this block, in case the line has a match in a later block, only the
+ first SEARCH_LINE_SIZE bytes of a line are kept*/
+static void appendLine(Searcher *searcher, const unsigned char *text, size_t length)
+{
+    if (searcher->lineLength + length > SEARCH_LINE_SIZE)
+    {
+        searcher->lineTruncated = 1;
+        length = SEARCH_LINE_SIZE - searcher->lineLength;
+    }
+    if (searcher->lineLength + length > searcher->lineCapacity)
+    {
+        size_t capacity = searcher->lineCapacity * 2;
+        if (capacity < searcher->lineLength + length)
+            capacity = searcher->lineLength + length;
+        if (capacity > SEARCH_LINE_SIZE)
+            capacity = SEARCH_LINE_SIZE;
+        unsigned char *temp = realloc(searcher->line, capacity);
+        if (temp == NULL)
+        {
+            printf("System out of memory!");
+            exit(EXIT_FAILURE);
+        }
+        searcher->line = temp;
+        searcher->lineCapacity = capacity;
+    }
+    memcpy(searcher->line + searcher->lineLength, text, length);
+    searcher->lineLength += length;
+}
+
+static void printLine(Searcher *searcher, const unsigned char *text, size_t length)
+{
+    printf("%llu:", searcher->lineOffset);
+    fwrite(searcher->line, 1, searcher->lineLength, stdout);
+    // the part of a long line between its start and this block is left out
+    if (searcher->lineTruncated)
+        printf("%s", SEARCH_TRUNCATED_LINE);
+    fwrite(text, 1, length, stdout);
+}
+
+static void scanBlock(Searcher *searcher, const unsigned char *text, size_t length)
+{
+    const int *next = searcher->matcher->next;
+    int patternLength = searcher->matcher->length;
+    int state = searcher->state;
+    size_t lineStart = 0;
+    size_t i;
+    for (i = 0; i < length; i++)
+    {
+        state = next[state * BYTE_SIZE + text[i]];
+        if (state == patternLength)
+        {
+            searcher->matches++;
+            searcher->lineMatched = 1;
+            if (searcher->offsetsOnly)
+                printf("%llu\n", searcher->offset + i + 1 - patternLength);
+        }
+        if (text[i] == '\n')
+        {
+            if (searcher->lineMatched && !searcher->offsetsOnly)
+                printLine(searcher, text + lineStart, i + 1 - lineStart);
+            searcher->lineMatched = 0;
+            searcher->lineLength = 0;
+            searcher->lineTruncated = 0;
+            lineStart = i + 1;
+            searcher->lineOffset = searcher->offset + lineStart;
+        }
+    }
+
+    if (!searcher->offsetsOnly)
+        appendLine(searcher, text + lineStart, length - lineStart);
+    searcher->state = state;
+    searcher->offset += length;
+}
+
+static const unsigned char *searchBlock(void *state, const EncodedSegment *segment, const unsigned char *payload,
+                                       size_t payloadLength, size_t length, Pipeline *pipe)
+{
+    Searcher *searcher = (Searcher *)state;
+    CodecModel *model = segmentModel(searcher->model, segment, &searcher->recorded);
+    if (model == NULL ||
+        !decodeCodecPayload(model, segment, searcher->buffers, payload, payloadLength, length, searcher->buffer))
+    {
+        failPipeline(pipe);
+        return NULL;
+    }
+    scanBlock(searcher, searcher->buffer, length);
+    return searcher->buffer;
+}
+
+unsigned long long searchEncodedFile(CodecModel *model, char *encodedFile, char *pattern, int offsetsOnly)
+{
+    int backend = readEncodedBackend(encodedFile);
+    if (backend == BACKEND_UNREADABLE)
+        exit(EXIT_FAILURE);
+    if (backend == BACKEND_LEGACY || backend == BACKEND_PACKED_LEGACY)
+    {
+        printf("Error: %s was encoded by the first versions of the program, encode it again to search it\n", encodedFile);
+        exit(EXIT_FAILURE);
+    }
+
+    Searcher *searcher = NULL;
+    if ((searcher = (Searcher *)malloc(sizeof(Searcher))) == NULL)
+    {
+        printf("System out of memory!");
+        exit(EXIT_FAILURE);
+    }
+    searcher->model = model;
+    searcher->recorded = NULL;
+    searcher->buffers = createTransformBuffers();
+    searcher->matcher = createSearchMatcher(pattern);
+    searcher->offsetsOnly = offsetsOnly;
+    searcher->state = 0;
+    searcher->offset = 0;
+    searcher->lineOffset = 0;
+    searcher->lineMatched = 0;
+    searcher->matches = 0;
+    searcher->line = NULL;
+    searcher->lineLength = 0;
+    searcher->lineCapacity = 0;
+    searcher->lineTruncated = 0;
+
+    // nothing is written to the pipeline, the matches are printed as they are found
+    decodeBlocks(encodedFile, NULL, searchBlock, ENCODED_MAX_PAYLOAD, searcher);
+
+    // the last line of the file may not end with a new line
+    if (searcher->lineMatched && !offsetsOnly)
+        printLine(searcher, (const unsigned char *)"\n", 1);
+    fflush(stdout);
+
+    unsigned long long matches = searcher->matches;
+    freeSearchMatcher(searcher->matcher);
+    if (searcher->recorded != NULL)
+        freeCodecModel(searcher->recorded);
+    freeTransformBuffers(searcher->buffers);
+    free(searcher->line);
+    free(searcher);
+    return matches;
+}
+
+void freeSearchMatcher(SearchMatcher *matcher)
+{
+    free(matcher->next);
+    free(matcher);
+}
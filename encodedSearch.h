@@ -0,0 +1,86 @@
+/**
+ * @file encodedSearch.h
+ * @brief Header file for searching binary encoded files for a string.
+ *
+ * This file contains declarations for functions for finding a string inside a binary encoded file without
+ * writing the decoded file. Every block is decoded into a buffer that stays in the cache and is scanned with a
+ * table driven matcher, a finite automaton built from the pattern that moves to its next state with 1 lookup
+ * for every character. Nothing is written for the blocks without a match, only the offsets of the matches or
+ * the lines that contain them are printed. Only the start of a long line is kept until its end is found, so a
+ * file that is 1 long line is searched in the same memory as any other.
+ *
+ * @author Spyros Sachmpazidis
+ * @bug No know bugs.
+ * @version 1.3
+ * @since 19/10/26
+ */
+
+#ifndef ENCODED_SEARCH_H
+#define ENCODED_SEARCH_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "codecModel.h"
+#include "encodedFile.h"
+
+/*The largest start of a line that is kept while its end is in a later block*/
+#define SEARCH_LINE_SIZE (1 << 16)
+/*Printed in place of the part of a matched line that was not kept*/
+#define SEARCH_TRUNCATED_LINE "..."
+
+/**
+ * @struct SearchMatcher
+ * @brief Represents the automaton that finds a pattern.
+ *
+ * The state is the number of characters of the pattern that have been matched, and the table has the next
+ * state for every state and character. The pattern is found when the state becomes its length.
+ *
+ * @since 1.0
+ */
+typedef struct
+{
+    int length;
+    int *next;
+} SearchMatcher;
+
+/**
+ * @brief Creates the automaton of a pattern.
+ *
+ * The table is built like the failure function of the Knuth-Morris-Pratt algorithm, so that every character
+ * of the text is looked at only once and matches that overlap are all found.
+ *
+ * @param pattern The string to find, it cannot be empty.
+ * @return A pointer to the created automaton.
+ * @since 1.0
+ */
+SearchMatcher *createSearchMatcher(char *pattern);
+
+/**
+ * @brief Searches a binary encoded file for a string.
+ *
+ * This function decodes the encoded file 1 block at a time in memory and prints, like grep -b, every line that
+ * contains the pattern after the offset of the line in the decoded file. With offsetsOnly only the offset of
+ * every match is printed. Lines can continue from one block to the next, and a line that is longer than
+ * SEARCH_LINE_SIZE before the block where it ends is printed with SEARCH_TRUNCATED_LINE in place of its middle.
+ * The coder and the model of every segment are found from the file, the text files of the first versions of
+ * the program cannot be searched.
+ *
+ * @param model Pointer to the model used for the segments that do not record one.
+ * @param encodedFile The encoded file.
+ * @param pattern The string to find.
+ * @param offsetsOnly 1 to print only the offsets of the matches, 0 to print the lines.
+ * @return The number of matches.
+ * @since 1.0
+ */
+unsigned long long searchEncodedFile(CodecModel *model, char *encodedFile, char *pattern, int offsetsOnly);
+
+/**
+ * @brief Frees the memory allocated for the automaton.
+ *
+ * @param matcher Pointer to the automaton.
+ * @since 1.0
+ */
+void freeSearchMatcher(SearchMatcher *matcher);
+
+#endif
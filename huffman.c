@@ -7,7 +7,7 @@
  * 
  * @author Spyros Sachmpazidis
  * @bug No know bugs.
- * @version 1.1
+ * @version 1.17
  * @since 23/11/23
  */
 
@@ -16,6 +16,16 @@
 #include "huffmanTable.h"
 #include "huffmanDecoder.h"
 #include "huffmanEncoder.h"
+#include "tansCoder.h"
+#include "codecModel.h"
+#include "modelGenerator.h"
+#include "codecServer.h"
+#include "encodedSearch.h"
+#include "tokenModel.h"
+#include "legacyPacker.h"
+#include "traceProbes.h"
+#include "encodedArchive.h"
+#include "modelFitness.h"
 #include <getopt.h>
 #include <ctype.h>
 
@@ -33,7 +43,62 @@ void printUsage()
     printf("<executable> -p <inputfile> <outputfile>\t to calculate probabilities, or\n");
     printf("<executable> -s <probfile> \t to create huffman tree, or\n");
     printf("<executable> -e <probfile> <inputfile> <encodedfile>\t to encode a file, or\n");
-    printf("<executable> -d <probfile> <encodedfile> <decodedfile>\t to decode a file\n");
+    printf("<executable> -d <probfile> <encodedfile> <decodedfile>\t to decode a file, or\n");
+    printf("<executable> -q <chunks> <inputfile> <outputfile> [-r]\t to estimate probabilities from samples of a file, or\n");
+    printf("<executable> -c <inputfile> <countfile>\t to count characters, or\n");
+    printf("<executable> -m <countfile> <countfile1> ... <countfileN>\t to merge count files, or\n");
+    printf("<executable> -g <probfile> <sourcefile>\t to generate the C source of a model for 'make baked', or\n");
+    printf("<executable> -f <probfile> <encodedfile> <pattern> [-o]\t to print the lines of an encoded file that contain the pattern, or\n");
+    printf("<executable> -i <inputfile> <encodedfile>\t to count the characters of a file and encode it with the counts, reading it once, or\n");
+    printf("<executable> -t <inputfile> <encodedfile>\t to encode only what was added to the input file since it was encoded, or\n");
+    printf("<executable> -b <textfile> <encodedfile>\t to convert a '0' and '1' encoded file of the first versions into a binary encoded file, or\n");
+    printf("<executable> -z <probfile> <archivefile> <file1> ... <fileN>\t to pack files into an archive that records the model once, or\n");
+    printf("<executable> -y <archivefile> <directory>\t to extract every member of an archive into a directory, many at a time, or\n");
+    printf("<executable> -j <archivefile> <member> <outputfile>\t to extract 1 member of an archive, or\n");
+    printf("<executable> -n <archivefile>\t to list the members of an archive, or\n");
+    printf("<executable> -v <encodedfile>\t to check every block of an encoded file against its checksum without decoding it, or\n");
+    printf("<executable> -h <probfile> <inputfile> [<threshold>]\t to measure how well a model fits a file and if retraining it would save more than the threshold percent, or\n");
+    printf("<executable> -w <countersfile>\t to print the counters that a process keeps in the file named by HUFFMAN_COUNTERS, or\n");
+    printf("<executable> -l <socket> <probfile1> ... <probfileN>\t to serve encode and decode requests with the models kept in memory\n");
+    printf("The probfile can be either a probability file or a count file\n");
+    printf("Add -a tans to encode with the tans coder instead of the huffman codes, -d finds the coder by itself\n");
+    printf("Add -u <socket> to send -e and -d to a server started with -l instead of loading the model\n");
+    printf("Add -x <transforms> to -e and -c to transform every block with a chain of rle, mtf and bwt, for example -x bwt,mtf,rle\n");
+    printf("Add -k <symbols> to -p to train a token model of up to 65536 symbols, -e and -d use it when it is the probfile\n");
+    printf("Give probfiles separated by commas to -e to encode every block with the best of them, -d needs the same list\n");
+}
+
+/**
+ * @brief Prints how much a sampled model costs compared to the exact one.
+ *
+ * This function calculates the exact probabilities of the input file and creates the huffman tables
+ * of both the exact and the sampled probabilities. It then prints the average code length that each table
+ * gives for the input file and how much bigger the encoded file will be because of sampling.
+ * It can be used to choose the number of chunks for sampling.
+ *
+ * @param inputFile The input file that was sampled.
+ * @param sampleProb The probabilities that were estimated from the samples.
+ * @since 1.2
+ */
+void printSampleCost(char *inputFile, float *sampleProb)
+{
+    float *exactProb = calculateProbabilities(inputFile);
+    HuffmanTree *exactTree = createHuffmanTree(exactProb);
+    HuffmanTree *sampleTree = createHuffmanTree(sampleProb);
+    char **exactCodes = createHuffmanTable(exactTree);
+    char **sampleCodes = createHuffmanTable(sampleTree);
+
+    float exactBits = averageCodeLength(exactProb, exactCodes);
+    float sampleBits = averageCodeLength(exactProb, sampleCodes);
+    printf("Exact model:\t%f bits per character\n", exactBits);
+    printf("Sampled model:\t%f bits per character\n", sampleBits);
+    printf("Cost increase:\t%f%%\n", exactBits > 0 ? 100 * (sampleBits - exactBits) / exactBits : 0);
+
+    free(exactProb);
+    freeHuffmanTree(exactTree);
+    freeHuffmanTree(sampleTree);
+    freeHuffmanTable(exactCodes);
+    freeHuffmanTable(sampleCodes);
 }
 
 /**
@@ -47,7 +112,67 @@ void printUsage()
  * <executable> -p <inputfile> <outputfile> : to calculate probabilities from the input file and save them in the output file, or\n
  * <executable> -s <probfile> : to create huffman tree using the probabilities from the probfile, or\n
  * <executable> -e <probfile> <inputfile> <encodedfile> : to encode the input file into the encoded file using the probabilities from the probfile, or\n
- * <executable> -d <probfile> <encodedfile> <decodedfile> : to decode a the encoded file into the decoded file using the probabilities from the probfile.\n
+ * <executable> -d <probfile> <encodedfile> <decodedfile> : to decode a the encoded file into the decoded file using the probabilities from the probfile, or\n
+ * <executable> -q <chunks> <inputfile> <outputfile> [-r] : to estimate the probabilities from a number of chunks of the input file and save them in the output file.
+ * With -r the cost of the estimated probabilities compared to the exact ones is also printed, or\n
+ * <executable> -c <inputfile> <countfile> : to count the exact occurrences of all characters from the input file and save them in the count file, or\n
+ * <executable> -m <countfile> <countfile1> ... <countfileN> : to add the counts of all the given count files and save them in the first count file.\n
+ * 
+ * Wherever a probfile is needed a count file can also be used.\n
+ * With -a tans the file is encoded with the table based asymmetric numeral system coder instead of the huffman codes.
+ * The decoder finds which coder encoded a file from its header.\n
+ * With -x <transforms> every block is transformed before it is encoded with a chain of rle (run length), mtf (move to front)
+ * and bwt (block sorting) separated by commas, for example -x bwt,mtf,rle. The chain is recorded in the encoded file and -d
+ * inverts it by itself. With -c the characters are counted after the transforms, so the count file fits the transformed blocks.\n
+ * With -k <symbols> the -p option writes a token model instead of probabilities, an alphabet of the 256 characters and the most
+ * frequent words and runs of the input file with up to the given number of symbols. When the probfile of -e or -d is a token
+ * model, every token is encoded with 1 code.\n
+ * The probfile of -e, -d and -f can be a list of probfiles separated by commas, a library of models. Every block is encoded
+ * with the model that codes it in the fewest bits, found from the counts of its characters, and records only the number of
+ * that model, so the same list must be given to -d.\n
+ * 
+ * <executable> -g <probfile> <sourcefile> : to write the tables of the model as C source code. 'make baked MODEL=<probfile>'
+ * uses it to build huffman_baked, where 'baked' can be given instead of a probfile to use the model with no setup.\n
+ * 
+ * <executable> -f <probfile> <encodedfile> <pattern> [-o] : to print every line of the encoded file that contains the pattern
+ * after its offset in the decoded file, without writing the decoded file. With -o only the offset of every match is printed.\n
+ * 
+ * <executable> -i <inputfile> <encodedfile> : to count the characters of the input file and encode it with the exact counts in
+ * one step. The input file is mapped into memory and read only once, and the counts are recorded in the encoded file
+ * instead of being written to a probfile, so -d can decode it with any probfile. -a and -x can be added like with -e.\n
+ * 
+ * <executable> -t <inputfile> <encodedfile> : to encode the characters that were added to the end of the input file since it was
+ * encoded and append them to the encoded file as a new segment, with the coder and the model recorded in the encoded file.
+ * Every segment records its model, so -d decodes files with many segments even if the probfile has changed since.\n
+ * 
+ * <executable> -b <textfile> <encodedfile> : to convert a '0' and '1' text file of the first versions of the program into a
+ * binary encoded file by packing every character into 1 bit, without decoding it. -d decodes the converted file with the
+ * same probfile as the text file.\n
+ * 
+ * <executable> -z <probfile> <archivefile> <file1> ... <fileN> : to pack many files into 1 archive, each encoded with the model of
+ * the probfile, which is recorded once in the model table of the archive. A central directory at the end of the archive has the
+ * offset and the lengths of every member, so -a and -x work like with -e and nothing but the directory is read to find a member.\n
+ * <executable> -y <archivefile> <directory> : to extract every member of the archive into the directory, with 1 thread per processor.\n
+ * <executable> -j <archivefile> <member> <outputfile> : to extract only the named member of the archive.\n
+ * <executable> -n <archivefile> : to print the length, the encoded length, the model and the name of every member.\n
+ * 
+ * <executable> -v <encodedfile> : to check the checksums of every block of an encoded file without a probfile and without
+ * decoding it. -d checks them too while it decodes, reports every corrupt block and the characters it encodes, and still
+ * decodes the other blocks.\n
+ * 
+ * <executable> -h <probfile> <inputfile> [<threshold>] : to count the characters of the input file and print, for every character,
+ * the bits that the model spends on it against the ideal bits for its frequency, and then the entropy of the file, the overhead
+ * of the model over it, the divergence of the probfile from the file and the bits of a model retrained on the file. A line that
+ * starts with "Retrain:" says if retraining would make the encoded file smaller by more than the threshold percent, 1 by default.
+ * With -a tans the bits of the tans coder are measured.\n
+ * 
+ * <executable> -w <countersfile> : to print the blocks, characters and bits that a process has coded, the time it waited for
+ * its input and output and the time it spent building trees. The process keeps these counters in the file named by the
+ * HUFFMAN_COUNTERS environment variable, so they can be read while it runs, for example while it runs as a server.\n
+ * 
+ * <executable> -l <socket> <probfile1> ... <probfileN> : to start a server that keeps the models and all their tables in memory
+ * and encodes and decodes files for the requests it gets on the unix socket. With -u <socket>, -e and -d are sent to the
+ * server instead of loading the model, the probfile must be one of the models of the server.\n
  * 
  * Multiple options can be selected at once as long as all the arguments are correct for each option. 
  * In order to run, the user must at least select 1 option.
@@ -69,6 +194,35 @@ int main(int argc, char **argv)
     int sflag = 0;
     int eflag = 0;
     int dflag = 0;
+    int qflag = 0;
+    int rflag = 0;
+    int chunks = 0;
+    int cflag = 0;
+    int mflag = 0;
+    int backend = BACKEND_HUFFMAN;
+    int gflag = 0;
+    int lflag = 0;
+    int fflag = 0;
+    int oflag = 0;
+    int tflag = 0;
+    int tokenSymbols = 0;
+    int bflag = 0;
+    char *countersFile = NULL;
+    char *verifyFile = NULL;
+    char *archiveFile = NULL;
+    char **archiveMembers = NULL;
+    int archiveMemberCount = 0;
+    char *extractFile = NULL;
+    char *extractDirectory = NULL;
+    char *memberFile = NULL;
+    char *memberName = NULL;
+    char *memberOutput = NULL;
+    char *listFile = NULL;
+    int iflag = 0;
+    char *trainInput = NULL;
+    char *trainOutput = NULL;
+    TransformChain transforms;
+    transforms.count = 0;
 
     // initialize arguments for all options
     char *sampleFile = NULL;
@@ -76,11 +230,29 @@ int main(int argc, char **argv)
     char *dataFile = NULL;
     char *encodedFile = NULL;
     char *decodedFile = NULL;
+    char *countFile = NULL;
+    char *countSample = NULL;
+    char *mergeOutput = NULL;
+    char *sourceFile = NULL;
+    char **mergeFiles = NULL;
+    int mergeCount = 0;
+    char *listenSocket = NULL;
+    char **serverModels = NULL;
+    int serverModelCount = 0;
+    char *serverSocket = NULL;
+    char *searchFile = NULL;
+    char *pattern = NULL;
+    char *appendInput = NULL;
+    char *appendFile = NULL;
+    char *legacyFile = NULL;
+    char *packedFile = NULL;
+    char *fitnessFile = NULL;
+    double fitnessThreshold = FITNESS_DEFAULT_THRESHOLD;
 
     int c;
     opterr = 0;
 
-    while ((c = getopt(argc, argv, "p:s:e:d:")) != -1)
+    while ((c = getopt(argc, argv, "p:s:e:d:q:rc:m:a:g:l:u:f:ot:x:k:b:w:i:v:z:y:j:n:h:")) != -1)
     {
         switch (c)
         {
@@ -146,6 +318,274 @@ int main(int argc, char **argv)
                 return EXIT_FAILURE;
             }
             break;
+        case 'q':
+            qflag = 1;
+            // check chunks, sample and output are given
+            chunks = atoi(optarg);
+            if (chunks > 0 && optind + 1 < argc && argv[optind] && argv[optind + 1])
+            {
+                sampleFile = argv[optind];
+                probFile = argv[optind + 1];
+                optind += 2;
+            }
+            else
+            {
+                printf("Invalid format for -q.\n");
+                printf("Usage: <executable> -q <chunks> <inputfile> <outputfile> [-r]\n");
+                return EXIT_FAILURE;
+            }
+            break;
+        case 'r':
+            rflag = 1;
+            break;
+        case 'c':
+            cflag = 1;
+            // check if input and count file are given
+            countSample = optarg;
+            if (optind < argc && argv[optind])
+            {
+                countFile = argv[optind];
+                optind++;
+            }
+            else
+            {
+                printf("Invalid format for -c.\n");
+                printf("Usage: <executable> -c <inputfile> <countfile>\n");
+                return EXIT_FAILURE;
+            }
+            break;
+        case 'm':
+            mflag = 1;
+            // all the following arguments that are not options are count files
+            mergeOutput = optarg;
+            mergeFiles = &argv[optind];
+            while (optind < argc && argv[optind][0] != '-')
+            {
+                mergeCount++;
+                optind++;
+            }
+            if (mergeCount == 0)
+            {
+                printf("Invalid format for -m.\n");
+                printf("Usage: <executable> -m <countfile> <countfile1> ... <countfileN>\n");
+                return EXIT_FAILURE;
+            }
+            break;
+        case 'a':
+            // check the coder name
+            if (strcmp(optarg, "huffman") == 0)
+                backend = BACKEND_HUFFMAN;
+            else if (strcmp(optarg, "tans") == 0)
+                backend = BACKEND_TANS;
+            else
+            {
+                printf("Invalid coder for -a, use huffman or tans.\n");
+                return EXIT_FAILURE;
+            }
+            break;
+        case 'g':
+            gflag = 1;
+            // check if probfile and source file are given
+            probFile = optarg;
+            if (optind < argc && argv[optind])
+            {
+                sourceFile = argv[optind];
+                optind++;
+            }
+            else
+            {
+                printf("Invalid format for -g.\n");
+                printf("Usage: <executable> -g <probfile> <sourcefile>\n");
+                return EXIT_FAILURE;
+            }
+            break;
+        case 'l':
+            lflag = 1;
+            // all the following arguments that are not options are the models of the server
+            listenSocket = optarg;
+            serverModels = &argv[optind];
+            while (optind < argc && argv[optind][0] != '-')
+            {
+                serverModelCount++;
+                optind++;
+            }
+            if (serverModelCount == 0)
+            {
+                printf("Invalid format for -l.\n");
+                printf("Usage: <executable> -l <socket> <probfile1> ... <probfileN>\n");
+                return EXIT_FAILURE;
+            }
+            break;
+        case 'u':
+            serverSocket = optarg;
+            break;
+        case 'f':
+            fflag = 1;
+            // check if encoded file and pattern are given
+            probFile = optarg;
+            if (optind + 1 < argc && argv[optind] && argv[optind + 1])
+            {
+                searchFile = argv[optind];
+                pattern = argv[optind + 1];
+                optind += 2;
+            }
+            else
+            {
+                printf("Invalid format for -f.\n");
+                printf("Usage: <executable> -f <probfile> <encodedfile> <pattern> [-o]\n");
+                return EXIT_FAILURE;
+            }
+            break;
+        case 'o':
+            oflag = 1;
+            break;
+        case 't':
+            tflag = 1;
+            // check if input and encoded file are given
+            appendInput = optarg;
+            if (optind < argc && argv[optind])
+            {
+                appendFile = argv[optind];
+                optind++;
+            }
+            else
+            {
+                printf("Invalid format for -t.\n");
+                printf("Usage: <executable> -t <inputfile> <encodedfile>\n");
+                return EXIT_FAILURE;
+            }
+            break;
+        case 'b':
+            bflag = 1;
+            // check if text and encoded file are given
+            legacyFile = optarg;
+            if (optind < argc && argv[optind])
+            {
+                packedFile = argv[optind];
+                optind++;
+            }
+            else
+            {
+                printf("Invalid format for -b.\n");
+                printf("Usage: <executable> -b <textfile> <encodedfile>\n");
+                return EXIT_FAILURE;
+            }
+            break;
+        case 'i':
+            iflag = 1;
+            // check if input and encoded file are given
+            trainInput = optarg;
+            if (optind < argc && argv[optind])
+            {
+                trainOutput = argv[optind];
+                optind++;
+            }
+            else
+            {
+                printf("Invalid format for -i.\n");
+                printf("Usage: <executable> -i <inputfile> <encodedfile>\n");
+                return EXIT_FAILURE;
+            }
+            break;
+        case 'w':
+            countersFile = optarg;
+            break;
+        case 'v':
+            verifyFile = optarg;
+            break;
+        case 'h':
+            // check if the input file is given, the threshold can follow it
+            probFile = optarg;
+            if (optind < argc && argv[optind])
+            {
+                fitnessFile = argv[optind];
+                optind++;
+                char *end;
+                if (optind < argc && isdigit((unsigned char)argv[optind][0]))
+                {
+                    fitnessThreshold = strtod(argv[optind], &end);
+                    if (*end != '\0')
+                    {
+                        printf("Invalid threshold for -h.\n");
+                        return EXIT_FAILURE;
+                    }
+                    optind++;
+                }
+            }
+            else
+            {
+                printf("Invalid format for -h.\n");
+                printf("Usage: <executable> -h <probfile> <inputfile> [<threshold>]\n");
+                return EXIT_FAILURE;
+            }
+            break;
+        case 'z':
+            // the archive is followed by the files, all the following arguments that are not options
+            probFile = optarg;
+            if (optind < argc && argv[optind])
+            {
+                archiveFile = argv[optind];
+                optind++;
+            }
+            archiveMembers = &argv[optind];
+            while (optind < argc && argv[optind][0] != '-')
+            {
+                archiveMemberCount++;
+                optind++;
+            }
+            if (archiveFile == NULL || archiveMemberCount == 0)
+            {
+                printf("Invalid format for -z.\n");
+                printf("Usage: <executable> -z <probfile> <archivefile> <file1> ... <fileN>\n");
+                return EXIT_FAILURE;
+            }
+            break;
+        case 'y':
+            // check if archive and directory are given
+            extractFile = optarg;
+            if (optind < argc && argv[optind])
+            {
+                extractDirectory = argv[optind];
+                optind++;
+            }
+            else
+            {
+                printf("Invalid format for -y.\n");
+                printf("Usage: <executable> -y <archivefile> <directory>\n");
+                return EXIT_FAILURE;
+            }
+            break;
+        case 'j':
+            // check if archive, member and output file are given
+            memberFile = optarg;
+            if (optind + 1 < argc && argv[optind] && argv[optind + 1])
+            {
+                memberName = argv[optind];
+                memberOutput = argv[optind + 1];
+                optind += 2;
+            }
+            else
+            {
+                printf("Invalid format for -j.\n");
+                printf("Usage: <executable> -j <archivefile> <member> <outputfile>\n");
+                return EXIT_FAILURE;
+            }
+            break;
+        case 'n':
+            listFile = optarg;
+            break;
+        case 'x':
+            parseTransformChain(optarg, &transforms);
+            break;
+        case 'k':
+            // check the size of the alphabet
+            tokenSymbols = atoi(optarg);
+            if (tokenSymbols <= BYTE_SIZE || tokenSymbols > TOKEN_MAX_SYMBOLS)
+            {
+                printf("Invalid number of symbols for -k, use %d to %d.\n", BYTE_SIZE + 1, TOKEN_MAX_SYMBOLS);
+                return EXIT_FAILURE;
+            }
+            break;
         case '?':
             if (optopt == 'p')
                 printf("Option requires 2 string argument -- 'p'\n");
@@ -155,6 +595,46 @@ int main(int argc, char **argv)
                 printf("option requires 3 string argument -- 'e'\n");
             else if (optopt == 'd')
                 printf("option requires 3 string argument -- 'd'\n");
+            else if (optopt == 'q')
+                printf("option requires 3 string argument -- 'q'\n");
+            else if (optopt == 'c')
+                printf("option requires 2 string argument -- 'c'\n");
+            else if (optopt == 'm')
+                printf("option requires at least 2 string argument -- 'm'\n");
+            else if (optopt == 'a')
+                printf("option requires a string argument -- 'a'\n");
+            else if (optopt == 'g')
+                printf("option requires 2 string argument -- 'g'\n");
+            else if (optopt == 'l')
+                printf("option requires at least 2 string argument -- 'l'\n");
+            else if (optopt == 'u')
+                printf("option requires a string argument -- 'u'\n");
+            else if (optopt == 'f')
+                printf("option requires 3 string argument -- 'f'\n");
+            else if (optopt == 't')
+                printf("option requires 2 string argument -- 't'\n");
+            else if (optopt == 'b')
+                printf("option requires 2 string argument -- 'b'\n");
+            else if (optopt == 'i')
+                printf("option requires 2 string argument -- 'i'\n");
+            else if (optopt == 'z')
+                printf("option requires at least 3 string argument -- 'z'\n");
+            else if (optopt == 'y')
+                printf("option requires 2 string argument -- 'y'\n");
+            else if (optopt == 'j')
+                printf("option requires 3 string argument -- 'j'\n");
+            else if (optopt == 'n')
+                printf("option requires a string argument -- 'n'\n");
+            else if (optopt == 'v')
+                printf("option requires a string argument -- 'v'\n");
+            else if (optopt == 'w')
+                printf("option requires a string argument -- 'w'\n");
+            else if (optopt == 'h')
+                printf("option requires at least 2 string argument -- 'h'\n");
+            else if (optopt == 'x')
+                printf("option requires a string argument -- 'x'\n");
+            else if (optopt == 'k')
+                printf("option requires an integer argument -- 'k'\n");
             else if (isprint(optopt))
                 printf("Invalid option -- '%c'\n", optopt);
             printUsage();
@@ -164,46 +644,137 @@ int main(int argc, char **argv)
         }
     }
 
-    printf("\n");
+    // the output of -f is only the matches, so that it can be given to other programs
+    if (!fflag)
+        printf("\n");
     // check for all arguments
-    if (pflag)
+    if (pflag && tokenSymbols > 0)
+    {
+        TokenModel *model = trainTokenModel(sampleFile, tokenSymbols);
+        writeTokenModel(probFile, model);
+        freeTokenModel(model);
+    }
+    else if (pflag)
     {
         float *prob = calculateProbabilities(sampleFile);
         writeProbabilities(probFile, prob);
         free(prob);
     }
+    if (qflag)
+    {
+        float *prob = sampleProbabilities(sampleFile, chunks);
+        writeProbabilities(probFile, prob);
+        if (rflag)
+            printSampleCost(sampleFile, prob);
+        free(prob);
+    }
+    if (cflag)
+    {
+        unsigned long long *count = transforms.count > 0 ? countTransformedFile(countSample, &transforms)
+                                                         : calculateCounts(countSample);
+        writeCounts(countFile, count);
+        free(count);
+    }
+    if (mflag)
+        mergeCountFiles(mergeOutput, mergeFiles, mergeCount);
     if (sflag)
     {
-        float *a = readProbabilities(probFile);
-        HuffmanTree *tree = createHuffmanTree(a);
-        char **codes = createHuffmanTable(tree);
+        CodecModel *model = loadCodecModel(probFile);
         printf("Printing codes for all visible characters:\n");
         for (int i = 32; i < ASCII_SIZE - 1; i++)
-            printf("%c:\t%s\n", i, codes[i]);
-        writeCodes(codes);
-        free(a);
-        freeHuffmanTree(tree);
-        freeHuffmanTable(codes);
+            printf("%c:\t%s\n", i, model->codes[i]);
+        writeCodes(model->codes);
+        freeCodecModel(model);
     }
+    if (gflag)
+        generateModelSource(probFile, sourceFile);
     if (eflag)
     {
-        float *a = readProbabilities(probFile);
-        HuffmanTree *tree = createHuffmanTree(a);
-        char **codes = createHuffmanTable(tree);
-        encodeFile(dataFile, encodedFile, codes);
-        free(a);
-        freeHuffmanTree(tree);
-        freeHuffmanTable(codes);
+        if (serverSocket != NULL)
+            requestFromServer(serverSocket, 'e', backend, &transforms, probFile, dataFile, encodedFile);
+        else if (isTokenModelFile(probFile))
+        {
+            if (transforms.count > 0)
+            {
+                printf("Error: A token model cannot be used with -x\n");
+                return EXIT_FAILURE;
+            }
+            TokenModel *model = readTokenModel(probFile);
+            tokenEncodeFile(model, dataFile, encodedFile);
+            freeTokenModel(model);
+        }
+        else
+        {
+            CodecModel *model = loadCodecModel(probFile);
+            codecEncodeFile(model, backend, &transforms, dataFile, encodedFile);
+            freeCodecModel(model);
+        }
     }
+    if (iflag)
+        codecTrainEncodeFile(backend, &transforms, trainInput, trainOutput);
     if (dflag)
     {
-        float *a = readProbabilities(probFile);
-        HuffmanTree *tree = createHuffmanTree(a);
-        decodeFile(encodedFile, decodedFile, tree);
-        free(a);
-        freeHuffmanTree(tree);
+        if (serverSocket != NULL)
+            requestFromServer(serverSocket, 'd', backend, &transforms, probFile, encodedFile, decodedFile);
+        else if (isTokenModelFile(probFile))
+        {
+            TokenModel *model = readTokenModel(probFile);
+            tokenDecodeFile(model, encodedFile, decodedFile);
+            freeTokenModel(model);
+        }
+        else
+        {
+            CodecModel *model = loadCodecModel(probFile);
+            codecDecodeFile(model, encodedFile, decodedFile);
+            freeCodecModel(model);
+        }
+    }
+    if (bflag)
+        packLegacyFile(legacyFile, packedFile);
+    if (tflag)
+        codecAppendFile(appendInput, appendFile);
+    if (fflag)
+    {
+        CodecModel *model = loadCodecModel(probFile);
+        searchEncodedFile(model, searchFile, pattern, oflag);
+        freeCodecModel(model);
+    }
+    if (archiveFile != NULL)
+    {
+        if (isTokenModelFile(probFile))
+        {
+            printf("Error: A token model cannot be used with -z\n");
+            return EXIT_FAILURE;
+        }
+        CodecModel *model = loadCodecModel(probFile);
+        createArchive(archiveFile, model, backend, &transforms, archiveMembers, archiveMemberCount);
+        freeCodecModel(model);
+    }
+    if (listFile != NULL)
+        listArchive(listFile);
+    if (extractFile != NULL)
+        extractArchive(extractFile, extractDirectory);
+    if (memberFile != NULL)
+        extractArchiveMember(memberFile, memberName, memberOutput);
+    if (verifyFile != NULL)
+        verifyEncodedFile(verifyFile);
+    if (fitnessFile != NULL)
+    {
+        if (isTokenModelFile(probFile))
+        {
+            printf("Error: A token model cannot be used with -h\n");
+            return EXIT_FAILURE;
+        }
+        CodecModel *model = loadCodecModel(probFile);
+        analyzeModelFitness(model, backend, fitnessFile, fitnessThreshold);
+        freeCodecModel(model);
     }
-    printf("\n");
+    if (countersFile != NULL)
+        printTraceCounters(countersFile);
+    if (lflag)
+        runServer(listenSocket, serverModels, serverModelCount);
+    if (!fflag)
+        printf("\n");
 
     return 0;
 }
\ No newline at end of file
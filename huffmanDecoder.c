@@ -1,6 +1,8 @@
 #include "huffmanDecoder.h"
 
 #ifdef DEBUG_HUFFMAN_DECODER
+#include "codecModel.h"
+
 int main(int argc, char *argv[])
 {
     if (argc != 4)
@@ -9,54 +11,238 @@ int main(int argc, char *argv[])
         exit(EXIT_FAILURE);
     }
     printf("Debugging huffmanDecoder.c:\n");
-    printf("Trying to open %s to read probabilities...\n", argv[1]);
-    float *a = readProbabilities(argv[1]);
-    printf("Success!\n");
-    printf("Trying to create huffman tree...\n");
-    HuffmanTree *tree = createHuffmanTree(a);
+    printf("Trying to open %s to read the model...\n", argv[1]);
+    CodecModel *model = loadCodecModel(argv[1]);
     printf("Success!\n");
     printf("Trying to decode %s into %s...\n", argv[2], argv[3]);
-    decodeFile(argv[2], argv[3], tree);
+    codecDecodeFile(model, argv[2], argv[3]);
     printf("Success!\n");
-    free(a);
-    freeHuffmanTree(tree);
+    freeCodecModel(model);
 }
 #endif
 
-void decodeFile(char *inputFile, char *outputFile, HuffmanTree *tree)
+/*fills the entries of the lookup table for all the codes of a subtree*/
+static void fillLookupTable(HuffmanDecodeTable *table, const Node *root, uint32_t code, int length)
 {
-    FILE *input = NULL;
-    // check if file can be opened
-    if ((input = fopen(inputFile, "r")) == NULL)
+    if (root == NULL || length > HUFFMAN_LUT_BITS)
+        return;
+
+    if (root->left == NULL && root->right == NULL)
     {
-        printf("Error: Unable to open %s\n", inputFile);
-        exit(EXIT_FAILURE);
+        // every entry that starts with the code decodes to this leaf
+        uint32_t first = code << (HUFFMAN_LUT_BITS - length);
+        uint32_t count = (uint32_t)1 << (HUFFMAN_LUT_BITS - length);
+        uint32_t i;
+        for (i = first; i < first + count; i++)
+        {
+            table->lut[i].character = root->character;
+            table->lut[i].length = length;
+        }
+        return;
     }
 
-    FILE *output = NULL;
-    // check if file can be opened
-    if ((output = fopen(outputFile, "w")) == NULL)
+    fillLookupTable(table, root->left, code << 1, length + 1);
+    fillLookupTable(table, root->right, (code << 1) | 1, length + 1);
+}
+
+HuffmanDecodeTable *createHuffmanDecodeTable(const HuffmanTree *tree, char **huffmanTable)
+{
+    HuffmanDecodeTable *table = NULL;
+    if ((table = (HuffmanDecodeTable *)calloc(1, sizeof(HuffmanDecodeTable))) == NULL)
     {
-        printf("Error: Unable to open %s\n", outputFile);
+        printf("System out of memory!");
         exit(EXIT_FAILURE);
     }
 
-    char token;
-    Node *start = tree->root;
-    // scan all the numbers from file and convert to characters using huffman tree
-    while ((token = fgetc(input)) != EOF)
+    table->root = tree->root;
+    table->maxCodeLength = maxCodeLength(huffmanTable);
+    fillLookupTable(table, tree->root, 0, 0);
+    return table;
+}
+
+/*decodes a code that is longer than the lookup table by walking the tree, returns -1 if the bits are no code*/
+static int decodeLongCode(const HuffmanDecodeTable *table, BitReader *reader)
+{
+    const Node *node = table->root;
+    while (node != NULL && (node->left != NULL || node->right != NULL))
+    {
+        if (reader->count == 0)
+            refillBits(reader);
+        node = readBits(reader, 1) ? node->right : node->left;
+    }
+
+    return node == NULL ? -1 : node->character;
+}
+
+int decodeHuffmanPayload(const HuffmanDecodeTable *table, const unsigned char *payload, size_t payloadLength,
+                         size_t length, unsigned char *out)
+{
+    const HuffmanLutEntry *lut = table->lut;
+    BitReader reader;
+    initializeBitReader(&reader, payload, payloadLength);
+
+    size_t i;
+    // look up the next bits of the block to find each character
+    for (i = 0; i < length; i++)
     {
-        if (token == '0')
-            start = start->left;
-        if (token == '1')
-            start = start->right;
-        if (start->left == NULL && start->right == NULL)
+        if (reader.count < HUFFMAN_LUT_BITS + 8)
+            refillBits(&reader);
+
+        HuffmanLutEntry entry = lut[peekBits(&reader, HUFFMAN_LUT_BITS)];
+        int c;
+        if (entry.length > 0)
+        {
+            skipBits(&reader, entry.length);
+            c = entry.character;
+        }
+        else if ((c = decodeLongCode(table, &reader)) < 0)
         {
-            fputc(start->character, output);
-            start = tree->root;
+            printf("Error: Invalid block in encoded file\n");
+            return 0;
         }
+
+        // the escape code is followed by the 8 bits of the character
+        if (c == ESCAPE_CHARACTER)
+        {
+            if (reader.count < 8)
+                refillBits(&reader);
+            c = readBits(&reader, 8);
+        }
+        out[i] = c;
     }
+    return 1;
+}
 
-    fclose(input);
-    fclose(output);
-}
\ No newline at end of file
+void freeHuffmanDecodeTable(const HuffmanDecodeTable *table)
+{
+    free((void *)table);
+}
+
+/*The state of the legacy decoder between the blocks of the pipeline*/
+typedef struct
+{
+    HuffmanDecodeTable *table;
+    const Node *start;
+    size_t used;
+    unsigned char bits[PACKED_MAX_PAYLOAD];
+    unsigned char buffer[PIPELINE_BLOCK_SIZE];
+} LegacyDecoderState;
+
+/*decodes packed bits, a code can continue in the next block so the node it reached is kept*/
+static void decodeLegacyBits(LegacyDecoderState *decoder, const unsigned char *bits, size_t bitCount, Pipeline *pipe)
+{
+    const HuffmanLutEntry *lut = decoder->table->lut;
+    const Node *root = decoder->table->root;
+    const Node *start = decoder->start;
+    BitReader reader;
+    initializeBitReader(&reader, bits, (bitCount + 7) / 8);
+
+    size_t left = bitCount, characters = 0;
+    while (left > 0)
+    {
+        if (reader.count < HUFFMAN_LUT_BITS)
+            refillBits(&reader);
+
+        // a whole code is looked up at once, the rest of a code that started in the last block is walked
+        int c = -1;
+        HuffmanLutEntry entry;
+        if (start == root && left >= HUFFMAN_LUT_BITS && (entry = lut[peekBits(&reader, HUFFMAN_LUT_BITS)]).length > 0)
+        {
+            skipBits(&reader, entry.length);
+            left -= entry.length;
+            c = entry.character;
+        }
+        else
+        {
+            start = readBits(&reader, 1) ? start->right : start->left;
+            left--;
+            if (start->left == NULL && start->right == NULL)
+            {
+                c = start->character;
+                start = root;
+            }
+        }
+
+        if (c >= 0)
+        {
+            characters++;
+            decoder->buffer[decoder->used++] = c;
+            if (decoder->used == PIPELINE_BLOCK_SIZE)
+            {
+                writeToPipeline(pipe, decoder->buffer, decoder->used);
+                decoder->used = 0;
+            }
+        }
+    }
+    writeToPipeline(pipe, decoder->buffer, decoder->used);
+    decoder->used = 0;
+    decoder->start = start;
+    TRACE_PROBE2(legacy_block, bitCount, characters);
+    countTraceBlock(characters, bitCount);
+}
+
+static void decodeLegacyBlock(void *state, const unsigned char *data, size_t length, Pipeline *pipe)
+{
+    LegacyDecoderState *decoder = (LegacyDecoderState *)state;
+    // the characters are packed first, so the text is decoded with the lookup table like a binary file
+    size_t bitCount = packLegacyBits(data, length, decoder->bits);
+    decodeLegacyBits(decoder, decoder->bits, bitCount, pipe);
+}
+
+static const unsigned char *decodePackedBlock(void *state, const EncodedSegment *segment, const unsigned char *payload,
+                                             size_t payloadLength, size_t length, Pipeline *pipe)
+{
+    LegacyDecoderState *decoder = (LegacyDecoderState *)state;
+    if (segment->backend != BACKEND_PACKED_LEGACY || segment->transforms.count > 0)
+    {
+        printf("Error: Block was not packed from a text file\n");
+        failPipeline(pipe);
+        return NULL;
+    }
+    size_t bitCount = payloadLength < PACKED_BLOCK_HEADER_SIZE ? 0 : getUint32(payload);
+    if (payloadLength != PACKED_BLOCK_HEADER_SIZE + (bitCount + 7) / 8 || bitCount > length)
+    {
+        printf("Error: Invalid block in encoded file\n");
+        failPipeline(pipe);
+        return NULL;
+    }
+    // the characters of the block are those of the text file, so the decoded ones are written here
+    decodeLegacyBits(decoder, payload + PACKED_BLOCK_HEADER_SIZE, bitCount, pipe);
+    return NULL;
+}
+
+/*creates the decoder of the legacy tree, only its lookup table and its root are needed*/
+static LegacyDecoderState *createLegacyDecoder(const HuffmanTree *tree)
+{
+    LegacyDecoderState *decoder = NULL;
+    if ((decoder = (LegacyDecoderState *)malloc(sizeof(LegacyDecoderState))) == NULL ||
+        (decoder->table = (HuffmanDecodeTable *)calloc(1, sizeof(HuffmanDecodeTable))) == NULL)
+    {
+        printf("System out of memory!");
+        exit(EXIT_FAILURE);
+    }
+
+    decoder->table->root = tree->root;
+    fillLookupTable(decoder->table, tree->root, 0, 0);
+    decoder->start = tree->root;
+    decoder->used = 0;
+    return decoder;
+}
+
+int tryDecodeLegacyFile(char *inputFile, char *outputFile, const HuffmanTree *tree)
+{
+    LegacyDecoderState *decoder = createLegacyDecoder(tree);
+    int done = tryRunPipeline(inputFile, outputFile, decodeLegacyBlock, decoder);
+    freeHuffmanDecodeTable(decoder->table);
+    free(decoder);
+    return done;
+}
+
+int tryDecodePackedLegacyFile(char *inputFile, char *outputFile, const HuffmanTree *tree)
+{
+    LegacyDecoderState *decoder = createLegacyDecoder(tree);
+    int done = tryDecodeBlocks(inputFile, outputFile, decodePackedBlock, PACKED_MAX_PAYLOAD, decoder);
+    freeHuffmanDecodeTable(decoder->table);
+    free(decoder);
+    return done;
+}
@@ -3,11 +3,15 @@
  * @brief Header file for decoding files using the Huffman algorithm.
  *
  * This file contains declarations for functions for decoding a file using the 
- * Huffman algorithm.
+ * Huffman algorithm. Binary encoded files are decoded with a lookup table that finds each code of up to
+ * HUFFMAN_LUT_BITS bits with 1 read, and only the longer codes walk the tree. The text files of the first
+ * versions of the program are packed into bits as they are read and then decoded with a lookup table of their own
+ * tree, the same way as the files that were converted with packLegacyFile.
+ * The file is read, decoded and written using the pipelined I/O engine.
  *
  * @author Spyros Sachmpazidis
  * @bug No know bugs.
- * @version 1.0
+ * @version 1.6
  * @since 23/11/23
  */
 
@@ -16,25 +20,118 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
 #include "huffmanTree.h"
 #include "huffmanTreeCreator.h"
+#include "huffmanTable.h"
+#include "pipeline.h"
+#include "bitStream.h"
+#include "encodedFile.h"
+#include "legacyPacker.h"
+
+/*The number of bits that the lookup table of the decoder reads at once*/
+#define HUFFMAN_LUT_BITS 11
+/*The number of entries in the lookup table of the decoder*/
+#define HUFFMAN_LUT_SIZE (1 << HUFFMAN_LUT_BITS)
+
+/**
+ * @struct HuffmanLutEntry
+ * @brief Represents the code that starts with some HUFFMAN_LUT_BITS bits.
+ *
+ * A length of 0 means that the code is longer than HUFFMAN_LUT_BITS bits.
+ *
+ * @since 1.2
+ */
+typedef struct
+{
+    uint16_t character;
+    uint8_t length;
+} HuffmanLutEntry;
+
+/**
+ * @struct HuffmanDecodeTable
+ * @brief Represents the tables used to decode a binary encoded file.
+ *
+ * The structure contains the lookup table, the root of the tree for the long codes
+ * and the length of the longest code.
+ *
+ * @since 1.2
+ */
+typedef struct
+{
+    HuffmanLutEntry lut[HUFFMAN_LUT_SIZE];
+    const Node *root;
+    int maxCodeLength;
+} HuffmanDecodeTable;
+
+/**
+ * @brief Creates the decode tables of a Huffman tree.
+ *
+ * Every code of up to HUFFMAN_LUT_BITS bits fills all the entries of the lookup table that start with it.
+ *
+ * @param tree Pointer to the Huffman tree.
+ * @param huffmanTable A pointer to a character pointer array representing the Huffman code table of the tree.
+ * @return A pointer to the created tables.
+ * @since 1.2
+ */
+HuffmanDecodeTable *createHuffmanDecodeTable(const HuffmanTree *tree, char **huffmanTable);
 
 /**
- * @brief Decodes a file using the Huffman algorithm and writes the decoded result to another file.
+ * @brief Decodes the payload of 1 block of a binary encoded file into memory.
+ *
+ * This function is used by codecDecodeFile for every block, and can be used by anything else that needs the
+ * characters of a block without writing them to a file.
+ *
+ * @param table Pointer to the decode tables.
+ * @param payload The payload of the block.
+ * @param payloadLength The number of bytes in the payload.
+ * @param length The number of characters that the block encodes.
+ * @param out The buffer that the characters are written to, with room for length characters.
+ * @return 1 if the block was decoded, 0 if its bits are not codes of the table, the error is printed.
+ * @since 1.3
+ */
+int decodeHuffmanPayload(const HuffmanDecodeTable *table, const unsigned char *payload, size_t payloadLength,
+                         size_t length, unsigned char *out);
+
+/**
+ * @brief Decodes a text file of the first versions of the program and writes the decoded result to another file.
  *
  * This function takes an input file that contains a binary sequence of characters that was created using
- * the HUffman algorithm, decodes
- * it using the provided Huffman tree, and writes the decoded result to the
- * specified output file. In order to decode the file, the function starts at the root fo the tree
- * and reads the encoded file character by character. When a 0 is encountered it goes to the left node and when a 1 it goes to the
- * right node. If at any point a leaf node is found, then the character in the leaf node is printed and the algorithm
- * goes back to the tree root. This proccess is continued until the whole file is decoded.
+ * the HUffman algorithm, decodes it using the provided Huffman tree, and writes the decoded result to the
+ * specified output file. Every block of the file is first packed into bits with packLegacyBits, and the codes are
+ * then looked up HUFFMAN_LUT_BITS bits at a time. A code that is longer, or that continues in the next block, is
+ * decoded by walking the tree 1 bit at a time, going to the left node for a 0 and to the right node for a 1.
+ * Characters other than '0' and '1' are skipped. Reading the input, decoding it and writing the output overlap each
+ * other using the pipelined I/O engine.
  *
  * @param inputFile The input file.
  * @param outputFile The output file.
- * @param tree Pointer to the Huffman tree.
- * @since 1.0
+ * @param tree Pointer to the Huffman tree created by createLegacyHuffmanTree.
+ * @return 1 if the file was decoded, 0 if a file could not be opened, read or written, the error is printed.
+ * @since 1.2
+ */
+int tryDecodeLegacyFile(char *inputFile, char *outputFile, const HuffmanTree *tree);
+
+/**
+ * @brief Decodes a file that was converted with packLegacyFile and writes the decoded result to another file.
+ *
+ * The bits of every block are decoded like the characters of the text file it was packed from.
+ *
+ * @param inputFile The converted file.
+ * @param outputFile The output file.
+ * @param tree Pointer to the Huffman tree created by createLegacyHuffmanTree.
+ * @return 1 if the file was decoded, 0 if it is invalid or corrupt or a file could not be opened, read or written,
+ * the errors are printed.
+ * @since 1.4
+ */
+int tryDecodePackedLegacyFile(char *inputFile, char *outputFile, const HuffmanTree *tree);
+
+/**
+ * @brief Frees the memory allocated for the decode tables.
+ *
+ * @param table Pointer to the decode tables.
+ * @since 1.2
  */
-void decodeFile(char *inputFile, char *outputFile, HuffmanTree *tree);
+void freeHuffmanDecodeTable(const HuffmanDecodeTable *table);
 
-#endif
\ No newline at end of file
+#endif
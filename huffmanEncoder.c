@@ -21,7 +21,10 @@ int main(int argc, char *argv[])
     for (int i = 32; i < ASCII_SIZE - 1; i++)
         printf("%c\t%s\n", i, codes[i]);
     printf("Trying to encode %s into %s...\n", argv[2], argv[3]);
-    encodeFile(argv[2], argv[3], codes);
+    EncodedSegment segment;
+    initializeSegment(&segment, BACKEND_HUFFMAN, 0);
+    if (!tryEncodeFile(argv[2], argv[3], codes, &segment))
+        exit(EXIT_FAILURE);
     printf("Success!\n");
     free(a);
     freeHuffmanTree(tree);
@@ -29,32 +32,79 @@ int main(int argc, char *argv[])
 }
 #endif
 
-void encodeFile(char *inputFile, char *outputFile, char **huffmanTable)
+/*writes a code that is too long for one number 1 bit at a time*/
+static void putLongCode(BitWriter *writer, const char *code)
 {
-    FILE *input = NULL;
-    // check if file can be opened
-    if ((input = fopen(inputFile, "r")) == NULL)
+    for (; *code != '\0'; code++)
+        putBits(writer, *code == '1', 1);
+}
+
+size_t encodeHuffmanPayload(const HuffmanEncoder *encoder, const unsigned char *data, size_t length,
+                            unsigned char *payload)
+{
+    BitWriter writer;
+    initializeBitWriter(&writer, payload);
+
+    size_t i;
+    // convert all the characters of the block to huffman codes using huffman table
+    for (i = 0; i < length; i++)
     {
-        printf("Error: Unable to open %s\n", inputFile);
-        exit(EXIT_FAILURE);
+        int codeLength = encoder->lengths[data[i]];
+        if (codeLength <= MAX_PACKED_CODE_LENGTH)
+            putBits(&writer, encoder->bits[data[i]], codeLength);
+        else
+            putLongCode(&writer, encoder->huffmanTable[data[i]]);
     }
 
-    FILE *output = NULL;
-    // check if file can be opened
-    if ((output = fopen(outputFile, "w")) == NULL)
+    return flushBits(&writer) - payload;
+}
+
+static size_t encodeBlock(const void *state, const unsigned char *data, size_t length, unsigned char *payload)
+{
+    return encodeHuffmanPayload((const HuffmanEncoder *)state, data, length, payload);
+}
+
+HuffmanEncoder *createHuffmanEncoder(char **huffmanTable)
+{
+    HuffmanEncoder *encoder = NULL;
+    if ((encoder = (HuffmanEncoder *)malloc(sizeof(HuffmanEncoder))) == NULL)
     {
-        printf("Error: Unable to open %s\n", outputFile);
+        printf("System out of memory!");
         exit(EXIT_FAILURE);
     }
 
-    char token;
-    // scan all the numbers from file and convert to huffman codes using huffman table
-    while ((token = fgetc(input)) != EOF)
+    encoder->huffmanTable = huffmanTable;
+    int i, j;
+    for (i = 0; i < BYTE_SIZE; i++)
     {
-        char *code = huffmanTable[(int)token];
-        fprintf(output, "%s", code);
+        if (huffmanTable[i] == NULL)
+        {
+            printf("Error: Character %d has no code\n", i);
+            exit(EXIT_FAILURE);
+        }
+        encoder->lengths[i] = strlen(huffmanTable[i]);
+        encoder->bits[i] = 0;
+        for (j = 0; j < encoder->lengths[i] && j < MAX_PACKED_CODE_LENGTH; j++)
+            encoder->bits[i] = (encoder->bits[i] << 1) | (huffmanTable[i][j] == '1');
     }
 
-    fclose(input);
-    fclose(output);
-}
\ No newline at end of file
+    return encoder;
+}
+
+int tryEncodeFile(char *inputFile, char *outputFile, char **huffmanTable, const EncodedSegment *segment)
+{
+    HuffmanEncoder *encoder = createHuffmanEncoder(huffmanTable);
+    int done = tryEncodeBlocks(inputFile, outputFile, segment, encodeBlock,
+                               MAX_BLOCK_PAYLOAD(maxCodeLength(huffmanTable)), encoder);
+    free(encoder);
+    return done;
+}
+
+void encodeMemory(const unsigned char *data, size_t length, int stream, char *outputFile, char **huffmanTable,
+                  const EncodedSegment *segment)
+{
+    HuffmanEncoder *encoder = createHuffmanEncoder(huffmanTable);
+    encodeMemoryBlocks(data, length, stream, outputFile, segment, encodeBlock,
+                       MAX_BLOCK_PAYLOAD(maxCodeLength(huffmanTable)), encoder);
+    free(encoder);
+}
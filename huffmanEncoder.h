@@ -4,13 +4,14 @@
  *
  * This file contains declarations for functions for encoding a file using the
  * Huffman algorithm. It encodes a file using a huffman code table that is generated form a huffman tree.
- * Each one of the 128 ASCII characters has a binary code with different length depending on its occurrence probability.
- * Rare characters have longer codes and common ones shorter. The encoded file contains only 1 line that is a binary sequence for all
- * the characters that the input file had.
+ * Each character of the model has a binary code with different length depending on its occurrence probability.
+ * Rare characters have longer codes and common ones shorter, and any other byte is written as the escape code and its
+ * 8 bits. The codes are packed 8 to a byte in the blocks of a binary encoded file.
+ * The file is read, encoded and written using the pipelined I/O engine.
  * 
  * @author Spyros Sachmpazidis
  * @bug No know bugs.
- * @version 1.0
+ * @version 1.6
  * @since 20/11/23
  */
 
@@ -19,23 +20,88 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
 #include "huffmanTreeCreator.h"
 #include "huffmanTable.h"
+#include "pipeline.h"
+#include "bitStream.h"
+#include "encodedFile.h"
 
+/*The longest code that is kept as a number, longer codes are written from their string*/
+#define MAX_PACKED_CODE_LENGTH 56
+
+/**
+ * @struct HuffmanEncoder
+ * @brief Represents the codes of the huffman table as numbers, so that each one is written with 1 call.
+ *
+ * @since 1.5
+ */
+typedef struct
+{
+    char **huffmanTable;
+    uint64_t bits[BYTE_SIZE];
+    int lengths[BYTE_SIZE];
+} HuffmanEncoder;
+
+/**
+ * @brief Packs every code of a huffman table into a number.
+ *
+ * The program stops if a character has no code. The encoder is freed with free.
+ *
+ * @param huffmanTable  A pointer to a character pointer array representing the Huffman code table.
+ * @return A pointer to the new encoder.
+ * @since 1.5
+ */
+HuffmanEncoder *createHuffmanEncoder(char **huffmanTable);
+
+/**
+ * @brief Encodes 1 block into the payload of a block of a binary encoded file.
+ *
+ * This function is used by tryEncodeFile for every block, and can be used by anything else that writes the payload
+ * of a block itself.
+ *
+ * @param encoder Pointer to the encoder.
+ * @param data The characters of the block.
+ * @param length The number of characters.
+ * @param payload The buffer that the codes are written to, with room for MAX_BLOCK_PAYLOAD of the longest code.
+ * @return The number of bytes written to the payload.
+ * @since 1.5
+ */
+size_t encodeHuffmanPayload(const HuffmanEncoder *encoder, const unsigned char *data, size_t length,
+                            unsigned char *payload);
 
 /**
  * @brief Encodes a file using the Huffman algorithm and writes the encoded result to another file.
  *
  * This function takes an input file, encodes its content using the provided codes from the Huffman table
  * that were generated using a huffman tree, and writes the encoded result to
- * the specified output file. The encoded file contains only 1 line that is a binary sequence of the codes for
- * each character found in the input file.
+ * the specified output file. Every block of the input file becomes a block of a binary encoded file with the
+ * codes of its characters packed into bits, the first bit of a code being the highest unused bit of a byte.
+ * Reading the input, encoding it and writing the output overlap each other using the pipelined I/O engine.
  *
  * @param inputFile The input file.
  * @param outputFile The output file.
  * @param huffmanTable  A pointer to a character pointer array representing the Huffman code table.
+ * @param segment The segment that the encoded blocks belong to, its backend must be BACKEND_HUFFMAN.
+ * @return 1 if the file was encoded, 0 if a file could not be opened, read or written, the error is printed.
  * @since 1.0
  */
-void encodeFile(char *inputFile, char *outputFile, char **huffmanTable);
+int tryEncodeFile(char *inputFile, char *outputFile, char **huffmanTable, const EncodedSegment *segment);
+
+/**
+ * @brief Encodes a buffer that is in memory using the Huffman algorithm and writes a new binary encoded file.
+ *
+ * The blocks are encoded like the blocks of tryEncodeFile, only the output is written in the background.
+ *
+ * @param data The buffer.
+ * @param length The number of bytes in the buffer.
+ * @param stream 1 if the buffer is a memory mapping that is read ahead and let go of a window at a time.
+ * @param outputFile The output file.
+ * @param huffmanTable  A pointer to a character pointer array representing the Huffman code table.
+ * @param segment The segment that the encoded blocks belong to, its backend must be BACKEND_HUFFMAN.
+ * @since 1.4
+ */
+void encodeMemory(const unsigned char *data, size_t length, int stream, char *outputFile, char **huffmanTable,
+                  const EncodedSegment *segment);
 
 #endif
\ No newline at end of file
@@ -28,27 +28,48 @@ int main(int argc, char *argv[])
 }
 #endif
 
-char **createHuffmanTable(HuffmanTree *tree)
+char **createHuffmanTable(const HuffmanTree *tree)
 {
     char **codes = NULL;
-    if ((codes = (char **)malloc(ASCII_SIZE * sizeof(char *))) == NULL)
+    if ((codes = (char **)calloc(HUFFMAN_TABLE_SIZE, sizeof(char *))) == NULL)
     {
         printf("System out of memory!");
         exit(EXIT_FAILURE);
     }
 
     createHuffmanCodes(tree->root, codes, "");
+
+    // the bytes without a leaf are encoded as the escape code and their 8 bits
+    int i, j;
+    if (codes[ESCAPE_CHARACTER] != NULL)
+    {
+        size_t escapeLength = strlen(codes[ESCAPE_CHARACTER]);
+        for (i = 0; i < BYTE_SIZE; i++)
+        {
+            if (codes[i] != NULL)
+                continue;
+            if ((codes[i] = (char *)malloc(escapeLength + 9)) == NULL)
+            {
+                printf("System out of memory!");
+                exit(EXIT_FAILURE);
+            }
+            strcpy(codes[i], codes[ESCAPE_CHARACTER]);
+            for (j = 0; j < 8; j++)
+                codes[i][escapeLength + j] = (i >> (7 - j)) & 1 ? '1' : '0';
+            codes[i][escapeLength + 8] = '\0';
+        }
+    }
     return codes;
 }
 
-int createHuffmanCodes(Node *root, char **codes, char *code)
+int createHuffmanCodes(const Node *root, char **codes, char *code)
 {
     if (root == NULL)
         return 0;
 
     if (root->left == NULL && root->right == NULL)
     {
-        codes[(int)root->character] = code;
+        codes[root->character] = code;
         return 1;
     }
 
@@ -88,8 +109,29 @@ void writeCodes(char **huffmanTable)
 void freeHuffmanTable(char **codes)
 {
     int i;
-    for (i = 0; i < ASCII_SIZE; i++)
+    for (i = 0; i < HUFFMAN_TABLE_SIZE; i++)
         free(codes[i]);
 
     free(codes);
+}
+
+float averageCodeLength(float *charProb, char **huffmanTable)
+{
+    float bits = 0;
+    int i;
+    for (i = 0; i < ASCII_SIZE; i++)
+        bits += charProb[i] * strlen(huffmanTable[i]);
+
+    return bits;
+}
+
+int maxCodeLength(char **huffmanTable)
+{
+    int longest = 0;
+    int i;
+    for (i = 0; i < HUFFMAN_TABLE_SIZE; i++)
+        if (huffmanTable[i] != NULL && (int)strlen(huffmanTable[i]) > longest)
+            longest = strlen(huffmanTable[i]);
+
+    return longest;
 }
\ No newline at end of file
@@ -9,11 +9,12 @@
  * This file contains declarations for functions for creating Huffman
  * code tables from Huffman trees. A binary code is generated for all 128 ASCII
  * characters depending on their occurrence probability. Characters that are common have shorter codes
- * and characters that rae uncommon have longer ones.
+ * and characters that rae uncommon have longer ones. Bytes that are not in the tree get the escape code
+ * followed by their own 8 bits, so every byte has a code.
  *
  * @author Spyros Sachmpazidis
  * @bug No know bugs.
- * @version 1.2
+ * @version 1.4
  * @since 22/11/23
  */
 
@@ -29,13 +30,15 @@
  * represented as an array of strings. The functions reads the huffman tree node by node
  * and adds 0 if it goes to the left and 1 if it goes to the right. Using this recursive algorithm 
  * a binary code is generated for all 128 ASCII characters. Common characters have short codes and
- * rare ones have a longer code since they are located deeper in the huffman tree.
+ * rare ones have a longer code since they are located deeper in the huffman tree. The table has HUFFMAN_TABLE_SIZE
+ * codes, 1 for each byte and 1 for the escape leaf. A byte without a leaf gets the escape code and its 8 bits,
+ * unless the tree has no escape leaf, in which case its code is NULL.
  *
  * @param tree Pointer to the Huffman tree.
  * @return A pointer to a character pointer array representing the Huffman code table.
  * @since 1.0
  */
-char **createHuffmanTable(HuffmanTree *tree);
+char **createHuffmanTable(const HuffmanTree *tree);
 
 /**
  * @brief Recursively creates Huffman codes for each character in the tree.
@@ -51,7 +54,7 @@ char **createHuffmanTable(HuffmanTree *tree);
  * @return 1 if a leaf node was found and 0 otherwise.
  * @since 1.1
  */
-int createHuffmanCodes(Node *root, char **codes, char *code);
+int createHuffmanCodes(const Node *root, char **codes, char *code);
 
 /**
  * @brief Writes Huffman codes to an output file.
@@ -74,4 +77,29 @@ void writeCodes(char **huffmanTable);
  */
 void freeHuffmanTable(char **codes);
 
+/**
+ * @brief Calculates the average code length of a Huffman table.
+ *
+ * This function calculates the average number of bits that the Huffman table spends
+ * for each character of a text, when the characters of that text occur with the given probabilities.
+ * It can be used to compare how well different tables fit the same text.
+ *
+ * @param charProb a pointer to a float array of probabilities for each character of the text.
+ * @param huffmanTable A pointer to a character pointer array representing the Huffman code table.
+ * @return The average number of bits for each character.
+ * @since 1.3
+ */
+float averageCodeLength(float *charProb, char **huffmanTable);
+
+/**
+ * @brief Finds the length of the longest code of a Huffman table.
+ *
+ * The codes of the bytes without a leaf are counted with their 8 extra bits.
+ *
+ * @param huffmanTable A pointer to a character pointer array representing the Huffman code table.
+ * @return The number of bits of the longest code.
+ * @since 1.4
+ */
+int maxCodeLength(char **huffmanTable);
+
 #endif
\ No newline at end of file
@@ -7,7 +7,7 @@
  *
  *  @author Spyros Sachmpazidis
  *  @bug No know bugs.
- *  @version 1.0
+ *  @version 1.2
  *  @since 21/11/23
  */
 
@@ -19,35 +19,44 @@
 #define ASCII_SIZE 128
 #endif
 
+/*The number of different bytes, any byte of a file can be encoded*/
+#define BYTE_SIZE 256
+/*The character of the escape leaf, a character that is not in the model is encoded as the escape code and its 8 bits*/
+#define ESCAPE_CHARACTER BYTE_SIZE
+/*The number of codes in a huffman table, 1 for each byte and 1 for the escape code*/
+#define HUFFMAN_TABLE_SIZE (BYTE_SIZE + 1)
+
 /**
  * @struct Node
  * @brief Represents a node in a Huffman tree.
  *
  * The node structure contains the character and pointers
- * to the left and right child nodes.
+ * to the left and right child nodes. The character of a leaf is
+ * either a byte or ESCAPE_CHARACTER.
  * 
  * @since 1.0
  */
 typedef struct node
 {
-    char character;
-    struct node *left;
-    struct node *right;
+    int character;
+    const struct node *left;
+    const struct node *right;
 } Node;
 
 /**
  * @struct HuffmanTree
  * @brief Represents a Huffman tree.
  *
- * The HuffmanTree structure contains the probability of the
- * tree and a pointer to the root of the tree.
+ * The HuffmanTree structure contains the weight of the
+ * tree and a pointer to the root of the tree. The weight is the probability
+ * or the count of all the characters of the tree together.
  * 
  * @since 1.0
  */
 typedef struct
 {
-    float probability;
-    Node *root;
+    double weight;
+    const Node *root;
 } HuffmanTree;
 
 #endif
\ No newline at end of file
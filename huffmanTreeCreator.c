@@ -16,20 +16,28 @@ int main(int argc, char *argv[])
         printf("%c\t%f\n", i, a[i]);
     printf("Trying to create huffman tree...\n");
     HuffmanTree *tree = createHuffmanTree(a);
-    printf("Success!Printing probability of the final tree:\n%f\n", tree->probability);
+    printf("Success!Printing weight of the final tree:\n%f\n", tree->weight);
     free(a);
     freeHuffmanTree(tree);
 }
 #endif
 
 float *readProbabilities(char *inputFile)
+{
+    float *charProb = tryReadProbabilities(inputFile);
+    if (charProb == NULL)
+        exit(EXIT_FAILURE);
+    return charProb;
+}
+
+float *tryReadProbabilities(char *inputFile)
 {
     FILE *fp = NULL;
     // check if file opens correctly
     if ((fp = fopen(inputFile, "r")) == NULL)
     {
         printf("Input file cannot be read!\n");
-        exit(EXIT_FAILURE);
+        return NULL;
     }
 
     float *charProb = NULL;
@@ -39,41 +47,119 @@ float *readProbabilities(char *inputFile)
         exit(EXIT_FAILURE);
     }
 
-    float *tp = charProb;
     float token;
+    int i = 0;
+    int result;
     // scan all the numbers from file to fill the table
-    while (fscanf(fp, "%f", &token) != EOF)
+    while ((result = fscanf(fp, "%f", &token)) == 1 && i < ASCII_SIZE)
+        charProb[i++] = token;
+    if (result != EOF)
     {
-        *tp = token;
-        tp++;
+        printf("Error: Invalid probability file %s\n", inputFile);
+        fclose(fp);
+        free(charProb);
+        return NULL;
     }
 
     fclose(fp);
     return charProb;
 }
 
-HuffmanTree *createHuffmanTree(float *charProb)
+double *readModel(char *inputFile, int *exact)
 {
-    HuffmanTree *charTrees = NULL;
-    if ((charTrees = (HuffmanTree *)malloc(ASCII_SIZE * sizeof(HuffmanTree))) == NULL)
+    double *weights = tryReadModel(inputFile, exact);
+    if (weights == NULL)
+        exit(EXIT_FAILURE);
+    return weights;
+}
+
+double *tryReadModel(char *inputFile, int *exact)
+{
+    if ((*exact = tryIsCountFile(inputFile)) < 0)
+        return NULL;
+
+    double *weights = NULL;
+    if ((weights = (double *)malloc(ASCII_SIZE * sizeof(double))) == NULL)
     {
         printf("System out of memory!");
         exit(EXIT_FAILURE);
     }
 
+    int i;
+    if (*exact)
+    {
+        unsigned long long *charCount = tryReadCounts(inputFile);
+        if (charCount == NULL)
+        {
+            free(weights);
+            return NULL;
+        }
+        for (i = 0; i < ASCII_SIZE; i++)
+            weights[i] = charCount[i];
+        free(charCount);
+    }
+    else
+    {
+        float *charProb = tryReadProbabilities(inputFile);
+        if (charProb == NULL)
+        {
+            free(weights);
+            return NULL;
+        }
+        for (i = 0; i < ASCII_SIZE; i++)
+            weights[i] = charProb[i];
+        free(charProb);
+    }
+
+    return weights;
+}
+
+HuffmanTree *createHuffmanTree(float *charProb)
+{
+    double weights[ASCII_SIZE];
     int i;
     for (i = 0; i < ASCII_SIZE; i++)
-        initializeHuffmanTree(&charTrees[i], charProb[i], i);
+        weights[i] = charProb[i];
+
+    return createHuffmanTreeFromWeights(weights, 0);
+}
+
+/*creates a node, the children of a node are never changed after it is created*/
+static Node *createNode(int c, const Node *left, const Node *right)
+{
+    Node *node = NULL;
+    if ((node = (Node *)malloc(sizeof(Node))) == NULL)
+    {
+        printf("System out of memory!");
+        exit(EXIT_FAILURE);
+    }
 
-    int treeCount = ASCII_SIZE;
+    node->character = c;
+    node->left = left;
+    node->right = right;
+    return node;
+}
+
+/*merges the trees 2 at a time, always the 2 with the lowest weight, until only 1 tree is left*/
+static HuffmanTree *mergeAllTrees(HuffmanTree *charTrees, int treeCount, int exact, int legacy)
+{
+    uint64_t start = traceTime();
+    TRACE_PROBE1(tree_start, treeCount);
     while (treeCount > 1)
     {
         HuffmanTree *lowest = findLowestProbability(charTrees, treeCount);
         HuffmanTree *secondLowest = findSecondLowestProbability(charTrees, treeCount);
 
         swapTrees(lowest, &charTrees[treeCount - 2]);
+        // the first swap moves the second lowest tree if it was the second last one, the legacy trees merged the tree
+        // that took its place instead
+        if (!legacy && secondLowest == &charTrees[treeCount - 2])
+            secondLowest = lowest;
         swapTrees(secondLowest, &charTrees[treeCount - 1]);
         mergeTrees(&charTrees[treeCount - 2], &charTrees[treeCount - 1]);
+        // probabilities have always been added as floats
+        if (!exact)
+            charTrees[treeCount - 2].weight = (float)charTrees[treeCount - 2].weight;
 
         treeCount--;
         HuffmanTree *temp = realloc(charTrees, treeCount * sizeof(HuffmanTree));
@@ -86,64 +172,88 @@ HuffmanTree *createHuffmanTree(float *charProb)
         charTrees = temp;
     }
 
+    uint64_t time = traceTime() - start;
+    TRACE_PROBE1(tree_done, time);
+    addTraceCounter(&getTraceCounters()->trees, 1);
+    addTraceCounter(&getTraceCounters()->treeTime, time);
     return charTrees;
 }
 
-void initializeHuffmanTree(HuffmanTree *tree, float prob, char c)
+HuffmanTree *createHuffmanTreeFromWeights(double *weights, int exact)
 {
-    tree->probability = prob;
+    HuffmanTree *charTrees = NULL;
+    if ((charTrees = (HuffmanTree *)malloc((ASCII_SIZE + 1) * sizeof(HuffmanTree))) == NULL)
+    {
+        printf("System out of memory!");
+        exit(EXIT_FAILURE);
+    }
+
+    int treeCount = 0;
+    int i;
+    for (i = 0; i < ASCII_SIZE; i++)
+        if (weights[i] > 0)
+            initializeHuffmanTree(&charTrees[treeCount++], weights[i], i);
+    initializeHuffmanTree(&charTrees[treeCount++], 0, ESCAPE_CHARACTER);
+
+    // a tree with only the escape leaf still needs 1 bit for its code
+    if (treeCount == 1)
+    {
+        charTrees[0].root = createNode(0, charTrees[0].root, NULL);
+        return charTrees;
+    }
+
+    return mergeAllTrees(charTrees, treeCount, exact, 0);
+}
 
-    tree->root = NULL;
-    if ((tree->root = (Node *)malloc(sizeof(Node))) == NULL)
+HuffmanTree *createLegacyHuffmanTree(double *weights, int exact)
+{
+    HuffmanTree *charTrees = NULL;
+    if ((charTrees = (HuffmanTree *)malloc(ASCII_SIZE * sizeof(HuffmanTree))) == NULL)
     {
         printf("System out of memory!");
         exit(EXIT_FAILURE);
     }
 
-    tree->root->character = c;
-    tree->root->left = NULL;
-    tree->root->right = NULL;
+    int i;
+    for (i = 0; i < ASCII_SIZE; i++)
+        initializeHuffmanTree(&charTrees[i], weights[i], i);
+
+    return mergeAllTrees(charTrees, ASCII_SIZE, exact, 1);
+}
+
+void initializeHuffmanTree(HuffmanTree *tree, double weight, int c)
+{
+    tree->weight = weight;
+    tree->root = createNode(c, NULL, NULL);
 }
 
 void swapTrees(HuffmanTree *treeA, HuffmanTree *treeB)
 {
-    float tempProb = treeA->probability;
-    Node *tempRoot = treeA->root;
+    double tempWeight = treeA->weight;
+    const Node *tempRoot = treeA->root;
 
-    treeA->probability = treeB->probability;
+    treeA->weight = treeB->weight;
     treeA->root = treeB->root;
 
-    treeB->probability = tempProb;
+    treeB->weight = tempWeight;
     treeB->root = tempRoot;
 }
 
 void mergeTrees(HuffmanTree *treeA, HuffmanTree *treeB)
 {
-    Node *tempRoot = treeA->root;
-
-    treeA->probability += treeB->probability;
-    treeA->root = NULL;
-    if ((treeA->root = (Node *)malloc(sizeof(Node))) == NULL)
-    {
-        printf("System out of memory!");
-        exit(EXIT_FAILURE);
-    }
-    treeA->root->character = '\0';
-    treeA->root->left = tempRoot;
-    treeA->root->right = treeB->root;
+    treeA->weight += treeB->weight;
+    treeA->root = createNode(0, treeA->root, treeB->root);
 }
 
 HuffmanTree *findLowestProbability(HuffmanTree *trees, int treeCount)
 {
-    float min = 1;
-    HuffmanTree *minTree = NULL;
+    HuffmanTree *minTree = &trees[0];
 
     int i;
-    for (i = 0; i < treeCount; i++)
+    for (i = 1; i < treeCount; i++)
     {
-        if (trees[i].probability < min)
+        if (trees[i].weight < minTree->weight)
         {
-            min = trees[i].probability;
             minTree = &trees[i];
         }
     }
@@ -154,15 +264,13 @@ HuffmanTree *findLowestProbability(HuffmanTree *trees, int treeCount)
 HuffmanTree *findSecondLowestProbability(HuffmanTree *trees, int treeCount)
 {
     HuffmanTree *lowestTree = findLowestProbability(trees, treeCount);
-    float min = 1;
     HuffmanTree *minTree = NULL;
 
     int i;
     for (i = 0; i < treeCount; i++)
     {
-        if (trees[i].probability < min && &trees[i] != lowestTree)
+        if (&trees[i] != lowestTree && (minTree == NULL || trees[i].weight < minTree->weight))
         {
-            min = trees[i].probability;
             minTree = &trees[i];
         }
     }
@@ -170,13 +278,13 @@ HuffmanTree *findSecondLowestProbability(HuffmanTree *trees, int treeCount)
     return minTree;
 }
 
-void freeHuffmanTree(HuffmanTree *tree)
+void freeHuffmanTree(const HuffmanTree *tree)
 {
     freeTree(tree->root);
-    free(tree);
+    free((void *)tree);
 }
 
-void freeTree(Node *root)
+void freeTree(const Node *root)
 {
     if (root == NULL)
         return;
@@ -184,5 +292,5 @@ void freeTree(Node *root)
     freeTree(root->left);
     freeTree(root->right);
 
-    free(root);
+    free((void *)root);
 }
\ No newline at end of file
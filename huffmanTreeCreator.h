@@ -6,11 +6,18 @@
  * of occurrence for each one of the 128 ASCII characters. The program uses the Huffman
  * algorithm to create a specific binary tree, were the deeper you go the lower the probability for those characters
  * to appear. Basically common characters are found first and uncommon ones later. This tree can later bee used to
- * encode a text file.
+ * encode a text file. The tree can also be created from the exact counts of each character, which are read from
+ * a count file. Only the characters that occur in the model get a leaf, every other byte is encoded with an
+ * escape code followed by the 8 bits of the byte, which keeps the tree as small as the real alphabet. Building a
+ * tree fires the tree_start and tree_done tracepoints and is added to the counters of traceProbes.h.
+ *
+ * Until version 1.7 the trees were merged in the wrong pairs whenever the second lightest tree was the second last one
+ * in the array, which gave codes longer than they should be. The text files of the first versions were encoded with
+ * those trees, so the legacy tree is still merged in the old pairs to decode them.
  *
  *  @author Spyros Sachmpazidis
  *  @bug No know bugs.
- *  @version 1.3
+ *  @version 1.9
  *  @since 20/11/23
  */
 
@@ -20,12 +27,15 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include "huffmanTree.h"
+#include "characterCounts.h"
+#include "traceProbes.h"
 
 /** @brief Reads a file that has the probabilities for each character
  *
  *  This function reads character probabilities for all 128 ASCII characters from the specified input file and
  *  returns a pointer to a float array of probabilities for each character. The file must only contain
- *  one float per line that is the probability of that specific character occurring. 
+ *  one float per line that is the probability of that specific character occurring. The program stops
+ *  if the file has more than 128 probabilities or something that is not a number.
  *
  *  @param inputFile the name of the input file(including .txt)
  *  @return a pointer to a float array that is contains the probabilities
@@ -33,6 +43,42 @@
  */
 float *readProbabilities(char *inputFile);
 
+/** @brief Reads a file that has the probabilities for each character without stopping the program
+ *
+ *  This function works like readProbabilities, but prints the error and returns NULL if the file cannot be read
+ *  or is not a valid probability file.
+ *
+ *  @param inputFile the name of the input file(including .txt)
+ *  @return a pointer to a float array that is contains the probabilities, or NULL
+ *  @since 1.8
+ */
+float *tryReadProbabilities(char *inputFile);
+
+/** @brief Reads a model file that has either probabilities or counts
+ *
+ *  This function checks if the file is a count file. If it is, the exact count of each character is read,
+ *  otherwise the file is read as a probability file. Either way the values are returned as the weights
+ *  that are used to create a huffman tree.
+ *
+ *  @param inputFile the name of the model file(including .txt)
+ *  @param exact set to 1 if the weights are exact counts and to 0 if they are probabilities
+ *  @return a pointer to a double array that contains the weight of each character
+ *  @since 1.4
+ */
+double *readModel(char *inputFile, int *exact);
+
+/** @brief Reads a model file that has either probabilities or counts without stopping the program
+ *
+ *  This function works like readModel, but prints the error and returns NULL if the file cannot be read or is
+ *  not a valid model file. It is used to reload models in a program that must keep running.
+ *
+ *  @param inputFile the name of the model file(including .txt)
+ *  @param exact set to 1 if the weights are exact counts and to 0 if they are probabilities
+ *  @return a pointer to a double array that contains the weight of each character, or NULL
+ *  @since 1.8
+ */
+double *tryReadModel(char *inputFile, int *exact);
+
 /**
  * @brief Creates a Huffman tree based on character probabilities
  *
@@ -49,19 +95,47 @@ float *readProbabilities(char *inputFile);
 HuffmanTree *createHuffmanTree(float *charProb);
 
 /**
- * @brief Initializes a Huffman tree with a character and probability.
+ * @brief Creates a Huffman tree based on the weight of each character
+ *
+ * This function is used by createHuffmanTree and createCodecModel to create the tree.
+ * The weight of a character can be either its probability or its count. Counts are added exactly, while
+ * probabilities are added with float precision. Characters with 0 weight do not get a leaf, instead the tree has
+ * 1 escape leaf with 0 weight that is used for all of them.
+ *
+ * @param weights a pointer to a double array with the weight of each character.
+ * @param exact 1 if the weights are exact counts and 0 if they are probabilities.
+ * @return A pointer to the created Huffman tree.
+ * @since 1.4
+ */
+HuffmanTree *createHuffmanTreeFromWeights(double *weights, int exact);
+
+/**
+ * @brief Creates the Huffman tree that the first versions of the program used
+ *
+ * This function creates a tree with a leaf for every one of the 128 characters, even those with 0 weight,
+ * and no escape leaf, merged in the old pairs. It is only needed to decode the text files that those versions created.
+ *
+ * @param weights a pointer to a double array with the weight of each character.
+ * @param exact 1 if the weights are exact counts and 0 if they are probabilities.
+ * @return A pointer to the created Huffman tree.
+ * @since 1.5
+ */
+HuffmanTree *createLegacyHuffmanTree(double *weights, int exact);
+
+/**
+ * @brief Initializes a Huffman tree with a character and weight.
  *
  * This function initializes a Huffman tree with the specified character and
- * probability. It is used to create the huffman tree for all characters, since
+ * weight. It is used to create the huffman tree for all characters, since
  * all characters must first be placed in a separate huffman tree and then the trees are merged 
  * depending on their probability into 1 bug tree containing all characters.
  *
  * @param tree Pointer to the Huffman tree to initialize.
- * @param prob Probability of the character.
+ * @param weight Probability or count of the character.
  * @param c Character represented by the tree.
  * @since 1.1
  */
-void initializeHuffmanTree(HuffmanTree *tree, float prob, char c);
+void initializeHuffmanTree(HuffmanTree *tree, double weight, int c);
 
 /**
  * @brief Swaps two Huffman trees.
@@ -122,7 +196,7 @@ HuffmanTree *findSecondLowestProbability(HuffmanTree *trees, int treeCount);
  * @param tree Pointer to  the Huffman tree.
  * @since 1.3
  */
-void freeHuffmanTree(HuffmanTree *tree);
+void freeHuffmanTree(const HuffmanTree *tree);
 
 /**
  * @brief Frees the memory allocated for all Huffman tree nodes recursively.
@@ -133,6 +207,6 @@ void freeHuffmanTree(HuffmanTree *tree);
  * @param root Pointer to node of the Huffman tree that will be freed.
  * @since 1.3
  */
-void freeTree(Node *root);
+void freeTree(const Node *root);
 
 #endif
\ No newline at end of file
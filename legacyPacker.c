@@ -0,0 +1,122 @@
+#include "legacyPacker.h"
+
+#ifdef HAVE_SSE2_PACKER
+#include <emmintrin.h>
+#endif
+
+#ifdef DEBUG_LEGACY_PACKER
+int main(int argc, char *argv[])
+{
+    if (argc != 3)
+    {
+        printf("Correct files not given!\n");
+        exit(EXIT_FAILURE);
+    }
+    printf("Debugging legacyPacker.c:\n");
+#ifdef HAVE_SSE2_PACKER
+    printf("Packing with SSE2\n");
+#else
+    printf("Packing without SIMD\n");
+#endif
+    printf("Trying to pack %s into %s...\n", argv[1], argv[2]);
+    packLegacyFile(argv[1], argv[2]);
+    printf("Success!\n");
+}
+#endif
+
+/*packs the characters 1 at a time, skipping the ones that are not '0' or '1'*/
+static size_t packCharacters(const unsigned char *text, size_t length, BitWriter *writer)
+{
+    size_t bits = 0, i;
+    for (i = 0; i < length; i++)
+        if (text[i] == '0' || text[i] == '1')
+        {
+            putBits(writer, text[i] - '0', 1);
+            bits++;
+        }
+    return bits;
+}
+
+#ifdef HAVE_SSE2_PACKER
+/*the mask has the first character in its lowest bit, but the first character is written first*/
+static uint32_t reverse16(uint32_t mask)
+{
+    mask = ((mask >> 1) & 0x5555) | ((mask & 0x5555) << 1);
+    mask = ((mask >> 2) & 0x3333) | ((mask & 0x3333) << 2);
+    mask = ((mask >> 4) & 0x0F0F) | ((mask & 0x0F0F) << 4);
+    return ((mask >> 8) & 0x00FF) | ((mask & 0x00FF) << 8);
+}
+#endif
+
+size_t packLegacyBits(const unsigned char *text, size_t length, unsigned char *out)
+{
+    BitWriter writer;
+    initializeBitWriter(&writer, out);
+    size_t bits = 0, i = 0;
+
+#ifdef HAVE_SSE2_PACKER
+    const __m128i zeros = _mm_set1_epi8('0');
+    const __m128i ones = _mm_set1_epi8('1');
+    for (; i + 16 <= length; i += 16)
+    {
+        __m128i chunk = _mm_loadu_si128((const __m128i *)(text + i));
+        uint32_t one = _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, ones));
+        uint32_t zero = _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, zeros));
+        // a chunk with any other character is packed 1 character at a time
+        if ((one | zero) != 0xFFFF)
+        {
+            bits += packCharacters(text + i, 16, &writer);
+            continue;
+        }
+        putBits(&writer, reverse16(one), 16);
+        bits += 16;
+    }
+#else
+    for (; i + 8 <= length; i += 8)
+    {
+        uint32_t byte = 0;
+        int valid = 1;
+        int k;
+        for (k = 0; k < 8; k++)
+        {
+            valid &= text[i + k] == '0' || text[i + k] == '1';
+            byte = (byte << 1) | (text[i + k] & 1);
+        }
+        if (!valid)
+        {
+            bits += packCharacters(text + i, 8, &writer);
+            continue;
+        }
+        putBits(&writer, byte, 8);
+        bits += 8;
+    }
+#endif
+
+    bits += packCharacters(text + i, length - i, &writer);
+    flushBits(&writer);
+    return bits;
+}
+
+static size_t packLegacyBlock(const void *state, const unsigned char *data, size_t length, unsigned char *payload)
+{
+    (void)state;
+    size_t bits = packLegacyBits(data, length, payload + PACKED_BLOCK_HEADER_SIZE);
+    putUint32(payload, bits);
+    return PACKED_BLOCK_HEADER_SIZE + (bits + 7) / 8;
+}
+
+void packLegacyFile(char *inputFile, char *outputFile)
+{
+    int backend = readEncodedBackend(inputFile);
+    if (backend == BACKEND_UNREADABLE)
+        exit(EXIT_FAILURE);
+    if (backend != BACKEND_LEGACY)
+    {
+        printf("Error: %s is already a binary encoded file\n", inputFile);
+        exit(EXIT_FAILURE);
+    }
+
+    EncodedSegment segment;
+    initializeSegment(&segment, BACKEND_PACKED_LEGACY, 0);
+    encodeBlocks(inputFile, outputFile, &segment, packLegacyBlock, PACKED_MAX_PAYLOAD, NULL);
+}
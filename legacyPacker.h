@@ -0,0 +1,67 @@
+/**
+ * @file legacyPacker.h
+ * @brief Header file for packing the text files of the first versions of the program into bits.
+ *
+ * This file contains declarations for functions for converting the '0' and '1' text files of the first versions
+ * of the program into binary encoded files. The codes in these files do not start at the start of a block, so they
+ * cannot be changed into the codes of the other coders without decoding them. Instead, every character of the text
+ * file is packed into 1 bit, and the packed blocks are decoded with the same tree as the text file. Nothing is
+ * decoded while packing, so a file is converted about as fast as it can be read, and the converted file is 8 times
+ * smaller.
+ *
+ * Characters are packed 16 at a time with SSE2, by comparing them with '0' and '1' and gathering the results into
+ * 1 mask each. Without SSE2, or with -DNO_SIMD, 8 characters are packed at a time by shifting their lowest bits.
+ * Any other character, such as a new line that was added to a text file, is skipped like the text decoder does.
+ *
+ * @author Spyros Sachmpazidis
+ * @bug No know bugs.
+ * @version 1.0
+ * @since 19/10/26
+ */
+
+#ifndef LEGACY_PACKER_H
+#define LEGACY_PACKER_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "encodedFile.h"
+#include "bitStream.h"
+
+#if defined(__SSE2__) && !defined(NO_SIMD)
+#define HAVE_SSE2_PACKER 1
+#endif
+
+/*The size of the header of a packed block, the number of bits in it*/
+#define PACKED_BLOCK_HEADER_SIZE 4
+/*The largest payload of a packed block, every character of the text file is 1 bit*/
+#define PACKED_MAX_PAYLOAD (PACKED_BLOCK_HEADER_SIZE + PIPELINE_BLOCK_SIZE / 8 + 8)
+
+/**
+ * @brief Packs the '0' and '1' characters of a text file into bits.
+ *
+ * The first character is the highest bit of the first byte, like in the other binary encoded files, and the last
+ * byte is filled with 0.
+ *
+ * @param text The characters of the text file.
+ * @param length The number of characters.
+ * @param out The buffer that the bits are written to, with room for length / 8 + 8 bytes.
+ * @return The number of bits that were written.
+ * @since 1.0
+ */
+size_t packLegacyBits(const unsigned char *text, size_t length, unsigned char *out);
+
+/**
+ * @brief Converts a text file of the first versions of the program into a binary encoded file.
+ *
+ * The program stops if the input file is already a binary encoded file. The converted file is decoded with -d and
+ * the same probfile as the text file.
+ *
+ * @param inputFile The text file.
+ * @param outputFile The binary encoded file.
+ * @since 1.0
+ */
+void packLegacyFile(char *inputFile, char *outputFile);
+
+#endif
@@ -0,0 +1,248 @@
+#include "modelFitness.h"
+
+/*The number of bytes that are read and counted at a time*/
+#define FITNESS_BUFFER_SIZE (1 << 16)
+
+/*A character of the report and the bits that the model loses on it*/
+typedef struct
+{
+    int character;
+    double lostBits;
+} FitnessSymbol;
+
+#ifdef DEBUG_MODEL_FITNESS
+int main(int argc, char *argv[])
+{
+    if (argc != 3)
+    {
+        printf("Correct files not given!\n");
+        exit(EXIT_FAILURE);
+    }
+    printf("Debugging modelFitness.c:\n");
+    printf("Trying to measure %s against %s...\n", argv[1], argv[2]);
+    CodecModel *model = loadCodecModel(argv[1]);
+    analyzeModelFitness(model, BACKEND_HUFFMAN, argv[2], FITNESS_DEFAULT_THRESHOLD);
+    analyzeModelFitness(model, BACKEND_TANS, argv[2], FITNESS_DEFAULT_THRESHOLD);
+    freeCodecModel(model);
+    printf("Trying to measure a model trained on %s against it...\n", argv[2]);
+    // a model trained on the file itself cannot be improved by retraining, so any saving over 0% is an error
+    unsigned long long *counts = countFileBytes(argv[2]);
+    double *weights = NULL;
+    if ((weights = (double *)malloc(ASCII_SIZE * sizeof(double))) == NULL)
+    {
+        printf("System out of memory!");
+        exit(EXIT_FAILURE);
+    }
+    int c;
+    for (c = 0; c < ASCII_SIZE; c++)
+        weights[c] = counts[c];
+    free(counts);
+    CodecModel *trained = createCodecModel(weights, 1);
+    if (analyzeModelFitness(trained, BACKEND_HUFFMAN, argv[2], 0) != 0 ||
+        analyzeModelFitness(trained, BACKEND_TANS, argv[2], 0) != 0)
+    {
+        printf("Error: The trained model should not need retraining\n");
+        exit(EXIT_FAILURE);
+    }
+    freeCodecModel(trained);
+    printf("Success!\n");
+}
+#endif
+
+unsigned long long *countFileBytes(char *inputFile)
+{
+    FILE *fp = NULL;
+    if ((fp = fopen(inputFile, "rb")) == NULL)
+    {
+        printf("Error: Unable to open %s\n", inputFile);
+        exit(EXIT_FAILURE);
+    }
+
+    unsigned long long *counts = NULL;
+    unsigned char *buffer = NULL;
+    if ((counts = (unsigned long long *)calloc(BYTE_SIZE, sizeof(unsigned long long))) == NULL ||
+        (buffer = (unsigned char *)malloc(FITNESS_BUFFER_SIZE)) == NULL)
+    {
+        printf("System out of memory!");
+        exit(EXIT_FAILURE);
+    }
+
+    // 4 histograms, so a run of the same character does not wait on 1 counter
+    uint32_t histograms[4][BYTE_SIZE];
+    memset(histograms, 0, sizeof(histograms));
+    size_t n, i;
+    int c;
+    while ((n = fread(buffer, 1, FITNESS_BUFFER_SIZE, fp)) > 0)
+    {
+        for (i = 0; i + 4 <= n; i += 4)
+        {
+            histograms[0][buffer[i]]++;
+            histograms[1][buffer[i + 1]]++;
+            histograms[2][buffer[i + 2]]++;
+            histograms[3][buffer[i + 3]]++;
+        }
+        for (; i < n; i++)
+            histograms[0][buffer[i]]++;
+        // the histograms are emptied after every buffer, so they never overflow
+        for (c = 0; c < BYTE_SIZE; c++)
+            counts[c] += (unsigned long long)histograms[0][c] + histograms[1][c] + histograms[2][c] + histograms[3][c];
+        memset(histograms, 0, sizeof(histograms));
+    }
+
+    fclose(fp);
+    free(buffer);
+    return counts;
+}
+
+/*finds the bits of every byte with the coder, characters that are not in the model cost their escape and 8 bits*/
+static void characterBits(CodecModel *model, int backend, double *bits)
+{
+    int c;
+    if (backend == BACKEND_HUFFMAN)
+    {
+        for (c = 0; c < BYTE_SIZE; c++)
+            bits[c] = strlen(model->codes[c]);
+        return;
+    }
+
+    const int *frequency = getTansTable(model)->frequency;
+    for (c = 0; c < BYTE_SIZE; c++)
+    {
+        int symbol = c < ASCII_SIZE && frequency[c] > 0 ? c : TANS_ESCAPE;
+        bits[c] = log2((double)TANS_TABLE_SIZE / frequency[symbol]) + (symbol == TANS_ESCAPE ? 8 : 0);
+    }
+}
+
+/*the bits that the coder spends on all the counted characters*/
+static double totalBits(const unsigned long long *counts, const double *bits)
+{
+    double total = 0;
+    int c;
+    for (c = 0; c < BYTE_SIZE; c++)
+        total += counts[c] * bits[c];
+    return total;
+}
+
+static int compareLostBits(const void *a, const void *b)
+{
+    double x = ((const FitnessSymbol *)a)->lostBits, y = ((const FitnessSymbol *)b)->lostBits;
+    return (x < y) - (x > y);
+}
+
+/*prints the report of 1 model and returns 1 if it should be retrained*/
+static int printFitness(CodecModel *model, int backend, const unsigned long long *counts, CodecModel *trained,
+                        double threshold)
+{
+    unsigned long long characters = 0;
+    int c;
+    for (c = 0; c < BYTE_SIZE; c++)
+        characters += counts[c];
+
+    double bits[BYTE_SIZE], trainedBits[BYTE_SIZE];
+    characterBits(model, backend, bits);
+    characterBits(trained, backend, trainedBits);
+
+    // the characters are listed from the one the model loses the most bits on
+    FitnessSymbol symbols[BYTE_SIZE];
+    int symbolCount = 0;
+    double entropy = 0;
+    for (c = 0; c < BYTE_SIZE; c++)
+        if (counts[c] > 0)
+        {
+            double ideal = -log2((double)counts[c] / characters);
+            entropy += counts[c] * ideal;
+            symbols[symbolCount].character = c;
+            symbols[symbolCount++].lostBits = counts[c] * (bits[c] - ideal);
+        }
+    qsort(symbols, symbolCount, sizeof(FitnessSymbol), compareLostBits);
+
+    printf("Character\tCount\tModel bits\tIdeal bits\tLost bits\n");
+    int i;
+    for (i = 0; i < symbolCount; i++)
+    {
+        c = symbols[i].character;
+        if (c < ASCII_SIZE && isgraph(c))
+            printf("'%c'", c);
+        else
+            printf("%d", c);
+        printf("\t\t%llu\t%f\t%f\t%.0f\n", counts[c], bits[c], -log2((double)counts[c] / characters),
+               symbols[i].lostBits);
+    }
+
+    // the divergence of the probfile from the file, infinite if the file has characters that the model does not have
+    double weightTotal = 0, divergence = 0;
+    unsigned long long missing = 0;
+    for (c = 0; c < ASCII_SIZE; c++)
+        weightTotal += model->weights[c];
+    for (c = 0; c < BYTE_SIZE; c++)
+        if (counts[c] > 0)
+        {
+            if (c >= ASCII_SIZE || model->weights[c] <= 0)
+                missing += counts[c];
+            else
+                divergence += (double)counts[c] / characters *
+                              log2((double)counts[c] / characters / (model->weights[c] / weightTotal));
+        }
+
+    double modelTotal = totalBits(counts, bits), trainedTotal = totalBits(counts, trainedBits);
+    double saving = modelTotal > 0 ? 100 * (modelTotal - trainedTotal) / modelTotal : 0;
+    entropy /= characters;
+    printf("Characters:\t%llu\n", characters);
+    printf("Entropy:\t%f bits per character\n", entropy);
+    printf("Model:\t\t%f bits per character\n", modelTotal / characters);
+    printf("Overhead:\t%f bits per character, %f%% over the entropy\n", modelTotal / characters - entropy,
+           entropy > 0 ? 100 * (modelTotal / characters - entropy) / entropy : 0);
+    if (missing > 0)
+        printf("Divergence:\tinfinite, %llu characters are not in the model\n", missing);
+    else
+        printf("Divergence:\t%f bits per character\n", divergence);
+    printf("Retrained:\t%f bits per character, %f%% smaller\n", trainedTotal / characters, saving);
+
+    int retrain = saving > threshold;
+    printf("%s\t%f%% %s the threshold of %f%%\n", retrain ? FITNESS_RETRAIN_LINE : FITNESS_KEEP_LINE, saving,
+           retrain ? "is over" : "is not over", threshold);
+    return retrain;
+}
+
+int analyzeModelFitness(CodecModel *model, int backend, char *inputFile, double threshold)
+{
+    unsigned long long *counts = countFileBytes(inputFile);
+    unsigned long long characters = 0;
+    int c;
+    for (c = 0; c < BYTE_SIZE; c++)
+        characters += counts[c];
+    if (characters == 0)
+    {
+        printf("%s is empty, every model fits it\n", inputFile);
+        free(counts);
+        return 0;
+    }
+
+    // the model that retraining the probfile on this file would give
+    double *weights = NULL;
+    if ((weights = (double *)malloc(ASCII_SIZE * sizeof(double))) == NULL)
+    {
+        printf("System out of memory!");
+        exit(EXIT_FAILURE);
+    }
+    for (c = 0; c < ASCII_SIZE; c++)
+        weights[c] = counts[c];
+    CodecModel *trained = createCodecModel(weights, 1);
+
+    int retrain = 0;
+    if (model->library == NULL)
+        retrain = printFitness(model, backend, counts, trained, threshold);
+    else
+    {
+        int i;
+        for (i = 0; i < model->library->count; i++)
+        {
+            printf("Model %d of the library:\n", i);
+            retrain += printFitness(model->library->models[i], backend, counts, trained, threshold);
+        }
+    }
+
+    freeCodecModel(trained);
+    free(counts);
+    return retrain;
+}
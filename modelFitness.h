@@ -0,0 +1,67 @@
+/**
+ * @file modelFitness.h
+ * @brief Header file for measuring how well a model fits a file.
+ *
+ * This file contains declarations for functions for finding how many bits a model spends on a file compared to the
+ * fewest bits the file can be coded in. A probfile that was trained on older data still encodes new files, but every
+ * character that became more or less common since costs more bits than it should, and nothing reports it. The
+ * characters of the file are counted once into 4 histograms, so the counts of the same character do not wait for each
+ * other, and everything else is computed from the counts and the bits of each character in the model, without
+ * encoding anything.
+ *
+ * For every character the report has the bits the model spends on it, the ideal bits for its frequency in the file
+ * and how many bits are lost on it in total. It then has the entropy of the file, the overhead of the model over it,
+ * the Kullback-Leibler divergence of the probfile from the file and the bits of a model trained on the file itself,
+ * which is what retraining the probfile would give. When retraining would save more than a threshold, the report
+ * says so in a line that scripts can look for.
+ *
+ * @author Spyros Sachmpazidis
+ * @bug No know bugs.
+ * @version 1.0
+ * @since 19/10/26
+ */
+
+#ifndef MODEL_FITNESS_H
+#define MODEL_FITNESS_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <math.h>
+#include "codecModel.h"
+#include "codecLibrary.h"
+
+/*The percent of the encoded size that retraining must save to be recommended when no threshold is given*/
+#define FITNESS_DEFAULT_THRESHOLD 1.0
+/*The line that the report starts with when retraining is recommended*/
+#define FITNESS_RETRAIN_LINE "Retrain:\tyes"
+/*The line that the report starts with when the model still fits*/
+#define FITNESS_KEEP_LINE "Retrain:\tno"
+
+/**
+ * @brief Counts every byte of a file.
+ *
+ * @param inputFile The input file.
+ * @return A pointer to an array with the count of each of the BYTE_SIZE bytes, the caller frees it.
+ * @since 1.0
+ */
+unsigned long long *countFileBytes(char *inputFile);
+
+/**
+ * @brief Prints how well a model fits a file.
+ *
+ * The bits of every character are those of the coder, the length of its huffman code or the bits of its frequency in
+ * the tans tables, and characters that are not in the model cost their escape and their 8 bits. If the model has a
+ * library every model of the library is reported.
+ *
+ * @param model Pointer to the model.
+ * @param backend The coder to measure, either BACKEND_HUFFMAN or BACKEND_TANS.
+ * @param inputFile The input file.
+ * @param threshold The percent of the encoded size that retraining must save to be recommended.
+ * @return The number of models that should be retrained.
+ * @since 1.0
+ */
+int analyzeModelFitness(CodecModel *model, int backend, char *inputFile, double threshold);
+
+#endif
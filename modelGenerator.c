@@ -0,0 +1,136 @@
+#include "modelGenerator.h"
+
+#ifdef DEBUG_MODEL_GENERATOR
+int main(int argc, char *argv[])
+{
+    if (argc != 3)
+    {
+        printf("Correct files not given!\n");
+        exit(EXIT_FAILURE);
+    }
+    printf("Debugging modelGenerator.c:\n");
+    printf("Trying to generate %s from %s...\n", argv[2], argv[1]);
+    generateModelSource(argv[1], argv[2]);
+    printf("Success!\n");
+}
+#endif
+
+/*adds all the nodes of the tree to the array in preorder and returns the new number of nodes*/
+static int collectNodes(const Node *root, const Node **nodes, int count)
+{
+    if (root == NULL)
+        return count;
+
+    nodes[count++] = root;
+    count = collectNodes(root->left, nodes, count);
+    return collectNodes(root->right, nodes, count);
+}
+
+/*finds the position of a node in the array, -1 for NULL*/
+static int findNode(const Node **nodes, int count, const Node *node)
+{
+    int i;
+    for (i = 0; i < count; i++)
+        if (nodes[i] == node)
+            return i;
+
+    return -1;
+}
+
+static void writeNodePointer(FILE *fp, const Node **nodes, int count, const Node *node)
+{
+    int index = findNode(nodes, count, node);
+    if (index < 0)
+        fprintf(fp, "NULL");
+    else
+        fprintf(fp, "&bakedNodes[%d]", index);
+}
+
+static void writeTansTable(FILE *fp, const TansTable *table)
+{
+    int i;
+    fprintf(fp, "static const TansTable bakedTansTable = {\n    {");
+    for (i = 0; i < TANS_ALPHABET_SIZE; i++)
+        fprintf(fp, "%s%d", i % 16 ? ", " : (i ? ",\n     " : ""), table->frequency[i]);
+    fprintf(fp, "},\n    {");
+    for (i = 0; i < TANS_ALPHABET_SIZE; i++)
+        fprintf(fp, "%s{%d, %luu, %d}", i % 4 ? ", " : (i ? ",\n     " : ""),
+                table->symbols[i].maxBits, (unsigned long)table->symbols[i].threshold, table->symbols[i].start);
+    fprintf(fp, "},\n    {");
+    for (i = 0; i < TANS_TABLE_SIZE; i++)
+        fprintf(fp, "%s%d", i % 16 ? ", " : (i ? ",\n     " : ""), table->stateTable[i]);
+    fprintf(fp, "},\n    {");
+    for (i = 0; i < TANS_TABLE_SIZE; i++)
+        fprintf(fp, "%s{%d, %d, %d}", i % 8 ? ", " : (i ? ",\n     " : ""),
+                table->decodeTable[i].newState, table->decodeTable[i].character, table->decodeTable[i].nbBits);
+    fprintf(fp, "}};\n\n");
+}
+
+static void writeDecodeTable(FILE *fp, const HuffmanDecodeTable *table)
+{
+    int i;
+    fprintf(fp, "static const HuffmanDecodeTable bakedDecodeTable = {\n    {");
+    for (i = 0; i < HUFFMAN_LUT_SIZE; i++)
+        fprintf(fp, "%s{%d, %d}", i % 8 ? ", " : (i ? ",\n     " : ""), table->lut[i].character, table->lut[i].length);
+    fprintf(fp, "},\n    &bakedNodes[0], %d};\n\n", table->maxCodeLength);
+}
+
+void generateModelSource(char *probFile, char *outputFile)
+{
+    CodecModel *model = loadCodecModel(probFile);
+
+    // the tree has 1 leaf for each character and the escape and 1 node for each merge
+    const Node *nodes[2 * (ASCII_SIZE + 1)];
+    int count = collectNodes(model->tree->root, nodes, 0);
+    int i;
+
+    FILE *fp = NULL;
+    // check if file can be opened
+    if ((fp = fopen(outputFile, "w")) == NULL)
+    {
+        printf("Error: Unable to open %s\n", outputFile);
+        exit(EXIT_FAILURE);
+    }
+
+    fprintf(fp, "/* Generated by 'huffman -g %s', do not edit. */\n", probFile);
+    fprintf(fp, "#include \"codecModel.h\"\n\n");
+    fprintf(fp, "#define BAKED_NODE_COUNT %d\n\n", count);
+
+    fprintf(fp, "static double bakedWeights[ASCII_SIZE] = {");
+    for (i = 0; i < ASCII_SIZE; i++)
+        fprintf(fp, "%s%.17g", i % 8 ? ", " : (i ? ",\n    " : "\n    "), model->weights[i]);
+    fprintf(fp, "};\n\n");
+
+    fprintf(fp, "static const Node bakedNodes[BAKED_NODE_COUNT] = {\n");
+    for (i = 0; i < count; i++)
+    {
+        fprintf(fp, "    {%d, ", nodes[i]->character);
+        writeNodePointer(fp, nodes, count, nodes[i]->left);
+        fprintf(fp, ", ");
+        writeNodePointer(fp, nodes, count, nodes[i]->right);
+        fprintf(fp, "}%s\n", i + 1 < count ? "," : "");
+    }
+    fprintf(fp, "};\n\n");
+    fprintf(fp, "static const HuffmanTree bakedTree = {%.17g, &bakedNodes[0]};\n\n", model->tree->weight);
+
+    fprintf(fp, "static char *bakedCodes[HUFFMAN_TABLE_SIZE] = {");
+    for (i = 0; i < HUFFMAN_TABLE_SIZE; i++)
+        fprintf(fp, "%s\"%s\"", i % 4 ? ", " : (i ? ",\n    " : "\n    "), model->codes[i]);
+    fprintf(fp, "};\n\n");
+
+    writeDecodeTable(fp, getHuffmanDecodeTable(model));
+    writeTansTable(fp, getTansTable(model));
+
+    // the legacy tree is only needed for old text files, so it is still created when it is first used
+    fprintf(fp, "CodecModel bakedModel = {\n");
+    fprintf(fp, "    .weights = bakedWeights,\n");
+    fprintf(fp, "    .exact = %d,\n", model->exact);
+    fprintf(fp, "    .tree = &bakedTree,\n");
+    fprintf(fp, "    .codes = bakedCodes,\n");
+    fprintf(fp, "    .decodeTable = &bakedDecodeTable,\n");
+    fprintf(fp, "    .tansTable = &bakedTansTable,\n");
+    fprintf(fp, "    .baked = 1};\n");
+
+    fclose(fp);
+    freeCodecModel(model);
+}
@@ -0,0 +1,39 @@
+/**
+ * @file modelGenerator.h
+ * @brief Header file for generating C source code of a fixed model.
+ *
+ * This file contains declarations for functions for baking a model into the program. A model that
+ * never changes does not need to be read and turned into tables every time the program starts, so
+ * the tables are written as initialized C arrays and compiled together with the rest of the program.
+ * The huffman tree is written as an array of nodes that point to each other, so the tree and table
+ * are ready the moment the program starts. 'make baked MODEL=<probfile>' builds a program with a baked model.
+ *
+ * @author Spyros Sachmpazidis
+ * @bug No know bugs.
+ * @version 1.3
+ * @since 19/10/26
+ */
+
+#ifndef MODEL_GENERATOR_H
+#define MODEL_GENERATOR_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "codecModel.h"
+
+/**
+ * @brief Writes the C source code of a model.
+ *
+ * This function loads the model from the probfile and writes a C source file that defines
+ * the bakedModel variable, with the weights, huffman tree, huffman table, huffman decode tables and tans tables
+ * of the model as initialized arrays. The tree, the decode tables and the tans tables are static const, the model
+ * points to them through its const fields. The weights and the huffman table are plain arrays like those of a loaded
+ * model. bakedModel is written with designated initializers, so it does not depend on the order of the fields.
+ *
+ * @param probFile the name of the probability or count file(including .txt)
+ * @param outputFile the name of the C source file to create
+ * @since 1.0
+ */
+void generateModelSource(char *probFile, char *outputFile);
+
+#endif
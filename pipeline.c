@@ -0,0 +1,750 @@
+#include "pipeline.h"
+
+/*A block of a ring buffer*/
+typedef struct
+{
+    unsigned char *data;
+    size_t length;
+    size_t done;
+    off_t offset;
+    int busy;
+    int writing;
+} Block;
+
+/*A bounded ring of blocks shared between a producer and a consumer*/
+typedef struct
+{
+    Block blocks[PIPELINE_RING_SLOTS];
+    int head;
+    int tail;
+    int count;
+    int finished;
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+} Ring;
+
+#ifdef HAVE_IO_URING
+/*The memory mapped submission and completion queues of an io_uring instance*/
+typedef struct
+{
+    int fd;
+    unsigned *sqTail;
+    unsigned *sqMask;
+    unsigned *sqArray;
+    unsigned *cqHead;
+    unsigned *cqTail;
+    unsigned *cqMask;
+    struct io_uring_sqe *sqes;
+    struct io_uring_cqe *cqes;
+    void *sqRing;
+    void *cqRing;
+    size_t sqRingSize;
+    size_t cqRingSize;
+    size_t sqesSize;
+} Uring;
+#endif
+
+struct pipeline
+{
+    int inputFd;
+    int outputFd;
+    off_t inputOffset;
+    off_t outputOffset;
+    int useUring;
+    int failed;
+    Ring input;
+    Ring output;
+    Block *current;
+#ifdef HAVE_IO_URING
+    Uring uring;
+    int currentIndex;
+    int inflight;
+    off_t inputSize;
+    off_t nextRead;
+    off_t nextWrite;
+#endif
+};
+
+#ifdef DEBUG_PIPELINE
+static void copyCoder(void *state, const unsigned char *data, size_t length, Pipeline *pipe)
+{
+    *(size_t *)state += length;
+    writeToPipeline(pipe, data, length);
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc != 3)
+    {
+        printf("Correct files not given!\n");
+        exit(EXIT_FAILURE);
+    }
+    printf("Debugging pipeline.c:\n");
+    printf("Trying to copy %s into %s...\n", argv[1], argv[2]);
+    size_t total = 0;
+    runPipeline(argv[1], argv[2], copyCoder, &total);
+    printf("Success!Copied %lu bytes\n", (unsigned long)total);
+}
+#endif
+
+static void initializeRing(Ring *ring)
+{
+    unsigned char *memory = NULL;
+    if ((memory = (unsigned char *)malloc(PIPELINE_RING_SLOTS * PIPELINE_BLOCK_SIZE)) == NULL)
+    {
+        printf("System out of memory!");
+        exit(EXIT_FAILURE);
+    }
+
+    int i;
+    for (i = 0; i < PIPELINE_RING_SLOTS; i++)
+    {
+        ring->blocks[i].data = memory + (size_t)i * PIPELINE_BLOCK_SIZE;
+        ring->blocks[i].length = 0;
+        ring->blocks[i].done = 0;
+        ring->blocks[i].offset = 0;
+        ring->blocks[i].busy = 0;
+        ring->blocks[i].writing = 0;
+    }
+    ring->head = 0;
+    ring->tail = 0;
+    ring->count = 0;
+    ring->finished = 0;
+    pthread_mutex_init(&ring->lock, NULL);
+    pthread_cond_init(&ring->changed, NULL);
+}
+
+static void freeRing(Ring *ring)
+{
+    free(ring->blocks[0].data);
+    pthread_mutex_destroy(&ring->lock);
+    pthread_cond_destroy(&ring->changed);
+}
+
+/*waits until the producer has a free block to fill*/
+static Block *acquireBlock(Ring *ring)
+{
+    pthread_mutex_lock(&ring->lock);
+    while (ring->count == PIPELINE_RING_SLOTS)
+        pthread_cond_wait(&ring->changed, &ring->lock);
+    Block *block = &ring->blocks[ring->head];
+    pthread_mutex_unlock(&ring->lock);
+    return block;
+}
+
+/*hands the block returned by acquireBlock to the consumer*/
+static void publishBlock(Ring *ring)
+{
+    pthread_mutex_lock(&ring->lock);
+    ring->head = (ring->head + 1) % PIPELINE_RING_SLOTS;
+    ring->count++;
+    pthread_cond_broadcast(&ring->changed);
+    pthread_mutex_unlock(&ring->lock);
+}
+
+/*tells the consumer that no more blocks will be published*/
+static void finishRing(Ring *ring)
+{
+    pthread_mutex_lock(&ring->lock);
+    ring->finished = 1;
+    pthread_cond_broadcast(&ring->changed);
+    pthread_mutex_unlock(&ring->lock);
+}
+
+/*waits for the next published block, returns NULL when the producer has finished*/
+static Block *takeBlock(Ring *ring)
+{
+    pthread_mutex_lock(&ring->lock);
+    while (ring->count == 0 && !ring->finished)
+        pthread_cond_wait(&ring->changed, &ring->lock);
+    Block *block = ring->count > 0 ? &ring->blocks[ring->tail] : NULL;
+    pthread_mutex_unlock(&ring->lock);
+    return block;
+}
+
+/*gives the block returned by takeBlock back to the producer*/
+static void releaseBlock(Ring *ring)
+{
+    pthread_mutex_lock(&ring->lock);
+    ring->tail = (ring->tail + 1) % PIPELINE_RING_SLOTS;
+    ring->count--;
+    pthread_cond_broadcast(&ring->changed);
+    pthread_mutex_unlock(&ring->lock);
+}
+
+/*adds the time the coder waited for the input since start*/
+static void countReadStall(uint64_t start)
+{
+    uint64_t time = traceTime() - start;
+    TRACE_PROBE1(read_stall, time);
+    addTraceCounter(&getTraceCounters()->readStall, time);
+}
+
+/*adds the time the coder waited for the output since start*/
+static void countWriteStall(uint64_t start)
+{
+    uint64_t time = traceTime() - start;
+    TRACE_PROBE1(write_stall, time);
+    addTraceCounter(&getTraceCounters()->writeStall, time);
+}
+
+static void *readerThread(void *arg)
+{
+    Pipeline *pipe = (Pipeline *)arg;
+    for (;;)
+    {
+        // nothing more is read once the pipeline has failed
+        Block *block = acquireBlock(&pipe->input);
+        if (hasPipelineFailed(pipe))
+            break;
+        // fill the whole block unless the end of the file is found
+        block->length = 0;
+        while (block->length < PIPELINE_BLOCK_SIZE)
+        {
+            ssize_t n = read(pipe->inputFd, block->data + block->length, PIPELINE_BLOCK_SIZE - block->length);
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n < 0)
+            {
+                printf("Error: Unable to read input file\n");
+                failPipeline(pipe);
+                block->length = 0;
+            }
+            if (n <= 0)
+                break;
+            block->length += n;
+        }
+        if (block->length == 0)
+            break;
+        publishBlock(&pipe->input);
+    }
+    finishRing(&pipe->input);
+    return NULL;
+}
+
+static void *writerThread(void *arg)
+{
+    Pipeline *pipe = (Pipeline *)arg;
+    Block *block;
+    // after a failure the blocks are still taken, so the coder never waits for a block that is not written
+    while ((block = takeBlock(&pipe->output)) != NULL)
+    {
+        size_t written = 0;
+        while (written < block->length && !hasPipelineFailed(pipe))
+        {
+            ssize_t n = write(pipe->outputFd, block->data + written, block->length - written);
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n < 0)
+            {
+                printf("Error: Unable to write output file\n");
+                failPipeline(pipe);
+                break;
+            }
+            written += n;
+        }
+        releaseBlock(&pipe->output);
+    }
+    return NULL;
+}
+
+static void runThreaded(Pipeline *pipe, PipelineCoder coder, void *state)
+{
+    pthread_t reader;
+    pthread_t writer;
+    if (pthread_create(&reader, NULL, readerThread, pipe) != 0 ||
+        pthread_create(&writer, NULL, writerThread, pipe) != 0)
+    {
+        printf("Error: Unable to start pipeline threads\n");
+        exit(EXIT_FAILURE);
+    }
+
+    pipe->current = acquireBlock(&pipe->output);
+    pipe->current->length = 0;
+
+    for (;;)
+    {
+        uint64_t start = traceTime();
+        Block *block = takeBlock(&pipe->input);
+        countReadStall(start);
+        if (block == NULL)
+            break;
+        // after a failure the blocks are only given back, until the reader finds the failure and stops
+        if (!hasPipelineFailed(pipe))
+            coder(state, block->data, block->length, pipe);
+        releaseBlock(&pipe->input);
+    }
+
+    if (pipe->current->length > 0)
+        publishBlock(&pipe->output);
+    finishRing(&pipe->output);
+
+    pthread_join(reader, NULL);
+    uint64_t start = traceTime();
+    pthread_join(writer, NULL);
+    countWriteStall(start);
+}
+
+#ifdef HAVE_IO_URING
+/*checks that the kernel has the read and write requests, they are newer than io_uring itself*/
+static int supportsReadWrite(int fd)
+{
+    struct io_uring_probe *probe = NULL;
+    size_t size = sizeof(struct io_uring_probe) + PIPELINE_PROBE_OPS * sizeof(struct io_uring_probe_op);
+    if ((probe = (struct io_uring_probe *)calloc(1, size)) == NULL)
+    {
+        printf("System out of memory!");
+        exit(EXIT_FAILURE);
+    }
+
+    // kernels without the probe do not have the requests either
+    int supported = syscall(__NR_io_uring_register, fd, IORING_REGISTER_PROBE, probe, PIPELINE_PROBE_OPS) == 0 &&
+                    probe->ops_len > IORING_OP_READ && probe->ops_len > IORING_OP_WRITE &&
+                    (probe->ops[IORING_OP_READ].flags & IO_URING_OP_SUPPORTED) &&
+                    (probe->ops[IORING_OP_WRITE].flags & IO_URING_OP_SUPPORTED);
+    free(probe);
+    return supported;
+}
+
+static int setupUring(Uring *ring, unsigned entries)
+{
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    ring->fd = (int)syscall(__NR_io_uring_setup, entries, &params);
+    if (ring->fd < 0)
+        return 0;
+    if (!supportsReadWrite(ring->fd))
+    {
+        close(ring->fd);
+        return 0;
+    }
+
+    ring->sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    ring->cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    if (params.features & IORING_FEAT_SINGLE_MMAP)
+    {
+        if (ring->cqRingSize > ring->sqRingSize)
+            ring->sqRingSize = ring->cqRingSize;
+        ring->cqRingSize = ring->sqRingSize;
+    }
+    ring->sqesSize = params.sq_entries * sizeof(struct io_uring_sqe);
+
+    ring->sqRing = mmap(NULL, ring->sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQ_RING);
+    if (ring->sqRing == MAP_FAILED)
+    {
+        close(ring->fd);
+        return 0;
+    }
+    if (params.features & IORING_FEAT_SINGLE_MMAP)
+        ring->cqRing = ring->sqRing;
+    else
+    {
+        ring->cqRing = mmap(NULL, ring->cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_CQ_RING);
+        if (ring->cqRing == MAP_FAILED)
+        {
+            munmap(ring->sqRing, ring->sqRingSize);
+            close(ring->fd);
+            return 0;
+        }
+    }
+    ring->sqes = mmap(NULL, ring->sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQES);
+    if (ring->sqes == MAP_FAILED)
+    {
+        if (ring->cqRing != ring->sqRing)
+            munmap(ring->cqRing, ring->cqRingSize);
+        munmap(ring->sqRing, ring->sqRingSize);
+        close(ring->fd);
+        return 0;
+    }
+
+    char *sq = (char *)ring->sqRing;
+    char *cq = (char *)ring->cqRing;
+    ring->sqTail = (unsigned *)(sq + params.sq_off.tail);
+    ring->sqMask = (unsigned *)(sq + params.sq_off.ring_mask);
+    ring->sqArray = (unsigned *)(sq + params.sq_off.array);
+    ring->cqHead = (unsigned *)(cq + params.cq_off.head);
+    ring->cqTail = (unsigned *)(cq + params.cq_off.tail);
+    ring->cqMask = (unsigned *)(cq + params.cq_off.ring_mask);
+    ring->cqes = (struct io_uring_cqe *)(cq + params.cq_off.cqes);
+    return 1;
+}
+
+static void freeUring(Uring *ring)
+{
+    munmap(ring->sqes, ring->sqesSize);
+    if (ring->cqRing != ring->sqRing)
+        munmap(ring->cqRing, ring->cqRingSize);
+    munmap(ring->sqRing, ring->sqRingSize);
+    close(ring->fd);
+}
+
+/*submits a read or a write for the part of the block that is not done yet*/
+static void submitBlock(Pipeline *pipe, Block *block)
+{
+    Uring *ring = &pipe->uring;
+    unsigned tail = *ring->sqTail;
+    unsigned index = tail & *ring->sqMask;
+    struct io_uring_sqe *sqe = &ring->sqes[index];
+
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = block->writing ? IORING_OP_WRITE : IORING_OP_READ;
+    sqe->fd = block->writing ? pipe->outputFd : pipe->inputFd;
+    sqe->off = block->offset + block->done;
+    sqe->addr = (unsigned long)(block->data + block->done);
+    sqe->len = block->length - block->done;
+    sqe->user_data = (unsigned long)block;
+    ring->sqArray[index] = index;
+    __atomic_store_n(ring->sqTail, tail + 1, __ATOMIC_RELEASE);
+
+    block->busy = 1;
+    while (syscall(__NR_io_uring_enter, ring->fd, 1, 0, 0, NULL, 0) < 0)
+    {
+        if (errno != EINTR && errno != EAGAIN)
+        {
+            printf("Error: Unable to submit I/O request\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+}
+
+/*waits for at least one request to complete and updates its block*/
+static void reapCompletion(Pipeline *pipe)
+{
+    Uring *ring = &pipe->uring;
+    unsigned head = *ring->cqHead;
+    while (head == __atomic_load_n(ring->cqTail, __ATOMIC_ACQUIRE))
+    {
+        if (syscall(__NR_io_uring_enter, ring->fd, 0, 1, IORING_ENTER_GETEVENTS, NULL, 0) < 0 && errno != EINTR)
+        {
+            printf("Error: Unable to wait for I/O request\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    struct io_uring_cqe *cqe = &ring->cqes[head & *ring->cqMask];
+    Block *block = (Block *)(unsigned long)cqe->user_data;
+    int result = cqe->res;
+    __atomic_store_n(ring->cqHead, head + 1, __ATOMIC_RELEASE);
+
+    if (result == -EINTR || result == -EAGAIN)
+    {
+        submitBlock(pipe, block);
+        return;
+    }
+    if (result < 0)
+    {
+        printf("Error: Unable to %s file\n", block->writing ? "write output" : "read input");
+        failPipeline(pipe);
+        result = 0;
+        block->length = block->done;
+    }
+
+    block->done += result;
+    // the input file got shorter while it was being read
+    if (result == 0 && !block->writing)
+        block->length = block->done;
+    if (block->done < block->length && !hasPipelineFailed(pipe))
+    {
+        submitBlock(pipe, block);
+        return;
+    }
+    block->busy = 0;
+    if (block->writing)
+        pipe->inflight--;
+}
+
+/*starts reading the next block of the input file, returns 0 if the whole file has been requested*/
+static int readNextBlock(Pipeline *pipe, Block *block)
+{
+    if (pipe->nextRead >= pipe->inputSize || hasPipelineFailed(pipe))
+    {
+        block->length = 0;
+        return 0;
+    }
+    block->offset = pipe->nextRead;
+    block->length = PIPELINE_BLOCK_SIZE;
+    if (pipe->inputSize - pipe->nextRead < PIPELINE_BLOCK_SIZE)
+        block->length = pipe->inputSize - pipe->nextRead;
+    block->done = 0;
+    block->writing = 0;
+    pipe->nextRead += block->length;
+    submitBlock(pipe, block);
+    return 1;
+}
+
+/*starts writing the current output block and moves to the next one*/
+static void writeCurrentBlock(Pipeline *pipe)
+{
+    Block *block = pipe->current;
+    block->offset = pipe->nextWrite;
+    block->done = 0;
+    block->writing = 1;
+    pipe->nextWrite += block->length;
+    pipe->inflight++;
+    submitBlock(pipe, block);
+
+    pipe->currentIndex = (pipe->currentIndex + 1) % PIPELINE_RING_SLOTS;
+    pipe->current = &pipe->output.blocks[pipe->currentIndex];
+    uint64_t start = traceTime();
+    while (pipe->current->busy)
+        reapCompletion(pipe);
+    countWriteStall(start);
+    pipe->current->length = 0;
+}
+
+static void runUring(Pipeline *pipe, PipelineCoder coder, void *state)
+{
+    pipe->nextRead = pipe->inputOffset;
+    pipe->nextWrite = pipe->outputOffset;
+    pipe->inflight = 0;
+    pipe->currentIndex = 0;
+    pipe->current = &pipe->output.blocks[0];
+    pipe->current->length = 0;
+
+    int i;
+    for (i = 0; i < PIPELINE_RING_SLOTS; i++)
+        readNextBlock(pipe, &pipe->input.blocks[i]);
+
+    // the blocks are read in order, so they are also coded in order around the ring
+    for (i = 0;; i = (i + 1) % PIPELINE_RING_SLOTS)
+    {
+        Block *block = &pipe->input.blocks[i];
+        uint64_t start = traceTime();
+        while (block->busy)
+            reapCompletion(pipe);
+        countReadStall(start);
+        if (block->length == 0 || hasPipelineFailed(pipe))
+            break;
+        coder(state, block->data, block->length, pipe);
+        readNextBlock(pipe, block);
+    }
+
+    if (pipe->current->length > 0 && !hasPipelineFailed(pipe))
+        writeCurrentBlock(pipe);
+    uint64_t start = traceTime();
+    while (pipe->inflight > 0)
+        reapCompletion(pipe);
+    countWriteStall(start);
+    // the kernel still writes into the blocks whose reads were running when the pipeline failed
+    for (i = 0; i < PIPELINE_RING_SLOTS; i++)
+        while (pipe->input.blocks[i].busy)
+            reapCompletion(pipe);
+}
+#endif
+
+void runPipeline(char *inputFile, char *outputFile, PipelineCoder coder, void *state)
+{
+    if (!tryRunPipeline(inputFile, outputFile, coder, state))
+        exit(EXIT_FAILURE);
+}
+
+int tryRunPipeline(char *inputFile, char *outputFile, PipelineCoder coder, void *state)
+{
+    return tryRunPipelineFrom(inputFile, 0, outputFile, 0, coder, state);
+}
+
+void runPipelineFrom(char *inputFile, off_t inputOffset, char *outputFile, int append, PipelineCoder coder, void *state)
+{
+    if (!tryRunPipelineFrom(inputFile, inputOffset, outputFile, append, coder, state))
+        exit(EXIT_FAILURE);
+}
+
+int tryRunPipelineFrom(char *inputFile, off_t inputOffset, char *outputFile, int append, PipelineCoder coder,
+                       void *state)
+{
+    Pipeline *pipe = NULL;
+    if ((pipe = (Pipeline *)malloc(sizeof(Pipeline))) == NULL)
+    {
+        printf("System out of memory!");
+        exit(EXIT_FAILURE);
+    }
+
+    // check if files can be opened
+    if ((pipe->inputFd = open(inputFile, O_RDONLY)) < 0)
+    {
+        printf("Error: Unable to open %s\n", inputFile);
+        free(pipe);
+        return 0;
+    }
+    // without an output file everything the coder writes is thrown away
+    if (outputFile == NULL)
+        outputFile = "/dev/null";
+    if ((pipe->outputFd = open(outputFile, append ? O_WRONLY : O_WRONLY | O_CREAT | O_TRUNC, 0644)) < 0)
+    {
+        printf("Error: Unable to open %s\n", outputFile);
+        close(pipe->inputFd);
+        free(pipe);
+        return 0;
+    }
+
+    // O_APPEND is not used, io_uring writes at the offsets it is given and they must not be moved
+    pipe->inputOffset = inputOffset;
+    pipe->outputOffset = 0;
+    if ((inputOffset > 0 && lseek(pipe->inputFd, inputOffset, SEEK_SET) != inputOffset) ||
+        (append && (pipe->outputOffset = lseek(pipe->outputFd, 0, SEEK_END)) < 0))
+    {
+        printf("Error: Unable to seek in %s\n", inputOffset > 0 ? inputFile : outputFile);
+        close(pipe->inputFd);
+        close(pipe->outputFd);
+        free(pipe);
+        return 0;
+    }
+
+    initializeRing(&pipe->input);
+    initializeRing(&pipe->output);
+    pipe->failed = 0;
+    TRACE_PROBE2(pipeline_start, inputOffset, append);
+
+    pipe->useUring = 0;
+#ifdef HAVE_IO_URING
+    // io_uring reads and writes at known offsets, so it is only used for regular files
+    struct stat inputStat;
+    struct stat outputStat;
+    if (fstat(pipe->inputFd, &inputStat) == 0 && S_ISREG(inputStat.st_mode) &&
+        fstat(pipe->outputFd, &outputStat) == 0 && S_ISREG(outputStat.st_mode) &&
+        setupUring(&pipe->uring, 2 * PIPELINE_RING_SLOTS))
+    {
+        pipe->useUring = 1;
+        pipe->inputSize = inputStat.st_size;
+    }
+    if (pipe->useUring)
+    {
+        runUring(pipe, coder, state);
+        freeUring(&pipe->uring);
+    }
+    else
+#endif
+        runThreaded(pipe, coder, state);
+    TRACE_PROBE1(pipeline_done, pipe->useUring);
+
+    close(pipe->inputFd);
+    if (close(pipe->outputFd) != 0 && !pipe->failed)
+    {
+        printf("Error: Unable to write %s\n", outputFile);
+        pipe->failed = 1;
+    }
+    int done = !pipe->failed;
+    freeRing(&pipe->input);
+    freeRing(&pipe->output);
+    free(pipe);
+    return done;
+}
+
+void runPipelineOnMemory(const unsigned char *data, size_t length, int stream, char *outputFile, PipelineCoder coder,
+                         void *state)
+{
+    if (!tryRunPipelineOnMemory(data, length, stream, outputFile, coder, state))
+        exit(EXIT_FAILURE);
+}
+
+int tryRunPipelineOnMemory(const unsigned char *data, size_t length, int stream, char *outputFile,
+                           PipelineCoder coder, void *state)
+{
+    Pipeline *pipe = NULL;
+    if ((pipe = (Pipeline *)malloc(sizeof(Pipeline))) == NULL)
+    {
+        printf("System out of memory!");
+        exit(EXIT_FAILURE);
+    }
+
+    // without an output file everything the coder writes is thrown away
+    if (outputFile == NULL)
+        outputFile = "/dev/null";
+    if ((pipe->outputFd = open(outputFile, O_WRONLY | O_CREAT | O_TRUNC, 0644)) < 0)
+    {
+        printf("Error: Unable to open %s\n", outputFile);
+        free(pipe);
+        return 0;
+    }
+    pipe->inputFd = -1;
+    pipe->useUring = 0;
+    pipe->failed = 0;
+    initializeRing(&pipe->output);
+    TRACE_PROBE2(memory_start, length, stream);
+
+    pthread_t writer;
+    if (pthread_create(&writer, NULL, writerThread, pipe) != 0)
+    {
+        printf("Error: Unable to start pipeline threads\n");
+        exit(EXIT_FAILURE);
+    }
+    pipe->current = acquireBlock(&pipe->output);
+    pipe->current->length = 0;
+
+    size_t offset;
+    for (offset = 0; offset < length && !hasPipelineFailed(pipe); offset += PIPELINE_BLOCK_SIZE)
+    {
+        if (stream && offset % PIPELINE_WINDOW_SIZE == 0)
+        {
+            // the window that was passed is let go of and the next one is read while it is coded
+            if (offset > 0)
+                madvise((void *)(data + offset - PIPELINE_WINDOW_SIZE), PIPELINE_WINDOW_SIZE, MADV_DONTNEED);
+            size_t ahead = length - offset < PIPELINE_WINDOW_SIZE ? length - offset : PIPELINE_WINDOW_SIZE;
+            madvise((void *)(data + offset), ahead, MADV_WILLNEED);
+        }
+        coder(state, data + offset, length - offset < PIPELINE_BLOCK_SIZE ? length - offset : PIPELINE_BLOCK_SIZE, pipe);
+    }
+
+    if (pipe->current->length > 0)
+        publishBlock(&pipe->output);
+    finishRing(&pipe->output);
+    uint64_t start = traceTime();
+    pthread_join(writer, NULL);
+    countWriteStall(start);
+    TRACE_PROBE0(memory_done);
+
+    if (close(pipe->outputFd) != 0 && !pipe->failed)
+    {
+        printf("Error: Unable to write %s\n", outputFile);
+        pipe->failed = 1;
+    }
+    int done = !pipe->failed;
+    freeRing(&pipe->output);
+    free(pipe);
+    return done;
+}
+
+void writeToPipeline(Pipeline *pipe, const void *data, size_t length)
+{
+    // the output of a pipeline that has failed is never written
+    if (hasPipelineFailed(pipe))
+        return;
+    const unsigned char *bytes = (const unsigned char *)data;
+    while (length > 0)
+    {
+        Block *block = pipe->current;
+        size_t space = PIPELINE_BLOCK_SIZE - block->length;
+        size_t n = length < space ? length : space;
+        memcpy(block->data + block->length, bytes, n);
+        block->length += n;
+        bytes += n;
+        length -= n;
+
+        if (block->length == PIPELINE_BLOCK_SIZE)
+        {
+#ifdef HAVE_IO_URING
+            if (pipe->useUring)
+            {
+                writeCurrentBlock(pipe);
+                continue;
+            }
+#endif
+            publishBlock(&pipe->output);
+            uint64_t start = traceTime();
+            pipe->current = acquireBlock(&pipe->output);
+            countWriteStall(start);
+            pipe->current->length = 0;
+        }
+    }
+}
+
+void failPipeline(Pipeline *pipe)
+{
+    // the reader and the writer threads look at the failure while the coder runs
+    __atomic_store_n(&pipe->failed, 1, __ATOMIC_RELAXED);
+}
+
+int hasPipelineFailed(Pipeline *pipe)
+{
+    return __atomic_load_n(&pipe->failed, __ATOMIC_RELAXED);
+}
@@ -0,0 +1,225 @@
+/**
+ * @file pipeline.h
+ * @brief Header file for the pipelined read/code/write I/O engine.
+ *
+ * This file contains declarations for an I/O engine that overlaps reading the input file,
+ * coding its contents and writing the output file. The input is read in fixed size blocks that
+ * are handed to a coder function, and everything the coder produces is collected in output blocks
+ * that are written in the background. The blocks are kept in bounded ring buffers, so the memory used
+ * does not depend on the size of the files.
+ *
+ * When the kernel supports it, the reads and writes are submitted asynchronously through io_uring
+ * and the whole pipeline runs on one thread. The kernel is asked for the read and write requests when the ring is
+ * set up, since the first kernels with io_uring do not have them. Otherwise a reader thread and a writer thread are used,
+ * connected to the coder through the ring buffers. Either way the disk keeps working while the coder
+ * runs, so the total time gets close to the slowest of the three stages instead of their sum. The time the coder
+ * waits for the other two stages is added to the stall counters of traceProbes.h.
+ *
+ * The input can also be a buffer that is already in memory, usually a memory mapping of the input file, so a file
+ * that is read more than once is only read from the disk once. Only the output is then written in the background.
+ *
+ * A file that cannot be opened, read or written, or a coder that finds an error and calls failPipeline, stops the
+ * pipeline without stopping the program. The try functions then return the failure, so a server can go on with its
+ * other requests, and the other functions stop the program.
+ *
+ * @author Spyros Sachmpazidis
+ * @bug No know bugs.
+ * @version 1.6
+ * @since 19/10/26
+ */
+
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include "traceProbes.h"
+
+#if defined(__linux__) && !defined(NO_IO_URING)
+/*io_uring is only used on linux and can be disabled with -DNO_IO_URING*/
+#define HAVE_IO_URING 1
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+/*The number of requests that the kernel is asked about, every request number fits in a byte*/
+#define PIPELINE_PROBE_OPS 256
+#endif
+
+/*The size of each block in the ring buffers*/
+#define PIPELINE_BLOCK_SIZE (1 << 16)
+/*The number of blocks in each ring buffer*/
+#define PIPELINE_RING_SLOTS 8
+/*The part of a memory mapping that is read ahead and then let go of at once when it is streamed*/
+#define PIPELINE_WINDOW_SIZE (64 << 20)
+
+/**
+ * @struct Pipeline
+ * @brief Represents a running read/code/write pipeline.
+ *
+ * The structure is only used through the functions of this file.
+ *
+ * @since 1.0
+ */
+typedef struct pipeline Pipeline;
+
+/**
+ * @brief Coder stage of the pipeline.
+ *
+ * A function of this type is called once for every block of the input file, in order.
+ * It codes the block and passes its output to the pipeline using writeToPipeline. A coder that finds an error
+ * prints it and calls failPipeline.
+ *
+ * @param state The state given to runPipeline, kept between blocks.
+ * @param data The bytes of the input block.
+ * @param length The number of bytes in the input block.
+ * @param pipe The pipeline that the output is written to.
+ * @since 1.0
+ */
+typedef void (*PipelineCoder)(void *state, const unsigned char *data, size_t length, Pipeline *pipe);
+
+/**
+ * @brief Runs a file through a coder using the pipelined I/O engine.
+ *
+ * This function opens the input and output files and then reads the input block by block, gives each
+ * block to the coder and writes everything the coder produced to the output file. Reading, coding and
+ * writing overlap each other. io_uring is used when the kernel supports it and both files are regular
+ * files, otherwise a reader and a writer thread are used.
+ *
+ * @param inputFile The input file.
+ * @param outputFile The output file, or NULL if the coder only reads the input.
+ * @param coder The function that codes each input block.
+ * @param state The state that is passed to the coder.
+ * @since 1.0
+ */
+void runPipeline(char *inputFile, char *outputFile, PipelineCoder coder, void *state);
+
+/**
+ * @brief Runs a file through a coder using the pipelined I/O engine, without stopping the program if it fails.
+ *
+ * This function works like runPipeline, but if a file cannot be opened, read or written, or the coder calls
+ * failPipeline, the error is printed and the function returns 0. The output file is left with what was written
+ * before the failure.
+ *
+ * @param inputFile The input file.
+ * @param outputFile The output file, or NULL if the coder only reads the input.
+ * @param coder The function that codes each input block.
+ * @param state The state that is passed to the coder.
+ * @return 1 if the whole input file was coded, 0 if the pipeline failed.
+ * @since 1.6
+ */
+int tryRunPipeline(char *inputFile, char *outputFile, PipelineCoder coder, void *state);
+
+/**
+ * @brief Runs the end of a file through a coder using the pipelined I/O engine.
+ *
+ * This function works like runPipeline, but it starts reading the input file at an offset and can add the
+ * output to the end of the output file instead of replacing it. The input file must be seekable if the offset
+ * is not 0, and the output file must already exist and be seekable when appending.
+ *
+ * @param inputFile The input file.
+ * @param inputOffset The offset of the first byte of the input file that is given to the coder.
+ * @param outputFile The output file, or NULL if the coder only reads the input.
+ * @param append 1 to write after the end of the output file, 0 to replace it.
+ * @param coder The function that codes each input block.
+ * @param state The state that is passed to the coder.
+ * @since 1.2
+ */
+void runPipelineFrom(char *inputFile, off_t inputOffset, char *outputFile, int append, PipelineCoder coder, void *state);
+
+/**
+ * @brief Runs the end of a file through a coder using the pipelined I/O engine, without stopping the program if it
+ * fails.
+ *
+ * This function works like runPipelineFrom, but returns the failure like tryRunPipeline.
+ *
+ * @param inputFile The input file.
+ * @param inputOffset The offset of the first byte of the input file that is given to the coder.
+ * @param outputFile The output file, or NULL if the coder only reads the input.
+ * @param append 1 to write after the end of the output file, 0 to replace it.
+ * @param coder The function that codes each input block.
+ * @param state The state that is passed to the coder.
+ * @return 1 if the whole input file was coded, 0 if the pipeline failed.
+ * @since 1.6
+ */
+int tryRunPipelineFrom(char *inputFile, off_t inputOffset, char *outputFile, int append, PipelineCoder coder,
+                       void *state);
+
+/**
+ * @brief Runs a buffer that is in memory through a coder using the pipelined I/O engine.
+ *
+ * This function works like runPipeline, but the blocks given to the coder are parts of the buffer, so nothing is
+ * read or copied. A writer thread writes the output while the coder runs. When the buffer is a memory mapping of a
+ * file that may not fit in memory, it can be streamed: every PIPELINE_WINDOW_SIZE bytes are read ahead before the
+ * coder reaches them and let go of after it has passed them.
+ *
+ * @param data The buffer, page aligned if it is streamed.
+ * @param length The number of bytes in the buffer.
+ * @param stream 1 to read the buffer ahead and let go of it a window at a time, 0 otherwise.
+ * @param outputFile The output file, or NULL if the coder only reads the input.
+ * @param coder The function that codes each block of the buffer.
+ * @param state The state that is passed to the coder.
+ * @since 1.4
+ */
+void runPipelineOnMemory(const unsigned char *data, size_t length, int stream, char *outputFile, PipelineCoder coder,
+                         void *state);
+
+/**
+ * @brief Runs a buffer that is in memory through a coder using the pipelined I/O engine, without stopping the
+ * program if it fails.
+ *
+ * This function works like runPipelineOnMemory, but returns the failure like tryRunPipeline.
+ *
+ * @param data The buffer, page aligned if it is streamed.
+ * @param length The number of bytes in the buffer.
+ * @param stream 1 to read the buffer ahead and let go of it a window at a time, 0 otherwise.
+ * @param outputFile The output file, or NULL if the coder only reads the input.
+ * @param coder The function that codes each block of the buffer.
+ * @param state The state that is passed to the coder.
+ * @return 1 if the whole buffer was coded, 0 if the pipeline failed.
+ * @since 1.6
+ */
+int tryRunPipelineOnMemory(const unsigned char *data, size_t length, int stream, char *outputFile,
+                           PipelineCoder coder, void *state);
+
+/**
+ * @brief Writes data to the output of a pipeline.
+ *
+ * This function copies the data into the current output block. Full blocks are handed to the writer
+ * stage, and if all the blocks of the ring buffer are still being written the function waits for one of them.
+ * Nothing is written once the pipeline has failed.
+ *
+ * @param pipe The pipeline.
+ * @param data The data to write.
+ * @param length The number of bytes to write.
+ * @since 1.0
+ */
+void writeToPipeline(Pipeline *pipe, const void *data, size_t length);
+
+/**
+ * @brief Stops a pipeline because its coder found an error.
+ *
+ * The coder prints the error itself. It is not given any more blocks, nothing more is written to the output file and
+ * the function that runs the pipeline fails.
+ *
+ * @param pipe The pipeline.
+ * @since 1.6
+ */
+void failPipeline(Pipeline *pipe);
+
+/**
+ * @brief Finds if a pipeline has failed.
+ *
+ * @param pipe The pipeline.
+ * @return 1 if the coder called failPipeline or a file could not be read or written, 0 otherwise.
+ * @since 1.6
+ */
+int hasPipelineFailed(Pipeline *pipe);
+
+#endif
@@ -22,19 +22,48 @@ int main(int argc, char *argv[])
 
 float *calculateProbabilities(char *inputFile)
 {
-    FILE *fp = NULL;
+    unsigned long long totalCount = 0;
+    unsigned long long *charCount = calculateCounts(inputFile);
+    float *charProb = NULL;
+    // check for calloc error
+    if ((charProb = (float *)calloc(ASCII_SIZE, sizeof(float))) == NULL)
+    {
+        printf("System out of memory!");
+        exit(EXIT_FAILURE);
+    }
+
+    int i;
+    for (i = 0; i < ASCII_SIZE; i++)
+        totalCount += charCount[i];
+    for (i = 0; i < ASCII_SIZE; i++)
+        charProb[i] = totalCount > 0 ? (float)charCount[i] / totalCount : 0;
+
+    free(charCount);
+    return charProb;
+}
+
+float *sampleProbabilities(char *inputFile, int chunks)
+{
+    int fd;
     // check if file opens correctly
-    if ((fp = fopen(inputFile, "r")) == NULL)
+    if ((fd = open(inputFile, O_RDONLY)) < 0)
+    {
+        printf("Input file cannot be read!\n");
+        exit(EXIT_FAILURE);
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0)
     {
         printf("Input file cannot be read!\n");
         exit(EXIT_FAILURE);
     }
 
-    int totalCount = 0;
-    int *charCount = NULL;
+    long long totalCount = 0;
+    long long *charCount = NULL;
     float *charProb = NULL;
+    unsigned char *chunk = NULL;
     // check for calloc error
-    if ((charCount = (int *)calloc(ASCII_SIZE, sizeof(int))) == NULL)
+    if ((charCount = (long long *)calloc(ASCII_SIZE, sizeof(long long))) == NULL)
     {
         printf("System out of memory!");
         exit(EXIT_FAILURE);
@@ -44,21 +73,58 @@ float *calculateProbabilities(char *inputFile)
         printf("System out of memory!");
         exit(EXIT_FAILURE);
     }
-
-    char token;
-    // scan all the numbers from file to fill the table
-    while ((token = fgetc(fp)) != EOF)
+    if ((chunk = (unsigned char *)malloc(SAMPLE_CHUNK_SIZE)) == NULL)
     {
-        charCount[(int)token]++;
-        totalCount++;
+        printf("System out of memory!");
+        exit(EXIT_FAILURE);
     }
 
+    // small files are read whole, otherwise the chunks are spread from the start to the end of the file
+    off_t size = info.st_size;
+    if (chunks < 1)
+        chunks = 1;
+    if (size <= (off_t)chunks * SAMPLE_CHUNK_SIZE)
+        chunks = (size + SAMPLE_CHUNK_SIZE - 1) / SAMPLE_CHUNK_SIZE;
+
     int i;
+    for (i = 0; i < chunks; i++)
+    {
+        off_t offset = (off_t)i * SAMPLE_CHUNK_SIZE;
+        if (size > (off_t)chunks * SAMPLE_CHUNK_SIZE && chunks > 1)
+            offset = (size - SAMPLE_CHUNK_SIZE) / (chunks - 1) * i;
+        ssize_t n = pread(fd, chunk, SAMPLE_CHUNK_SIZE, offset);
+        if (n < 0)
+        {
+            printf("Input file cannot be read!\n");
+            exit(EXIT_FAILURE);
+        }
+
+        ssize_t j;
+        for (j = 0; j < n; j++)
+        {
+            if (chunk[j] < ASCII_SIZE)
+            {
+                charCount[chunk[j]]++;
+                totalCount++;
+            }
+        }
+    }
+
+    // give every character the floor probability and normalize again
+    float sum = 0;
     for (i = 0; i < ASCII_SIZE; i++)
-        charProb[i] = (float)charCount[i] / totalCount;
+    {
+        charProb[i] = totalCount > 0 ? (float)charCount[i] / totalCount : 0;
+        if (charProb[i] < SAMPLE_PROBABILITY_FLOOR)
+            charProb[i] = SAMPLE_PROBABILITY_FLOOR;
+        sum += charProb[i];
+    }
+    for (i = 0; i < ASCII_SIZE; i++)
+        charProb[i] /= sum;
 
-    fclose(fp);
+    close(fd);
     free(charCount);
+    free(chunk);
     return charProb;
 }
 
@@ -4,10 +4,12 @@
  *
  * This file contains declarations for functions for calculating the probabilities for all 128 
  * ASCII characters in a text file. The probabilities can also be written in another file.
+ * For very large files the probabilities can instead be estimated from a number of evenly spaced
+ * chunks of the file, so that the whole file does not have to be read.
  * 
  *  @author Spyros Sachmpazidis
  *  @bug No know bugs.
- *  @version 1.1
+ *  @version 1.3
  *  @since 20/11/23
  */
 #ifndef PROBABILITY_CALCULATOR_H
@@ -15,17 +17,27 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include "characterCounts.h"
 
 #ifndef ASCII_SIZE
 /*The size of the ASCII table*/
 #define ASCII_SIZE 128
 #endif
 
+/*The number of bytes read from each chunk when sampling a file*/
+#define SAMPLE_CHUNK_SIZE (1 << 16)
+/*The lowest probability given to a character when sampling, it is the smallest value that writeProbabilities keeps*/
+#define SAMPLE_PROBABILITY_FLOOR 0.000001f
+
 
 /** @brief Reads a file and calculates probabilities for each character
  *
  *  This function reads a file and it creates a probability table.
- *  The file must only include the first 128 ASCII characters.
+ *  Only the first 128 ASCII characters are counted, using calculateCounts.
  *  The probability of occurrence for each one of the 128 characters is calculated and placed in a float array.
  *  The function then returns a pointer to the first float of the array.
  *
@@ -35,6 +47,21 @@
  */
 float *calculateProbabilities(char *inputFile);
 
+/** @brief Estimates the probabilities for each character from samples of a file
+ *
+ *  This function reads a number of evenly spaced chunks from a file, using pread so that the
+ *  rest of the file is skipped, and estimates the probability of occurrence for each one of the 128 characters
+ *  from them. Since a character that was not seen in the samples can still be found in the file,
+ *  every character gets at least SAMPLE_PROBABILITY_FLOOR probability, so all of them get a huffman code.
+ *  If the file is smaller than the chunks together the whole file is used.
+ *
+ *  @param inputFile the name of the input file(including .txt)
+ *  @param chunks the number of chunks to read from the file
+ *  @return a pointer to a float array that is contains the probabilities
+ *  @since 1.2
+ */
+float *sampleProbabilities(char *inputFile, int chunks);
+
 /** @brief Writes the probabilities in a file
  *
  *  This function writes the probabilities for all characters in a file with the correct format.
@@ -0,0 +1,273 @@
+#include "tansCoder.h"
+
+#ifdef DEBUG_TANS_CODER
+#include "codecModel.h"
+
+int main(int argc, char *argv[])
+{
+    if (argc != 5)
+    {
+        printf("Correct files not given!\n");
+        exit(EXIT_FAILURE);
+    }
+    printf("Debugging tansCoder.c:\n");
+    printf("Trying to open %s to read the model...\n", argv[1]);
+    CodecModel *model = loadCodecModel(argv[1]);
+    printf("Success!\n");
+    printf("Trying to create tans tables...\n");
+    const TansTable *table = getTansTable(model);
+    printf("Success!Printing frequencies for all visible characters:\n");
+    for (int i = 32; i < ASCII_SIZE - 1; i++)
+        printf("%c\t%d\n", i, table->frequency[i]);
+    printf("Trying to encode %s into %s...\n", argv[2], argv[3]);
+    TransformChain transforms;
+    transforms.count = 0;
+    codecEncodeFile(model, BACKEND_TANS, &transforms, argv[2], argv[3]);
+    printf("Success!\n");
+    printf("Trying to decode %s into %s...\n", argv[3], argv[4]);
+    codecDecodeFile(model, argv[3], argv[4]);
+    printf("Success!\n");
+    freeCodecModel(model);
+}
+#endif
+
+/*returns the position of the highest bit that is 1*/
+static int highestBit(uint32_t value)
+{
+    int bit = 0;
+    while (value >>= 1)
+        bit++;
+    return bit;
+}
+
+TansTable *createTansTable(double *weights)
+{
+    TansTable *table = NULL;
+    if ((table = (TansTable *)malloc(sizeof(TansTable))) == NULL)
+    {
+        printf("System out of memory!");
+        exit(EXIT_FAILURE);
+    }
+
+    double total = 0;
+    int i;
+    for (i = 0; i < ASCII_SIZE; i++)
+        total += weights[i];
+
+    // scale the weights so that the frequencies add up to the table size, the escape symbol always gets 1
+    int sum = 0;
+    for (i = 0; i < TANS_ALPHABET_SIZE; i++)
+    {
+        table->frequency[i] = 0;
+        if (i == TANS_ESCAPE)
+            table->frequency[i] = 1;
+        else if (weights[i] > 0)
+        {
+            table->frequency[i] = (int)(weights[i] * TANS_TABLE_SIZE / total + 0.5);
+            if (table->frequency[i] < 1)
+                table->frequency[i] = 1;
+        }
+        sum += table->frequency[i];
+    }
+    // fix the rounding error using the most common character, that is where it costs the least
+    while (sum != TANS_TABLE_SIZE)
+    {
+        int largest = 0;
+        for (i = 1; i < TANS_ALPHABET_SIZE; i++)
+            if (table->frequency[i] > table->frequency[largest])
+                largest = i;
+        if (sum > TANS_TABLE_SIZE)
+        {
+            table->frequency[largest]--;
+            sum--;
+        }
+        else
+        {
+            table->frequency[largest]++;
+            sum++;
+        }
+    }
+
+    // spread the characters over the states, the step is odd so every state is used once
+    unsigned char spread[TANS_TABLE_SIZE];
+    int step = (TANS_TABLE_SIZE >> 1) + (TANS_TABLE_SIZE >> 3) + 3;
+    int position = 0;
+    int j;
+    for (i = 0; i < TANS_ALPHABET_SIZE; i++)
+    {
+        for (j = 0; j < table->frequency[i]; j++)
+        {
+            spread[position] = i;
+            position = (position + step) & (TANS_TABLE_SIZE - 1);
+        }
+    }
+
+    int cumulative[TANS_ALPHABET_SIZE];
+    int next[TANS_ALPHABET_SIZE];
+    sum = 0;
+    for (i = 0; i < TANS_ALPHABET_SIZE; i++)
+    {
+        cumulative[i] = sum;
+        next[i] = table->frequency[i];
+        sum += table->frequency[i];
+
+        TansSymbol *symbol = &table->symbols[i];
+        symbol->maxBits = 0;
+        symbol->threshold = 0;
+        symbol->start = 0;
+        if (table->frequency[i] > 0)
+        {
+            symbol->maxBits = TANS_TABLE_LOG - highestBit(table->frequency[i]);
+            symbol->threshold = (uint32_t)table->frequency[i] << symbol->maxBits;
+            symbol->start = cumulative[i] - table->frequency[i];
+        }
+    }
+
+    // fill both tables in the order of the states
+    for (i = 0; i < TANS_TABLE_SIZE; i++)
+    {
+        int c = spread[i];
+        int k = next[c]++;
+        int nbBits = TANS_TABLE_LOG - highestBit(k);
+        table->stateTable[cumulative[c] + k - table->frequency[c]] = TANS_TABLE_SIZE + i;
+        table->decodeTable[i].character = c;
+        table->decodeTable[i].nbBits = nbBits;
+        table->decodeTable[i].newState = (k << nbBits) - TANS_TABLE_SIZE;
+    }
+
+    return table;
+}
+
+size_t encodeTansPayload(const TansTable *table, const unsigned char *data, size_t length, unsigned char *payload)
+{
+    unsigned char *end = payload + TANS_MAX_PAYLOAD;
+    unsigned char *out = end;
+    uint64_t bits = 0;
+    int count = 0;
+    uint32_t states[TANS_STATES];
+    int k;
+    for (k = 0; k < TANS_STATES; k++)
+        states[k] = TANS_TABLE_SIZE;
+
+    // encode backwards and write the bits backwards, so the decoder reads everything forwards
+    size_t i = length;
+    while (i-- > 0)
+    {
+        int c = data[i];
+        // the 8 bits of a character that is not in the model are read right after its escape symbol
+        if (c >= ASCII_SIZE || table->frequency[c] == 0)
+        {
+            bits |= (uint64_t)c << count;
+            count += 8;
+            c = TANS_ESCAPE;
+        }
+        // the characters take turns using the states
+        uint32_t x = states[i % TANS_STATES];
+        const TansSymbol *symbol = &table->symbols[c];
+        int nbBits = symbol->maxBits - (x < symbol->threshold);
+        bits |= (uint64_t)(x & ((1u << nbBits) - 1)) << count;
+        count += nbBits;
+        states[i % TANS_STATES] = table->stateTable[symbol->start + (x >> nbBits)];
+        while (count >= 8)
+        {
+            *--out = bits & 0xFF;
+            bits >>= 8;
+            count -= 8;
+        }
+    }
+
+    // the final states are the first thing the decoder reads, the first state first
+    for (k = TANS_STATES - 1; k >= 0; k--)
+    {
+        bits |= (uint64_t)(states[k] - TANS_TABLE_SIZE) << count;
+        count += TANS_TABLE_LOG;
+        while (count >= 8)
+        {
+            *--out = bits & 0xFF;
+            bits >>= 8;
+            count -= 8;
+        }
+    }
+    int padding = 0;
+    if (count > 0)
+    {
+        *--out = bits & 0xFF;
+        padding = 8 - count;
+    }
+
+    size_t payloadLength = end - out;
+    payload[0] = padding;
+    memmove(payload + 1, out, payloadLength);
+    return payloadLength + 1;
+}
+
+static size_t tansEncodeBlock(const void *state, const unsigned char *data, size_t length, unsigned char *payload)
+{
+    return encodeTansPayload((const TansTable *)state, data, length, payload);
+}
+
+/*decodes the character of an entry and moves its state to the next one*/
+static inline unsigned char decodeTansEntry(TansEntry entry, uint32_t *x, BitReader *reader)
+{
+    *x = entry.newState + readBits(reader, entry.nbBits);
+    if (entry.character != TANS_ESCAPE)
+        return entry.character;
+    refillBits(reader);
+    return readBits(reader, 8);
+}
+
+int decodeTansPayload(const TansTable *table, const unsigned char *payload, size_t payloadLength, size_t length,
+                      unsigned char *out)
+{
+    const TansEntry *decodeTable = table->decodeTable;
+    if (payloadLength < 2 || payload[0] > 7)
+    {
+        printf("Error: Invalid block in encoded file\n");
+        return 0;
+    }
+
+    BitReader reader;
+    initializeBitReader(&reader, payload + 1, payloadLength - 1);
+    refillBits(&reader);
+    skipBits(&reader, payload[0]);
+    uint32_t x[TANS_STATES];
+    x[0] = readBits(&reader, TANS_TABLE_LOG);
+    x[1] = readBits(&reader, TANS_TABLE_LOG);
+
+    size_t i = 0;
+    // 4 characters use at most 44 bits, so 1 refill is enough for all of them, an escape refills for its own 8 bits.
+    // The entries of both states are looked up before either is used, so the lookups do not wait for each other
+    for (; i + 4 <= length; i += 4)
+    {
+        refillBits(&reader);
+        TansEntry first = decodeTable[x[0]], second = decodeTable[x[1]];
+        out[i] = decodeTansEntry(first, &x[0], &reader);
+        out[i + 1] = decodeTansEntry(second, &x[1], &reader);
+        first = decodeTable[x[0]];
+        second = decodeTable[x[1]];
+        out[i + 2] = decodeTansEntry(first, &x[0], &reader);
+        out[i + 3] = decodeTansEntry(second, &x[1], &reader);
+    }
+    for (; i < length; i++)
+    {
+        refillBits(&reader);
+        out[i] = decodeTansEntry(decodeTable[x[i % TANS_STATES]], &x[i % TANS_STATES], &reader);
+    }
+    return 1;
+}
+
+int tryTansEncodeFile(char *inputFile, char *outputFile, const TansTable *table, const EncodedSegment *segment)
+{
+    return tryEncodeBlocks(inputFile, outputFile, segment, tansEncodeBlock, TANS_MAX_PAYLOAD, table);
+}
+
+void tansEncodeMemory(const unsigned char *data, size_t length, int stream, char *outputFile, const TansTable *table,
+                      const EncodedSegment *segment)
+{
+    encodeMemoryBlocks(data, length, stream, outputFile, segment, tansEncodeBlock, TANS_MAX_PAYLOAD, table);
+}
+
+void freeTansTable(const TansTable *table)
+{
+    free((void *)table);
+}
@@ -0,0 +1,179 @@
+/**
+ * @file tansCoder.h
+ * @brief Header file for encoding and decoding files using table based asymmetric numeral systems.
+ *
+ * This file contains declarations for functions for an entropy coder that can be used instead of the
+ * huffman codes. A huffman code always spends a whole number of bits for each character, so very common
+ * characters still cost at least 1 bit. The asymmetric numeral system keeps a state number that carries the
+ * fractional bits from one character to the next, so each character costs almost exactly what its probability says.
+ *
+ * The coder uses the same probability or count files as the huffman coder. The weights are scaled to
+ * frequencies that add up to TANS_TABLE_SIZE, and the encoding and decoding are both done with lookups in
+ * tables of that size, small enough to stay in the first level cache. Characters that are not in the model
+ * are encoded as the TANS_ESCAPE symbol followed by their 8 bits, so any byte can be encoded.
+ *
+ * @author Spyros Sachmpazidis
+ * @bug No know bugs.
+ * @version 1.7
+ * @since 19/10/26
+ */
+
+#ifndef TANS_CODER_H
+#define TANS_CODER_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "huffmanTree.h"
+#include "encodedFile.h"
+#include "bitStream.h"
+
+/*The number of bits of the coder state*/
+#define TANS_TABLE_LOG 11
+/*The number of states, all the frequencies add up to this*/
+#define TANS_TABLE_SIZE (1 << TANS_TABLE_LOG)
+/*The number of states that the characters of a block take turns using, the decoder is written for 2*/
+#define TANS_STATES 2
+/*The symbol that is encoded before a character that is not in the model*/
+#define TANS_ESCAPE ASCII_SIZE
+/*The number of symbols of the coder, the characters and the escape symbol*/
+#define TANS_ALPHABET_SIZE (ASCII_SIZE + 1)
+/*The largest payload of an encoded block, every character costs at most TANS_TABLE_LOG bits and 8 more if it is escaped*/
+#define TANS_MAX_PAYLOAD MAX_BLOCK_PAYLOAD(TANS_TABLE_LOG + 8)
+
+/**
+ * @struct TansSymbol
+ * @brief Represents how a character is encoded.
+ *
+ * The structure contains what is needed to find how many bits a character costs from a state
+ * and where its next states start in the state table.
+ *
+ * @since 1.0
+ */
+typedef struct
+{
+    int maxBits;
+    uint32_t threshold;
+    int start;
+} TansSymbol;
+
+/**
+ * @struct TansEntry
+ * @brief Represents a state of the decoding table.
+ *
+ * Each entry has the character that is decoded from the state, the number of bits to read
+ * and the base of the next state that these bits are added to.
+ *
+ * @since 1.0
+ */
+typedef struct
+{
+    uint16_t newState;
+    uint8_t character;
+    uint8_t nbBits;
+} TansEntry;
+
+/**
+ * @struct TansTable
+ * @brief Represents the encoding and decoding tables of a model.
+ *
+ * @since 1.0
+ */
+typedef struct
+{
+    int frequency[TANS_ALPHABET_SIZE];
+    TansSymbol symbols[TANS_ALPHABET_SIZE];
+    uint16_t stateTable[TANS_TABLE_SIZE];
+    TansEntry decodeTable[TANS_TABLE_SIZE];
+} TansTable;
+
+/**
+ * @brief Creates the tables of the coder from the weights of a model.
+ *
+ * This function scales the weights of the characters to frequencies that add up to TANS_TABLE_SIZE,
+ * giving at least 1 to every character with a weight bigger than 0 and 1 to the escape symbol, spreads the
+ * characters over the states and fills the encoding and decoding tables. Characters with 0 weight do not take
+ * any state, they are encoded with the escape symbol.
+ *
+ * @param weights a pointer to a double array with the weight of each character.
+ * @return A pointer to the created tables.
+ * @since 1.0
+ */
+TansTable *createTansTable(double *weights);
+
+/**
+ * @brief Encodes 1 block into the payload of a block of a binary encoded file.
+ *
+ * This function is used by tryTansEncodeFile for every block, and can be used by anything else that writes the payload
+ * of a block itself. The block is encoded into the end of the buffer and then moved to its start.
+ *
+ * @param table Pointer to the tables of the coder.
+ * @param data The characters of the block.
+ * @param length The number of characters.
+ * @param payload The buffer that the block is written to, with room for TANS_MAX_PAYLOAD bytes.
+ * @return The number of bytes written to the payload.
+ * @since 1.5
+ */
+size_t encodeTansPayload(const TansTable *table, const unsigned char *data, size_t length, unsigned char *payload);
+
+/**
+ * @brief Encodes a file using the tables and writes a binary encoded file.
+ *
+ * Each block of the input file is encoded from its last character to its first, so that the decoder
+ * can read the bits in order. The characters take turns using TANS_STATES states, so the decoder can look up
+ * the next character of every state at once, and the final states are written at the start of the block. A character
+ * that is not in the model is written as its 8 bits and the escape symbol, so that the decoder reads them after the
+ * escape.
+ *
+ * @param inputFile The input file.
+ * @param outputFile The output file.
+ * @param table Pointer to the tables of the coder.
+ * @param segment The segment that the encoded blocks belong to, its backend must be BACKEND_TANS.
+ * @return 1 if the file was encoded, 0 if a file could not be opened, read or written, the error is printed.
+ * @since 1.0
+ */
+int tryTansEncodeFile(char *inputFile, char *outputFile, const TansTable *table, const EncodedSegment *segment);
+
+/**
+ * @brief Encodes a buffer that is in memory using the tables and writes a new binary encoded file.
+ *
+ * The blocks are encoded like the blocks of tryTansEncodeFile.
+ *
+ * @param data The buffer.
+ * @param length The number of bytes in the buffer.
+ * @param stream 1 if the buffer is a memory mapping that is read ahead and let go of a window at a time.
+ * @param outputFile The output file.
+ * @param table Pointer to the tables of the coder.
+ * @param segment The segment that the encoded blocks belong to, its backend must be BACKEND_TANS.
+ * @since 1.4
+ */
+void tansEncodeMemory(const unsigned char *data, size_t length, int stream, char *outputFile, const TansTable *table,
+                      const EncodedSegment *segment);
+
+/**
+ * @brief Decodes the payload of 1 block of a binary encoded file into memory.
+ *
+ * This function is used by codecDecodeFile for every block, and can be used by anything else that needs the
+ * characters of a block without writing them to a file.
+ *
+ * @param table Pointer to the tables of the coder.
+ * @param payload The payload of the block.
+ * @param payloadLength The number of bytes in the payload.
+ * @param length The number of characters that the block encodes.
+ * @param out The buffer that the characters are written to, with room for length characters.
+ * @return 1 if the block was decoded, 0 if its payload is invalid, the error is printed.
+ * @since 1.2
+ */
+int decodeTansPayload(const TansTable *table, const unsigned char *payload, size_t payloadLength, size_t length,
+                      unsigned char *out);
+
+/**
+ * @brief Frees the memory allocated for the tables of the coder.
+ *
+ * @param table Pointer to the tables of the coder.
+ * @since 1.0
+ */
+void freeTansTable(const TansTable *table);
+
+#endif
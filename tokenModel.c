@@ -0,0 +1,610 @@
+#include "tokenModel.h"
+
+/*A byte sequence that can become a token and how many times it was found while training*/
+typedef struct
+{
+    unsigned long long count;
+    int length;
+    unsigned char bytes[TOKEN_MAX_LENGTH];
+} TokenCandidate;
+
+/*The state of the first pass of the training, the candidates are kept in a hash table*/
+typedef struct
+{
+    TokenCandidate *table;
+    size_t used;
+    unsigned long long pruneLevel;
+} CandidateCounter;
+
+/*The state of the second pass of the training*/
+typedef struct
+{
+    TokenModel *model;
+    unsigned long long *counts;
+} SymbolCounter;
+
+/*The state of the decoder between the blocks of the pipeline*/
+typedef struct
+{
+    TokenModel *model;
+    unsigned char buffer[PIPELINE_BLOCK_SIZE];
+} TokenDecoder;
+
+#ifdef DEBUG_TOKEN_MODEL
+int main(int argc, char *argv[])
+{
+    if (argc != 4)
+    {
+        printf("Correct arguments not given!\n");
+        exit(EXIT_FAILURE);
+    }
+    printf("Debugging tokenModel.c:\n");
+    printf("Trying to train a model of %s symbols from %s...\n", argv[2], argv[1]);
+    TokenModel *model = trainTokenModel(argv[1], atoi(argv[2]));
+    printf("Success!The model has %d symbols and its longest code has %d bits\n", model->symbolCount,
+           model->code->maxCodeLength);
+    printf("Trying to write the model in %s and read it back...\n", argv[3]);
+    writeTokenModel(argv[3], model);
+    TokenModel *copy = readTokenModel(argv[3]);
+    printf("%s\n", copy->symbolCount == model->symbolCount &&
+                           memcmp(copy->counts, model->counts, model->symbolCount * sizeof(unsigned long long)) == 0
+                       ? "Success!"
+                       : "Models differ!");
+    freeTokenModel(model);
+    freeTokenModel(copy);
+}
+#endif
+
+/*letters and digits form words, spaces and tabs form runs, every other character is a run of its own*/
+static int characterClass(unsigned char c)
+{
+    if (isalnum(c) || c == '_')
+        return 1;
+    if (c == ' ' || c == '\t')
+        return 2;
+    return 0;
+}
+
+static uint64_t hashBytes(const unsigned char *bytes, int length)
+{
+    uint64_t hash = 14695981039346656037ULL;
+    int i;
+    for (i = 0; i < length; i++)
+        hash = (hash ^ bytes[i]) * 1099511628211ULL;
+    return hash;
+}
+
+static TokenCandidate *findCandidate(TokenCandidate *table, const unsigned char *bytes, int length)
+{
+    size_t mask = TOKEN_CANDIDATE_TABLE_SIZE - 1;
+    size_t i = hashBytes(bytes, length) & mask;
+    while (table[i].length != 0 && (table[i].length != length || memcmp(table[i].bytes, bytes, length) != 0))
+        i = (i + 1) & mask;
+    return &table[i];
+}
+
+/*drops the rarest candidates until the table is at most half full*/
+static void pruneCandidates(CandidateCounter *counter)
+{
+    while (counter->used > TOKEN_CANDIDATE_TABLE_SIZE / 2)
+    {
+        TokenCandidate *table = NULL;
+        if ((table = (TokenCandidate *)calloc(TOKEN_CANDIDATE_TABLE_SIZE, sizeof(TokenCandidate))) == NULL)
+        {
+            printf("System out of memory!");
+            exit(EXIT_FAILURE);
+        }
+        counter->pruneLevel++;
+        counter->used = 0;
+        size_t i;
+        for (i = 0; i < TOKEN_CANDIDATE_TABLE_SIZE; i++)
+            if (counter->table[i].length != 0 && counter->table[i].count > counter->pruneLevel)
+            {
+                *findCandidate(table, counter->table[i].bytes, counter->table[i].length) = counter->table[i];
+                counter->used++;
+            }
+        free(counter->table);
+        counter->table = table;
+    }
+}
+
+static void addCandidate(CandidateCounter *counter, const unsigned char *bytes, size_t length)
+{
+    if (length < 2 || length > TOKEN_MAX_LENGTH)
+        return;
+
+    TokenCandidate *candidate = findCandidate(counter->table, bytes, length);
+    if (candidate->length != 0)
+    {
+        candidate->count++;
+        return;
+    }
+    candidate->count = 1;
+    candidate->length = length;
+    memcpy(candidate->bytes, bytes, length);
+    if (++counter->used > TOKEN_CANDIDATE_TABLE_SIZE / 4 * 3)
+        pruneCandidates(counter);
+}
+
+static void collectCandidates(void *state, const unsigned char *data, size_t length, Pipeline *pipe)
+{
+    CandidateCounter *counter = (CandidateCounter *)state;
+    (void)pipe;
+    // every run and every run together with the one before it is a candidate
+    size_t i = 0, previous = 0;
+    int hasPrevious = 0;
+    while (i < length)
+    {
+        int runClass = characterClass(data[i]);
+        size_t end = i + 1;
+        if (runClass != 0)
+            while (end < length && characterClass(data[end]) == runClass)
+                end++;
+        addCandidate(counter, data + i, end - i);
+        if (hasPrevious)
+            addCandidate(counter, data + previous, end - previous);
+        previous = i;
+        hasPrevious = 1;
+        i = end;
+    }
+}
+
+/*orders the candidates by the number of characters they save, from the most*/
+static int compareCandidates(const void *a, const void *b)
+{
+    const TokenCandidate *x = (const TokenCandidate *)a, *y = (const TokenCandidate *)b;
+    unsigned long long scoreX = x->count * (x->length - 1), scoreY = y->count * (y->length - 1);
+    if (scoreX != scoreY)
+        return scoreX > scoreY ? -1 : 1;
+    if (x->length != y->length)
+        return x->length - y->length;
+    return memcmp(x->bytes, y->bytes, x->length);
+}
+
+static int32_t findChild(const TokenModel *model, int32_t node, unsigned char c)
+{
+    uint64_t key = ((uint64_t)node << 8 | c) + 1;
+    uint64_t i = ((key * 0x9E3779B97F4A7C15ULL) >> 32) & model->edgeMask;
+    while (model->edgeKeys[i] != 0)
+    {
+        if (model->edgeKeys[i] == key)
+            return model->edgeChildren[i];
+        i = (i + 1) & model->edgeMask;
+    }
+    return -1;
+}
+
+static int32_t addChild(TokenModel *model, int32_t node, unsigned char c)
+{
+    uint64_t key = ((uint64_t)node << 8 | c) + 1;
+    uint64_t i = ((key * 0x9E3779B97F4A7C15ULL) >> 32) & model->edgeMask;
+    while (model->edgeKeys[i] != 0)
+    {
+        if (model->edgeKeys[i] == key)
+            return model->edgeChildren[i];
+        i = (i + 1) & model->edgeMask;
+    }
+    model->edgeKeys[i] = key;
+    model->nodeSymbols[model->nodeCount] = -1;
+    model->edgeChildren[i] = model->nodeCount;
+    return model->nodeCount++;
+}
+
+/*creates the trie and the codes of the symbols, the model keeps the arrays*/
+static TokenModel *createTokenModel(int symbolCount, unsigned char *text, uint32_t *start, unsigned long long *counts)
+{
+    TokenModel *model = NULL;
+    if ((model = (TokenModel *)malloc(sizeof(TokenModel))) == NULL)
+    {
+        printf("System out of memory!");
+        exit(EXIT_FAILURE);
+    }
+    model->symbolCount = symbolCount;
+    model->text = text;
+    model->start = start;
+    model->counts = counts;
+
+    // there is at most 1 node and 1 edge for every byte of the tokens, the hash table is kept at most half full
+    size_t tokenBytes = start[symbolCount] - start[BYTE_SIZE];
+    size_t edgeCapacity = 1;
+    while (edgeCapacity < 2 * tokenBytes + 2)
+        edgeCapacity <<= 1;
+    model->edgeMask = edgeCapacity - 1;
+    model->nodeCount = 0;
+    if ((model->nodeSymbols = (int32_t *)malloc((tokenBytes + 1) * sizeof(int32_t))) == NULL ||
+        (model->edgeKeys = (uint64_t *)calloc(edgeCapacity, sizeof(uint64_t))) == NULL ||
+        (model->edgeChildren = (int32_t *)malloc(edgeCapacity * sizeof(int32_t))) == NULL)
+    {
+        printf("System out of memory!");
+        exit(EXIT_FAILURE);
+    }
+
+    int i, k;
+    for (i = 0; i < BYTE_SIZE; i++)
+        model->rootChildren[i] = -1;
+    // a token that is never used gets no code, so it is left out of the trie
+    for (i = BYTE_SIZE; i < symbolCount; i++)
+    {
+        if (counts[i] == 0)
+            continue;
+        const unsigned char *bytes = text + start[i];
+        int length = start[i + 1] - start[i];
+        int32_t node = model->rootChildren[bytes[0]];
+        if (node < 0)
+        {
+            node = model->nodeCount++;
+            model->nodeSymbols[node] = -1;
+            model->rootChildren[bytes[0]] = node;
+        }
+        for (k = 1; k < length; k++)
+            node = addChild(model, node, bytes[k]);
+        if (model->nodeSymbols[node] >= 0)
+        {
+            printf("Error: A token is given twice in the token model\n");
+            exit(EXIT_FAILURE);
+        }
+        model->nodeSymbols[node] = i;
+    }
+
+    // the escape symbol always gets a code
+    unsigned long long *weights = NULL;
+    if ((weights = (unsigned long long *)malloc((symbolCount + 1) * sizeof(unsigned long long))) == NULL)
+    {
+        printf("System out of memory!");
+        exit(EXIT_FAILURE);
+    }
+    memcpy(weights, counts, symbolCount * sizeof(unsigned long long));
+    weights[symbolCount] = 1;
+    model->code = createCanonicalCode(weights, symbolCount + 1);
+    model->decodeTable = createCanonicalDecodeTable(model->code);
+    free(weights);
+    return model;
+}
+
+/*finds the longest token at the start of the data, a single byte if no token matches*/
+static int matchToken(const TokenModel *model, const unsigned char *data, size_t length, size_t *matched)
+{
+    int symbol = data[0];
+    *matched = 1;
+    int32_t node = model->rootChildren[data[0]];
+    size_t i = 1;
+    if (length > TOKEN_MAX_LENGTH)
+        length = TOKEN_MAX_LENGTH;
+    while (node >= 0 && i < length)
+    {
+        node = findChild(model, node, data[i++]);
+        if (node >= 0 && model->nodeSymbols[node] >= 0)
+        {
+            symbol = model->nodeSymbols[node];
+            *matched = i;
+        }
+    }
+    return symbol;
+}
+
+static void countSymbols(void *state, const unsigned char *data, size_t length, Pipeline *pipe)
+{
+    SymbolCounter *counter = (SymbolCounter *)state;
+    (void)pipe;
+    size_t i = 0, matched;
+    while (i < length)
+    {
+        counter->counts[matchToken(counter->model, data + i, length - i, &matched)]++;
+        i += matched;
+    }
+}
+
+/*allocates the text and the starts of a model whose first symbols are the 256 bytes*/
+static void allocateSymbols(int symbolCount, size_t tokenBytes, unsigned char **text, uint32_t **start,
+                            unsigned long long **counts)
+{
+    if ((*text = (unsigned char *)malloc(BYTE_SIZE + tokenBytes)) == NULL ||
+        (*start = (uint32_t *)malloc((symbolCount + 1) * sizeof(uint32_t))) == NULL ||
+        (*counts = (unsigned long long *)calloc(symbolCount, sizeof(unsigned long long))) == NULL)
+    {
+        printf("System out of memory!");
+        exit(EXIT_FAILURE);
+    }
+    int i;
+    for (i = 0; i < BYTE_SIZE; i++)
+    {
+        (*text)[i] = i;
+        (*start)[i] = i;
+    }
+    (*start)[BYTE_SIZE] = BYTE_SIZE;
+}
+
+TokenModel *trainTokenModel(char *inputFile, int symbolCount)
+{
+    if (symbolCount <= BYTE_SIZE || symbolCount > TOKEN_MAX_SYMBOLS)
+    {
+        printf("Error: A token model has more than %d and at most %d symbols\n", BYTE_SIZE, TOKEN_MAX_SYMBOLS);
+        exit(EXIT_FAILURE);
+    }
+
+    CandidateCounter counter;
+    counter.used = 0;
+    counter.pruneLevel = 0;
+    if ((counter.table = (TokenCandidate *)calloc(TOKEN_CANDIDATE_TABLE_SIZE, sizeof(TokenCandidate))) == NULL)
+    {
+        printf("System out of memory!");
+        exit(EXIT_FAILURE);
+    }
+    runPipeline(inputFile, NULL, collectCandidates, &counter);
+
+    // the candidates that save the most characters become the tokens
+    size_t i, candidateCount = 0;
+    for (i = 0; i < TOKEN_CANDIDATE_TABLE_SIZE; i++)
+        if (counter.table[i].length != 0)
+            counter.table[candidateCount++] = counter.table[i];
+    qsort(counter.table, candidateCount, sizeof(TokenCandidate), compareCandidates);
+    size_t tokenCount = symbolCount - BYTE_SIZE - 1;
+    if (tokenCount > candidateCount)
+        tokenCount = candidateCount;
+
+    unsigned char *text;
+    uint32_t *start;
+    unsigned long long *counts;
+    size_t tokenBytes = 0;
+    for (i = 0; i < tokenCount; i++)
+        tokenBytes += counter.table[i].length;
+    allocateSymbols(BYTE_SIZE + tokenCount, tokenBytes, &text, &start, &counts);
+    for (i = 0; i < tokenCount; i++)
+    {
+        memcpy(text + start[BYTE_SIZE + i], counter.table[i].bytes, counter.table[i].length);
+        start[BYTE_SIZE + i + 1] = start[BYTE_SIZE + i] + counter.table[i].length;
+        counts[BYTE_SIZE + i] = 1;
+    }
+    free(counter.table);
+
+    // the symbols are counted as the encoder will use them
+    TokenModel *candidates = createTokenModel(BYTE_SIZE + tokenCount, text, start, counts);
+    SymbolCounter symbols;
+    symbols.model = candidates;
+    if ((symbols.counts = (unsigned long long *)calloc(candidates->symbolCount, sizeof(unsigned long long))) == NULL)
+    {
+        printf("System out of memory!");
+        exit(EXIT_FAILURE);
+    }
+    runPipeline(inputFile, NULL, countSymbols, &symbols);
+
+    // a token that is never used would only make the other codes longer, and dropping it changes no match
+    int used = BYTE_SIZE;
+    tokenBytes = 0;
+    for (i = BYTE_SIZE; i < (size_t)candidates->symbolCount; i++)
+        if (symbols.counts[i] > 0)
+        {
+            used++;
+            tokenBytes += candidates->start[i + 1] - candidates->start[i];
+        }
+    allocateSymbols(used, tokenBytes, &text, &start, &counts);
+    memcpy(counts, symbols.counts, BYTE_SIZE * sizeof(unsigned long long));
+    int symbol = BYTE_SIZE;
+    for (i = BYTE_SIZE; i < (size_t)candidates->symbolCount; i++)
+        if (symbols.counts[i] > 0)
+        {
+            uint32_t length = candidates->start[i + 1] - candidates->start[i];
+            memcpy(text + start[symbol], candidates->text + candidates->start[i], length);
+            start[symbol + 1] = start[symbol] + length;
+            counts[symbol++] = symbols.counts[i];
+        }
+
+    free(symbols.counts);
+    freeTokenModel(candidates);
+    return createTokenModel(used, text, start, counts);
+}
+
+void writeTokenModel(char *outputFile, TokenModel *model)
+{
+    FILE *fp = NULL;
+    // check if file can be opened
+    if ((fp = fopen(outputFile, "w")) == NULL)
+    {
+        printf("Error: Unable to open %s\n", outputFile);
+        exit(EXIT_FAILURE);
+    }
+
+    // write the header, the number of symbols and the count and bytes of every symbol
+    fprintf(fp, "%s\n%d\n", TOKEN_MODEL_FILE_HEADER, model->symbolCount);
+    int i;
+    uint32_t k;
+    for (i = 0; i < model->symbolCount; i++)
+    {
+        fprintf(fp, "%llu ", model->counts[i]);
+        for (k = model->start[i]; k < model->start[i + 1]; k++)
+            fprintf(fp, "%02x", model->text[k]);
+        fprintf(fp, "\n");
+    }
+
+    fclose(fp);
+}
+
+TokenModel *readTokenModel(char *inputFile)
+{
+    FILE *fp = NULL;
+    // check if file opens correctly
+    if ((fp = fopen(inputFile, "r")) == NULL)
+    {
+        printf("Error: Unable to open %s\n", inputFile);
+        exit(EXIT_FAILURE);
+    }
+
+    char line[sizeof(TOKEN_MODEL_FILE_HEADER) + 1];
+    int symbolCount;
+    if (fgets(line, sizeof(line), fp) == NULL || strcmp(line, TOKEN_MODEL_FILE_HEADER "\n") != 0 ||
+        fscanf(fp, "%d", &symbolCount) != 1 || symbolCount < BYTE_SIZE || symbolCount >= TOKEN_MAX_SYMBOLS)
+    {
+        printf("Error: Invalid token model file %s\n", inputFile);
+        exit(EXIT_FAILURE);
+    }
+
+    unsigned char *text;
+    uint32_t *start;
+    unsigned long long *counts;
+    allocateSymbols(symbolCount, (size_t)(symbolCount - BYTE_SIZE) * TOKEN_MAX_LENGTH, &text, &start, &counts);
+
+    // the bytes come first and are always in order, the tokens follow them
+    char hex[2 * TOKEN_MAX_LENGTH + 1];
+    int i;
+    for (i = 0; i < symbolCount; i++)
+    {
+        unsigned int value;
+        int length = 0;
+        if (fscanf(fp, "%llu %64s", &counts[i], hex) != 2)
+            length = -1;
+        else
+        {
+            size_t digits = strlen(hex);
+            while (length >= 0 && (size_t)length * 2 < digits)
+            {
+                if (sscanf(hex + 2 * length, "%2x", &value) != 1 || !isxdigit((unsigned char)hex[2 * length + 1]))
+                    length = -1;
+                else
+                    text[start[i] + length++] = value;
+            }
+        }
+        if (i < BYTE_SIZE ? length != 1 || text[i] != i : length < 2)
+        {
+            printf("Error: Invalid symbol in line %d of %s\n", i + 3, inputFile);
+            exit(EXIT_FAILURE);
+        }
+        start[i + 1] = start[i] + length;
+    }
+    if (fscanf(fp, "%64s", hex) != EOF)
+    {
+        printf("Error: %s has more than %d symbols\n", inputFile, symbolCount);
+        exit(EXIT_FAILURE);
+    }
+
+    fclose(fp);
+    return createTokenModel(symbolCount, text, start, counts);
+}
+
+int isTokenModelFile(char *inputFile)
+{
+    FILE *fp = NULL;
+    // a file that cannot be opened is left to the loader of the other models
+    if ((fp = fopen(inputFile, "r")) == NULL)
+        return 0;
+
+    char line[sizeof(TOKEN_MODEL_FILE_HEADER)];
+    int found = fgets(line, sizeof(line), fp) != NULL && strcmp(line, TOKEN_MODEL_FILE_HEADER) == 0;
+
+    fclose(fp);
+    return found;
+}
+
+static size_t tokenEncodeBlock(const void *state, const unsigned char *data, size_t length, unsigned char *payload)
+{
+    const TokenModel *model = (const TokenModel *)state;
+    const uint8_t *lengths = model->code->lengths;
+    const uint32_t *codes = model->code->codes;
+    int escape = model->symbolCount;
+    BitWriter writer;
+    initializeBitWriter(&writer, payload);
+
+    size_t i = 0, matched;
+    while (i < length)
+    {
+        int symbol = matchToken(model, data + i, length - i, &matched);
+        // only a byte can be without a code, it is written after the escape code
+        if (lengths[symbol] > 0)
+            putBits(&writer, codes[symbol], lengths[symbol]);
+        else
+        {
+            putBits(&writer, codes[escape], lengths[escape]);
+            putBits(&writer, data[i], 8);
+        }
+        i += matched;
+    }
+
+    return flushBits(&writer) - payload;
+}
+
+void tokenEncodeFile(TokenModel *model, char *inputFile, char *outputFile)
+{
+    EncodedSegment segment;
+    initializeSegment(&segment, BACKEND_TOKENS, 0);
+    encodeBlocks(inputFile, outputFile, &segment, tokenEncodeBlock, TOKEN_MAX_PAYLOAD, model);
+}
+
+void decodeTokenPayload(TokenModel *model, const unsigned char *payload, size_t payloadLength, size_t length,
+                        unsigned char *out)
+{
+    const CanonicalDecodeTable *table = model->decodeTable;
+    BitReader reader;
+    initializeBitReader(&reader, payload, payloadLength);
+
+    size_t i = 0;
+    while (i < length)
+    {
+        if (reader.count < CANONICAL_MAX_CODE_LENGTH + 8)
+            refillBits(&reader);
+
+        CanonicalLutEntry entry = table->lut[peekBits(&reader, CANONICAL_LUT_BITS)];
+        int symbol;
+        if (entry.length > 0)
+        {
+            skipBits(&reader, entry.length);
+            symbol = entry.symbol;
+        }
+        else
+            symbol = decodeLongCanonicalCode(table, &reader);
+
+        // the escape code is followed by the 8 bits of the character
+        if (symbol == model->symbolCount)
+        {
+            out[i++] = readBits(&reader, 8);
+            continue;
+        }
+        uint32_t tokenLength = symbol < 0 ? 0 : model->start[symbol + 1] - model->start[symbol];
+        if (tokenLength == 0 || i + tokenLength > length)
+        {
+            printf("Error: Invalid block in encoded file\n");
+            exit(EXIT_FAILURE);
+        }
+        memcpy(out + i, model->text + model->start[symbol], tokenLength);
+        i += tokenLength;
+    }
+}
+
+static const unsigned char *tokenDecodeBlock(void *state, const EncodedSegment *segment, const unsigned char *payload,
+                                            size_t payloadLength, size_t length, Pipeline *pipe)
+{
+    TokenDecoder *decoder = (TokenDecoder *)state;
+    if (segment->backend != BACKEND_TOKENS || segment->transforms.count > 0)
+    {
+        printf("Error: Block was not encoded with a token model\n");
+        exit(EXIT_FAILURE);
+    }
+    (void)pipe;
+    decodeTokenPayload(decoder->model, payload, payloadLength, length, decoder->buffer);
+    return decoder->buffer;
+}
+
+void tokenDecodeFile(TokenModel *model, char *inputFile, char *outputFile)
+{
+    TokenDecoder *decoder = NULL;
+    if ((decoder = (TokenDecoder *)malloc(sizeof(TokenDecoder))) == NULL)
+    {
+        printf("System out of memory!");
+        exit(EXIT_FAILURE);
+    }
+
+    decoder->model = model;
+    decodeBlocks(inputFile, outputFile, tokenDecodeBlock, TOKEN_MAX_PAYLOAD, decoder);
+    free(decoder);
+}
+
+void freeTokenModel(TokenModel *model)
+{
+    free(model->counts);
+    free(model->text);
+    free(model->start);
+    free(model->nodeSymbols);
+    free(model->edgeKeys);
+    free(model->edgeChildren);
+    freeCanonicalCode(model->code);
+    freeCanonicalDecodeTable(model->decodeTable);
+    free(model);
+}
@@ -0,0 +1,164 @@
+/**
+ * @file tokenModel.h
+ * @brief Header file for encoding and decoding files with an alphabet of tokens.
+ *
+ * This file contains declarations for functions for a model whose symbols are the 256 bytes and the most frequent
+ * byte sequences of a training file, such as the words, timestamps and keywords of log text. Every token is encoded
+ * as 1 huffman code, so a token that occurs often costs a few bits instead of a few bits for each of its characters.
+ * The alphabet can have up to TOKEN_MAX_SYMBOLS symbols, so the codes are canonical huffman codes that are built in
+ * O(n log n) and decoded with small tables.
+ *
+ * The candidates are the runs of letters and digits, the runs of spaces and the other characters, and every pair of
+ * neighbouring runs. The candidates that save the most characters become tokens, and the training file is then
+ * split into the longest tokens that match, with a trie, to count how often each symbol is really used.
+ * A token model file starts with the TOKEN_MODEL_FILE_HEADER line, then has the number of symbols and then the count
+ * and the bytes in hexadecimal of each symbol on a separate line.
+ *
+ * Bytes that are not in the model are encoded as the escape symbol and their 8 bits, like in the other coders.
+ *
+ * @author Spyros Sachmpazidis
+ * @bug No know bugs.
+ * @version 1.0
+ * @since 19/10/26
+ */
+
+#ifndef TOKEN_MODEL_H
+#define TOKEN_MODEL_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <ctype.h>
+#include "huffmanTree.h"
+#include "encodedFile.h"
+#include "canonicalHuffman.h"
+#include "bitStream.h"
+
+/*The first line of every token model file*/
+#define TOKEN_MODEL_FILE_HEADER "# huffman tokens"
+/*The largest number of symbols of a token model, the bytes, the tokens and the escape symbol*/
+#define TOKEN_MAX_SYMBOLS CANONICAL_MAX_SYMBOLS
+/*The longest token*/
+#define TOKEN_MAX_LENGTH 32
+/*The number of candidates that are counted at once while training, rare candidates are dropped when it is full*/
+#define TOKEN_CANDIDATE_TABLE_SIZE (1 << 18)
+/*The largest payload of an encoded block, every character costs at most 1 escaped code*/
+#define TOKEN_MAX_PAYLOAD MAX_BLOCK_PAYLOAD(CANONICAL_MAX_CODE_LENGTH + 8)
+
+/**
+ * @struct TokenModel
+ * @brief Represents the alphabet of tokens and its codes.
+ *
+ * The symbols are the 256 bytes and then the tokens, and the escape symbol is symbolCount. The bytes of each symbol
+ * start at start[symbol] in the text. The trie has a node for every prefix of a token, the children of the root are
+ * found directly and the other edges in a hash table of parent node and byte.
+ *
+ * @since 1.0
+ */
+typedef struct
+{
+    int symbolCount;
+    unsigned long long *counts;
+    unsigned char *text;
+    uint32_t *start;
+    int32_t rootChildren[BYTE_SIZE];
+    int32_t *nodeSymbols;
+    int nodeCount;
+    uint64_t *edgeKeys;
+    int32_t *edgeChildren;
+    uint64_t edgeMask;
+    CanonicalCode *code;
+    CanonicalDecodeTable *decodeTable;
+} TokenModel;
+
+/**
+ * @brief Creates a token model from a training file.
+ *
+ * The file is read twice, once to count the candidates and once to count the symbols after it is split into
+ * tokens. Tokens that are never used are dropped, so the model can have fewer symbols than asked.
+ *
+ * @param inputFile The training file.
+ * @param symbolCount The number of symbols of the alphabet, including the 256 bytes and the escape symbol.
+ * @return A pointer to the created model.
+ * @since 1.0
+ */
+TokenModel *trainTokenModel(char *inputFile, int symbolCount);
+
+/**
+ * @brief Writes a token model in a token model file.
+ *
+ * @param outputFile The name of the output file.
+ * @param model Pointer to the model.
+ * @since 1.0
+ */
+void writeTokenModel(char *outputFile, TokenModel *model);
+
+/**
+ * @brief Reads a token model file and creates the codes of its symbols.
+ *
+ * The program stops if the file is not a valid token model file.
+ *
+ * @param inputFile The name of the token model file.
+ * @return A pointer to the created model.
+ * @since 1.0
+ */
+TokenModel *readTokenModel(char *inputFile);
+
+/**
+ * @brief Checks if a file is a token model file.
+ *
+ * @param inputFile The name of the file.
+ * @return 1 if the first line of the file is the token model file header and 0 otherwise, also if it cannot be opened.
+ * @since 1.0
+ */
+int isTokenModelFile(char *inputFile);
+
+/**
+ * @brief Encodes a file with a token model.
+ *
+ * Every block is split into the longest tokens that match and the code of every token is written.
+ *
+ * @param model Pointer to the model.
+ * @param inputFile The input file.
+ * @param outputFile The encoded file.
+ * @since 1.0
+ */
+void tokenEncodeFile(TokenModel *model, char *inputFile, char *outputFile);
+
+/**
+ * @brief Decodes the payload of 1 block that was encoded with a token model into memory.
+ *
+ * The program stops if the payload does not decode to exactly length characters.
+ *
+ * @param model Pointer to the model.
+ * @param payload The payload of the block.
+ * @param payloadLength The number of bytes in the payload.
+ * @param length The number of characters that the block encodes.
+ * @param out The buffer that the characters are written to.
+ * @since 1.0
+ */
+void decodeTokenPayload(TokenModel *model, const unsigned char *payload, size_t payloadLength, size_t length,
+                        unsigned char *out);
+
+/**
+ * @brief Decodes a file that was encoded with a token model.
+ *
+ * The file must be decoded with the same token model file it was encoded with.
+ *
+ * @param model Pointer to the model.
+ * @param inputFile The encoded file.
+ * @param outputFile The decoded file.
+ * @since 1.0
+ */
+void tokenDecodeFile(TokenModel *model, char *inputFile, char *outputFile);
+
+/**
+ * @brief Frees the memory allocated for a token model and its codes.
+ *
+ * @param model Pointer to the model.
+ * @since 1.0
+ */
+void freeTokenModel(TokenModel *model);
+
+#endif
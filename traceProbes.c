@@ -0,0 +1,91 @@
+#include "traceProbes.h"
+
+/*The counters when they are not kept in a file*/
+static TraceCounters processCounters;
+static TraceCounters *counters = &processCounters;
+static pthread_once_t countersOnce = PTHREAD_ONCE_INIT;
+
+#ifdef DEBUG_TRACE_PROBES
+int main(int argc, char *argv[])
+{
+    if (argc != 2)
+    {
+        printf("Counters file not given!\n");
+        exit(EXIT_FAILURE);
+    }
+    printf("Debugging traceProbes.c:\n");
+    setenv(TRACE_COUNTERS_VARIABLE, argv[1], 1);
+    printf("Trying to count 2 blocks in %s...\n", argv[1]);
+    TRACE_PROBE0(debug_start);
+    countTraceBlock(100, 400);
+    countTraceBlock(50, 200);
+    TRACE_PROBE2(debug_done, 150, 600);
+    printf("Success!\n");
+    printTraceCounters(argv[1]);
+}
+#endif
+
+/*maps the counters file, so every update is seen by the readers of the file*/
+static void createCounters(void)
+{
+    char *countersFile = getenv(TRACE_COUNTERS_VARIABLE);
+    if (countersFile != NULL && countersFile[0] != '\0')
+    {
+        int fd;
+        void *memory;
+        if ((fd = open(countersFile, O_RDWR | O_CREAT | O_TRUNC, 0644)) < 0 ||
+            ftruncate(fd, sizeof(TraceCounters)) != 0 ||
+            (memory = mmap(NULL, sizeof(TraceCounters), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)) == MAP_FAILED)
+        {
+            printf("Error: Unable to open %s\n", countersFile);
+            exit(EXIT_FAILURE);
+        }
+        close(fd);
+        counters = (TraceCounters *)memory;
+    }
+
+    memcpy(counters->magic, TRACE_COUNTERS_MAGIC, sizeof(counters->magic));
+    counters->pid = getpid();
+}
+
+TraceCounters *getTraceCounters(void)
+{
+    pthread_once(&countersOnce, createCounters);
+    return counters;
+}
+
+void countTraceBlock(uint64_t symbols, uint64_t bits)
+{
+    TraceCounters *c = getTraceCounters();
+    addTraceCounter(&c->blocks, 1);
+    addTraceCounter(&c->symbols, symbols);
+    addTraceCounter(&c->bits, bits);
+}
+
+void printTraceCounters(char *countersFile)
+{
+    FILE *fp = NULL;
+    // check if file opens correctly
+    if ((fp = fopen(countersFile, "rb")) == NULL)
+    {
+        printf("Error: Unable to open %s\n", countersFile);
+        exit(EXIT_FAILURE);
+    }
+
+    TraceCounters c;
+    if (fread(&c, sizeof(c), 1, fp) != 1 || memcmp(c.magic, TRACE_COUNTERS_MAGIC, sizeof(c.magic)) != 0)
+    {
+        printf("Error: %s is not a counters file\n", countersFile);
+        exit(EXIT_FAILURE);
+    }
+    fclose(fp);
+
+    printf("Process:\t%llu\n", (unsigned long long)c.pid);
+    printf("Blocks:\t\t%llu\n", (unsigned long long)c.blocks);
+    printf("Characters:\t%llu\n", (unsigned long long)c.symbols);
+    printf("Bits:\t\t%llu\n", (unsigned long long)c.bits);
+    printf("Bits per char:\t%f\n", c.symbols > 0 ? (double)c.bits / c.symbols : 0);
+    printf("Read stall:\t%f s\n", c.readStall / 1e9);
+    printf("Write stall:\t%f s\n", c.writeStall / 1e9);
+    printf("Trees:\t\t%llu in %f s\n", (unsigned long long)c.trees, c.treeTime / 1e9);
+}
@@ -0,0 +1,160 @@
+/**
+ * @file traceProbes.h
+ * @brief Header file for the static tracepoints and the cumulative counters of the program.
+ *
+ * This file contains the tracepoints that mark the start and the end of every stage and every block, so a running
+ * process can be profiled with perf or bpftrace without building it again with debug code. The tracepoints are
+ * USDT probes of the provider "huffman", which are only compiled in with -DTRACE_PROBES on x86-64. Each one is a
+ * single nop and a note that tells the tracer where it is and where its arguments are, and without -DTRACE_PROBES
+ * they are compiled out completely. For example:\n
+ * bpftrace -e 'usdt:./huffman:huffman:encode_block { @bits = hist(arg1 * 8 / arg0); }'
+ *
+ * The counters are always kept and count the blocks, the characters and the bits that were coded, the time the
+ * coder spent waiting for the input and the output, and the time spent building huffman trees. They are updated
+ * once per block, so they cost almost nothing. When the HUFFMAN_COUNTERS environment variable names a file, the
+ * counters are kept in that file through a shared memory mapping, so they can be read while the process runs.
+ *
+ * @author Spyros Sachmpazidis
+ * @bug No know bugs.
+ * @version 1.0
+ * @since 19/10/26
+ */
+
+#ifndef TRACE_PROBES_H
+#define TRACE_PROBES_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/types.h>
+#include <sys/mman.h>
+
+/*The environment variable with the name of the file that the counters are kept in*/
+#define TRACE_COUNTERS_VARIABLE "HUFFMAN_COUNTERS"
+/*The first bytes of a counters file*/
+#define TRACE_COUNTERS_MAGIC "HUFTRACE"
+
+#if defined(TRACE_PROBES) && defined(__x86_64__) && defined(__GNUC__)
+/*The nop of a probe and its note in the format of systemtap, which perf and bpftrace read*/
+#define TRACE_NOTE(name, arguments)                                          \
+    "990: nop\n"                                                             \
+    ".pushsection .note.stapsdt,\"?\",\"note\"\n"                            \
+    ".balign 4\n"                                                            \
+    ".4byte 992f-991f,994f-993f,3\n"                                         \
+    "991: .asciz \"stapsdt\"\n"                                              \
+    "992: .balign 4\n"                                                       \
+    "993: .8byte 990b\n"                                                     \
+    ".8byte _.stapsdt.base\n"                                                \
+    ".8byte 0\n"                                                             \
+    ".asciz \"huffman\"\n"                                                   \
+    ".asciz \"" #name "\"\n"                                                 \
+    ".asciz \"" arguments "\"\n"                                             \
+    "994: .balign 4\n"                                                       \
+    ".popsection\n"                                                          \
+    ".ifndef _.stapsdt.base\n"                                               \
+    ".pushsection .stapsdt.base,\"aG\",\"progbits\",.stapsdt.base,comdat\n" \
+    ".weak _.stapsdt.base\n"                                                 \
+    ".hidden _.stapsdt.base\n"                                               \
+    "_.stapsdt.base: .space 1\n"                                             \
+    ".size _.stapsdt.base,1\n"                                               \
+    ".popsection\n"                                                          \
+    ".endif\n"
+/*Tracepoints with 0 to 3 arguments, every argument is passed as an unsigned 64 bit number*/
+#define TRACE_PROBE0(name) __asm__ __volatile__(TRACE_NOTE(name, ""))
+#define TRACE_PROBE1(name, a) __asm__ __volatile__(TRACE_NOTE(name, "8@%0") : : "nor"((uint64_t)(a)))
+#define TRACE_PROBE2(name, a, b) \
+    __asm__ __volatile__(TRACE_NOTE(name, "8@%0 8@%1") : : "nor"((uint64_t)(a)), "nor"((uint64_t)(b)))
+#define TRACE_PROBE3(name, a, b, c)                                                                  \
+    __asm__ __volatile__(TRACE_NOTE(name, "8@%0 8@%1 8@%2") : : "nor"((uint64_t)(a)), "nor"((uint64_t)(b)), \
+                         "nor"((uint64_t)(c)))
+#else
+#define TRACE_PROBE0(name) ((void)0)
+#define TRACE_PROBE1(name, a) ((void)0)
+#define TRACE_PROBE2(name, a, b) ((void)0)
+#define TRACE_PROBE3(name, a, b, c) ((void)0)
+#endif
+
+/**
+ * @struct TraceCounters
+ * @brief Represents the cumulative counters of the process.
+ *
+ * The structure is also the layout of a counters file, where every counter is a 64 bit number in the byte order
+ * of the machine. The times are in nanoseconds.
+ *
+ * @since 1.0
+ */
+typedef struct
+{
+    char magic[8];
+    uint64_t pid;
+    uint64_t blocks;
+    uint64_t symbols;
+    uint64_t bits;
+    uint64_t readStall;
+    uint64_t writeStall;
+    uint64_t trees;
+    uint64_t treeTime;
+} TraceCounters;
+
+/**
+ * @brief Returns the counters of the process.
+ *
+ * The first call creates the counters file if the HUFFMAN_COUNTERS environment variable is set, and the program
+ * stops if the file cannot be created.
+ *
+ * @return A pointer to the counters.
+ * @since 1.0
+ */
+TraceCounters *getTraceCounters(void);
+
+/**
+ * @brief Adds a value to a counter, from any thread.
+ *
+ * @param counter Pointer to the counter.
+ * @param value The value to add.
+ * @since 1.0
+ */
+static inline void addTraceCounter(uint64_t *counter, uint64_t value)
+{
+    __atomic_fetch_add(counter, value, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief Returns the time of a monotonic clock.
+ *
+ * @return The time in nanoseconds.
+ * @since 1.0
+ */
+static inline uint64_t traceTime(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000u + now.tv_nsec;
+}
+
+/**
+ * @brief Counts a block that was coded.
+ *
+ * @param symbols The number of characters of the block.
+ * @param bits The number of bits of its encoded form.
+ * @since 1.0
+ */
+void countTraceBlock(uint64_t symbols, uint64_t bits);
+
+/**
+ * @brief Prints the counters of a counters file.
+ *
+ * The file can be read while the process that writes it is running. The program stops if the file is not a
+ * counters file.
+ *
+ * @param countersFile The name of the counters file.
+ * @since 1.0
+ */
+void printTraceCounters(char *countersFile);
+
+#endif